@@ -20,9 +20,6 @@
 
 #include "itkProgressAccumulator.h"
 #include "itkParabolicErodeImageFilter.h"
-#include "itkProgressAccumulator.h"
-#include "itkCropImageFilter.h"
-#include "itkConstantPadImageFilter.h"
 #include "itkMath.h"
 
 namespace itk
@@ -34,14 +31,33 @@ BinaryCloseParaImageFilter<TInputImage, TOutputImage>::BinaryCloseParaImageFilte
   this->SetNumberOfRequiredInputs(1);
   this->m_CircErode = CircErodeType::New();
   this->m_CircDilate = CircDilateType::New();
-  this->m_CircCastA = CCastTypeA::New();
-  this->m_CircCastB = CCastTypeB::New();
 
   this->m_RectErode = RectErodeType::New();
   this->m_RectDilate = RectDilateType::New();
-  this->m_RectCastA = RCastTypeA::New();
-  this->m_RectCastB = RCastTypeB::New();
+  this->m_IntegerErode = IntegerErodeType::New();
+  this->m_IntegerDilate = IntegerDilateType::New();
+  // the stages threshold as they write their output - voxels that
+  // stay at 1 are inside the erosion, voxels above 0 inside the
+  // dilation
+  this->m_CircErode->SetUseOutputThreshold(true);
+  this->m_CircErode->SetLowerOutputThreshold(1.0);
+  this->m_CircErode->SetOutputInsideValue(1);
+  this->m_CircErode->SetOutputOutsideValue(0);
+  this->m_RectErode->SetUseOutputThreshold(true);
+  this->m_RectErode->SetLowerOutputThreshold(1);
+  this->m_RectErode->SetOutputInsideValue(1);
+  this->m_RectErode->SetOutputOutsideValue(0);
+  this->m_CircDilate->SetUseOutputThreshold(true);
+  this->m_CircDilate->SetUpperOutputThreshold(0);
+  this->m_CircDilate->SetOutputInsideValue(0);
+  this->m_CircDilate->SetOutputOutsideValue(1);
+  this->m_RectDilate->SetUseOutputThreshold(true);
+  this->m_RectDilate->SetUpperOutputThreshold(0);
+  this->m_RectDilate->SetOutputInsideValue(0);
+  this->m_RectDilate->SetOutputOutsideValue(1);
   this->m_Circular = true;
+  this->m_UseIntegerDistances = true;
+  this->m_WorkPixelSize = 0;
   // Need to call this after filters are created
   this->SetUseImageSpacing(false);
   this->SetSafeBorder(true);
@@ -108,115 +124,65 @@ BinaryCloseParaImageFilter<TInputImage, TOutputImage>::GenerateData()
 
   // std::cout << "Padding " << Pad << std::endl;
 
-  if (m_Circular)
+  // circles and spheres are thresholded integer squared distances
+  // when the radius and spacing allow it
+  const bool integer = m_Circular && m_UseIntegerDistances &&
+                       IntegerErodeType::SupportsScale(
+                         m_CircErode->GetScale(), this->GetInput()->GetSpacing(), m_CircErode->GetUseImageSpacing());
+  if (integer)
   {
-    ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
-    progress->SetMiniPipelineFilter(this);
-    InputImageConstPointer inputImage;
-    inputImage = this->GetInput();
-
-    progress->RegisterInternalFilter(m_CircErode, 0.4f);
-    progress->RegisterInternalFilter(m_CircCastA, 0.1f);
-    progress->RegisterInternalFilter(m_CircDilate, 0.4f);
-    progress->RegisterInternalFilter(m_CircCastB, 0.1f);
-
-    m_CircCastB->SetInput(m_CircDilate->GetOutput());
-    //    m_CircCastB->SetUpperThreshold(margin);
-    m_CircCastB->SetUpperThreshold(0);
-    m_CircCastB->SetOutsideValue(1);
-    m_CircCastB->SetInsideValue(0);
-
-    m_CircErode->SetInput(m_CircCastB->GetOutput());
-    m_CircCastA->SetInput(m_CircErode->GetOutput());
-    //    m_CircCastA->SetVal(1.0-margin);
-    m_CircCastA->SetVal(1.0);
-
-    if (m_SafeBorder)
-    {
-      using PadType = typename itk::ConstantPadImageFilter<InputImageType, InputImageType>;
-      typename PadType::Pointer pad = PadType::New();
-      pad->SetPadLowerBound(Pad);
-      pad->SetPadUpperBound(Pad);
-      pad->SetConstant(0);
-      pad->SetInput(inputImage);
-
-      m_CircDilate->SetInput(pad->GetOutput());
-
-      // writeIm<InputImageType>(m_CircCastB->GetOutput(), "dil.nii.gz");
-      // writeIm<InputImageType>(m_CircCastA->GetOutput(), "ero.nii.gz");
-      // m_CircCastA->UpdateOutputInformation();
-      using CropType = typename itk::CropImageFilter<TOutputImage, TOutputImage>;
-      typename CropType::Pointer crop = CropType::New();
-      crop->SetInput(m_CircCastA->GetOutput());
-      crop->SetUpperBoundaryCropSize(Pad);
-      crop->SetLowerBoundaryCropSize(Pad);
-
-      crop->GraftOutput(this->GetOutput());
-      crop->Update();
-
-      this->GraftOutput(crop->GetOutput());
-    }
-    else
-    {
-      m_CircDilate->SetInput(inputImage);
-      m_CircCastA->GraftOutput(this->GetOutput());
-      m_CircCastA->Update();
-
-      this->GraftOutput(m_CircCastA->GetOutput());
-    }
+    m_IntegerErode->SetScale(m_CircErode->GetScale()[0]);
+    m_IntegerDilate->SetScale(m_CircDilate->GetScale()[0]);
+    this->GenerateDataWithFilters(m_IntegerDilate.GetPointer(), m_IntegerErode.GetPointer(), Pad);
+    m_WorkPixelSize = std::max(m_IntegerErode->GetWorkPixelSize(), m_IntegerDilate->GetWorkPixelSize());
+  }
+  else if (m_Circular)
+  {
+    this->GenerateDataWithFilters(m_CircDilate.GetPointer(), m_CircErode.GetPointer(), Pad);
+    m_WorkPixelSize = sizeof(InternalRealType);
   }
   else
   {
-    ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
-    progress->SetMiniPipelineFilter(this);
-    InputImageConstPointer inputImage;
-    inputImage = this->GetInput();
-
-    progress->RegisterInternalFilter(m_RectErode, 0.4f);
-    progress->RegisterInternalFilter(m_RectCastA, 0.1f);
-    progress->RegisterInternalFilter(m_RectDilate, 0.4f);
-    progress->RegisterInternalFilter(m_RectCastB, 0.1f);
-
-    m_RectCastB->SetInput(m_RectDilate->GetOutput());
-    m_RectCastB->SetUpperThreshold(0);
-    m_RectCastB->SetOutsideValue(1);
-    m_RectCastB->SetInsideValue(0);
-
-    m_RectErode->SetInput(m_RectCastB->GetOutput());
-    m_RectCastA->SetInput(m_RectErode->GetOutput());
-    m_RectCastA->SetVal(1);
-
-    if (m_SafeBorder)
-    {
-      using PadType = typename itk::ConstantPadImageFilter<InputImageType, InputImageType>;
-      typename PadType::Pointer pad = PadType::New();
-      pad->SetPadLowerBound(Pad);
-      pad->SetPadUpperBound(Pad);
-      pad->SetConstant(0);
-      pad->SetInput(inputImage);
-
-      m_RectDilate->SetInput(pad->GetOutput());
-
-      using CropType = typename itk::CropImageFilter<TOutputImage, TOutputImage>;
-      typename CropType::Pointer crop = CropType::New();
-      crop->SetInput(m_RectCastA->GetOutput());
-      crop->SetUpperBoundaryCropSize(Pad);
-      crop->SetLowerBoundaryCropSize(Pad);
-
-      crop->GraftOutput(this->GetOutput());
-      crop->Update();
-      this->GraftOutput(crop->GetOutput());
-    }
-    else
-    {
-      m_RectDilate->SetInput(inputImage);
-      m_RectCastA->GraftOutput(this->GetOutput());
-      m_RectCastA->Update();
-      this->GraftOutput(m_RectCastA->GetOutput());
-    }
+    this->GenerateDataWithFilters(m_RectDilate.GetPointer(), m_RectErode.GetPointer(), Pad);
+    m_WorkPixelSize =
+      std::max(sizeof(typename RectErodeType::WorkPixelType), sizeof(typename RectDilateType::WorkPixelType));
   }
 }
 
+template <typename TInputImage, typename TOutputImage>
+template <typename TFirst, typename TSecond>
+void
+BinaryCloseParaImageFilter<TInputImage, TOutputImage>::GenerateDataWithFilters(
+  TFirst *                               first,
+  TSecond *                              second,
+  const typename TInputImage::SizeType & padSize)
+{
+  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+  progress->SetMiniPipelineFilter(this);
+  InputImageConstPointer inputImage;
+  inputImage = this->GetInput();
+
+  progress->RegisterInternalFilter(first, 0.5f);
+  progress->RegisterInternalFilter(second, 0.5f);
+
+  // a safe border is a virtual border of background that the first
+  // stage grows into and the second crops, so neither a padded nor a
+  // cropped copy of the image is made
+  typename TInputImage::SizeType none;
+  none.Fill(0);
+  first->SetBorder(m_SafeBorder ? padSize : none);
+  first->SetBorderValue(0);
+  first->SetCrop(none);
+  second->SetBorder(none);
+  second->SetCrop(m_SafeBorder ? padSize : none);
+
+  first->SetInput(inputImage);
+  second->SetInput(first->GetOutput());
+  second->GraftOutput(this->GetOutput());
+  second->Update();
+  this->GraftOutput(second->GetOutput());
+}
+
 template <typename TInputImage, typename TOutputImage>
 void
 BinaryCloseParaImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
@@ -231,6 +197,8 @@ BinaryCloseParaImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream &
     os << "Radius in voxels: " << this->GetRadius() << std::endl;
   }
   os << "Safe border: " << this->GetSafeBorder() << std::endl;
+  os << indent << "UseIntegerDistances: " << m_UseIntegerDistances << std::endl;
+  os << indent << "WorkPixelSize: " << m_WorkPixelSize << std::endl;
 }
 } // namespace itk
 #endif
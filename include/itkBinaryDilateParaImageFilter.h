@@ -19,7 +19,7 @@
 #define itkBinaryDilateParaImageFilter_h
 
 #include "itkParabolicDilateImageFilter.h"
-#include "itkBinaryThresholdImageFilter.h"
+#include "itkParabolicBinaryMorphologyImageFilter.h"
 
 namespace itk
 {
@@ -50,6 +50,14 @@ namespace itk
  *
  * Also note that the inputs must be 0/1 not 0/max for pixel type.
  *
+ * The parabolic passes keep their results in an InternalRealType
+ * image and the last pass thresholds as it writes the output, so
+ * no full size real valued output is created. Circular dilations
+ * by a radius that is the same in all dimensions use 8, 16 or 32
+ * bit integer squared distances instead, see UseIntegerDistances.
+ * Masks are read and written a pixel at a time, bit packed masks
+ * aren't supported.
+ *
  * Core methods described in the InsightJournal article:
  * "Morphology with parabolic structuring elements"
  *
@@ -95,9 +103,8 @@ public:
   using InputImageConstPointer = typename TInputImage::ConstPointer;
 
   using InternalRealType = typename NumericTraits<PixelType>::FloatType;
-  // perhaps a bit dodgy, change to int if you want to do enormous
-  // binary operations
-  using InternalIntType = short;
+  // enough for 0/1 masks
+  using InternalIntType = unsigned char;
 
   /** Image dimension. */
   static constexpr unsigned int ImageDimension = TInputImage::ImageDimension;
@@ -118,6 +125,7 @@ public:
   {
     m_RectPara->SetUseImageSpacing(g);
     m_CircPara->SetUseImageSpacing(g);
+    m_IntegerPara->SetUseImageSpacing(g);
   }
 
   /**
@@ -127,6 +135,26 @@ public:
   itkSetMacro(Circular, bool);
   itkGetConstReferenceMacro(Circular, bool);
   itkBooleanMacro(Circular);
+
+  /**
+   * Set/Get whether circular operations store integer squared
+   * distances between the passes, in the narrowest unsigned type that
+   * holds the radius, when the radius is the same in all dimensions
+   * and, in world units, the squared spacings are whole numbers. See
+   * ParabolicBinaryMorphologyImageFilter. Otherwise InternalRealType
+   * is used. Default is true.
+   */
+  itkSetMacro(UseIntegerDistances, bool);
+  itkGetConstReferenceMacro(UseIntegerDistances, bool);
+  itkBooleanMacro(UseIntegerDistances);
+
+  /** Size in bytes of the pixels stored between the passes of the
+   * last update. */
+  itkGetConstReferenceMacro(WorkPixelSize, unsigned int);
+
+  /** Fraction of the lines of the last update skipped because they
+   * were constant. See ParabolicErodeDilateImageFilter. */
+  itkGetConstReferenceMacro(SkippedLineFraction, double);
   /** Image related type alias. */
 
   /* add in the traits here */
@@ -134,6 +162,11 @@ protected:
   void
   GenerateData() override;
 
+  /** Run one of the internal filters into the output */
+  template <typename TFilter>
+  void
+  GenerateDataWithFilter(TFilter * filter);
+
   BinaryDilateParaImageFilter();
   ~BinaryDilateParaImageFilter() override = default;
   void
@@ -141,20 +174,23 @@ protected:
 
   using InternalRealImageType = typename itk::Image<InternalRealType, InputImageType::ImageDimension>;
   using InternalIntImageType = typename itk::Image<InternalIntType, InputImageType::ImageDimension>;
-  using CircParabolicType = typename itk::ParabolicDilateImageFilter<TInputImage, InternalRealImageType>;
-  using RectParabolicType = typename itk::ParabolicDilateImageFilter<TInputImage, InternalRealImageType>;
-  using CCastType = typename itk::BinaryThresholdImageFilter<InternalRealImageType, OutputImageType>;
-  using RCastType = typename itk::BinaryThresholdImageFilter<InternalRealImageType, OutputImageType>;
+  using CircParabolicType =
+    typename itk::ParabolicDilateImageFilter<TInputImage, OutputImageType, InternalRealImageType>;
+  using RectParabolicType =
+    typename itk::ParabolicDilateImageFilter<TInputImage, OutputImageType, InternalRealImageType>;
+  using IntegerParabolicType =
+    typename itk::ParabolicBinaryMorphologyImageFilter<TInputImage, true, OutputImageType>;
 
 private:
-  RadiusType m_Radius;
-  bool       m_Circular;
-
-  typename CircParabolicType::Pointer m_CircPara;
-  typename CCastType::Pointer         m_CircCast;
-
-  typename RectParabolicType::Pointer m_RectPara;
-  typename RCastType::Pointer         m_RectCast;
+  RadiusType   m_Radius;
+  bool         m_Circular;
+  bool         m_UseIntegerDistances;
+  unsigned int m_WorkPixelSize;
+  double       m_SkippedLineFraction;
+
+  typename CircParabolicType::Pointer    m_CircPara;
+  typename RectParabolicType::Pointer    m_RectPara;
+  typename IntegerParabolicType::Pointer m_IntegerPara;
 };
 } // end namespace itk
 
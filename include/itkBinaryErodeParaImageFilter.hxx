@@ -30,11 +30,21 @@ BinaryErodeParaImageFilter<TInputImage, TOutputImage>::BinaryErodeParaImageFilte
   this->SetNumberOfRequiredOutputs(1);
   this->SetNumberOfRequiredInputs(1);
   this->m_CircPara = CircParabolicType::New();
-  this->m_CircCast = CCastType::New();
-
   this->m_RectPara = RectParabolicType::New();
-  this->m_RectCast = RCastType::New();
+  this->m_IntegerPara = IntegerParabolicType::New();
+  // voxels that stay at 1 are inside
+  this->m_CircPara->SetUseOutputThreshold(true);
+  this->m_CircPara->SetLowerOutputThreshold(1.0);
+  this->m_CircPara->SetOutputInsideValue(1);
+  this->m_CircPara->SetOutputOutsideValue(0);
+  this->m_RectPara->SetUseOutputThreshold(true);
+  this->m_RectPara->SetLowerOutputThreshold(1);
+  this->m_RectPara->SetOutputInsideValue(1);
+  this->m_RectPara->SetOutputOutsideValue(0);
   this->m_Circular = true;
+  this->m_UseIntegerDistances = true;
+  this->m_WorkPixelSize = 0;
+  this->m_SkippedLineFraction = 0;
   // Need to call this after filters are created
   this->SetUseImageSpacing(false);
 }
@@ -82,49 +92,46 @@ BinaryErodeParaImageFilter<TInputImage, TOutputImage>::GenerateData()
     m_CircPara->SetScale(R);
   }
 
-  if (m_Circular)
+  // circles and spheres are thresholded integer squared distances
+  // when the radius and spacing allow it
+  const bool integer = m_Circular && m_UseIntegerDistances &&
+                       IntegerParabolicType::SupportsScale(
+                         m_CircPara->GetScale(), this->GetInput()->GetSpacing(), m_CircPara->GetUseImageSpacing());
+  if (integer)
   {
-    ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
-    progress->SetMiniPipelineFilter(this);
-    InputImageConstPointer inputImage;
-    inputImage = this->GetInput();
-
-    progress->RegisterInternalFilter(m_CircPara, 0.8f);
-    progress->RegisterInternalFilter(m_CircCast, 0.2f);
-
-    m_CircPara->SetInput(inputImage);
-    m_CircCast->SetInput(m_CircPara->GetOutput());
-    m_CircCast->SetVal(1.0);
-    // m_CircCast->SetInsideValue(0);
-    // m_CircCast->SetOutsideValue(1);
-    // setting the correct threshold value is a little tricky - needs would
-    // to produce a result matching a bresenham circle, but these
-    // circles are such that the voxel centres need to be less than radius
-    // m_CircCast->SetUpperThreshold(1 -
-    // itk::NumericTraits<InternalRealType>::min());
-    // m_CircCast->SetUpperThreshold(0.99);
-
-    m_CircCast->GraftOutput(this->GetOutput());
-    m_CircCast->Update();
-    this->GraftOutput(m_CircCast->GetOutput());
+    m_IntegerPara->SetScale(m_CircPara->GetScale()[0]);
+    this->GenerateDataWithFilter(m_IntegerPara.GetPointer());
+    m_WorkPixelSize = m_IntegerPara->GetWorkPixelSize();
+  }
+  else if (m_Circular)
+  {
+    this->GenerateDataWithFilter(m_CircPara.GetPointer());
+    m_WorkPixelSize = sizeof(InternalRealType);
   }
   else
   {
-    ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
-    progress->SetMiniPipelineFilter(this);
-    InputImageConstPointer inputImage;
-    inputImage = this->GetInput();
+    this->GenerateDataWithFilter(m_RectPara.GetPointer());
+    m_WorkPixelSize = sizeof(typename RectParabolicType::WorkPixelType);
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+template <typename TFilter>
+void
+BinaryErodeParaImageFilter<TInputImage, TOutputImage>::GenerateDataWithFilter(TFilter * filter)
+{
+  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+  progress->SetMiniPipelineFilter(this);
+  InputImageConstPointer inputImage;
+  inputImage = this->GetInput();
 
-    progress->RegisterInternalFilter(m_RectPara, 0.8f);
-    progress->RegisterInternalFilter(m_RectCast, 0.2f);
+  progress->RegisterInternalFilter(filter, 1.0f);
 
-    m_RectPara->SetInput(inputImage);
-    m_RectCast->SetInput(m_RectPara->GetOutput());
-    m_RectCast->SetVal(1);
-    m_RectCast->GraftOutput(this->GetOutput());
-    m_RectCast->Update();
-    this->GraftOutput(m_RectCast->GetOutput());
-  }
+  filter->SetInput(inputImage);
+  filter->GraftOutput(this->GetOutput());
+  filter->Update();
+  this->GraftOutput(filter->GetOutput());
+  m_SkippedLineFraction = filter->GetSkippedLineFraction();
 }
 
 template <typename TInputImage, typename TOutputImage>
@@ -140,6 +147,8 @@ BinaryErodeParaImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream &
   {
     os << "Radius in voxels: " << this->GetRadius() << std::endl;
   }
+  os << indent << "UseIntegerDistances: " << m_UseIntegerDistances << std::endl;
+  os << indent << "WorkPixelSize: " << m_WorkPixelSize << std::endl;
 }
 
 template <typename TInputImage, typename TOutputImage>
@@ -148,9 +157,8 @@ BinaryErodeParaImageFilter<TInputImage, TOutputImage>::Modified() const
 {
   Superclass::Modified();
   m_CircPara->Modified();
-  m_CircCast->Modified();
   m_RectPara->Modified();
-  m_RectCast->Modified();
+  m_IntegerPara->Modified();
 }
 } // namespace itk
 #endif
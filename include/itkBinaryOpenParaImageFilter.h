@@ -20,8 +20,7 @@
 
 #include "itkParabolicErodeImageFilter.h"
 #include "itkParabolicDilateImageFilter.h"
-#include "itkGreaterEqualValImageFilter.h"
-#include "itkBinaryThresholdImageFilter.h"
+#include "itkParabolicBinaryMorphologyImageFilter.h"
 
 namespace itk
 {
@@ -52,6 +51,10 @@ namespace itk
  *
  * Also note that the inputs must be 0/1 not 0/max for pixel type.
  *
+ * Circular operations by a radius that is the same in all dimensions
+ * store 8, 16 or 32 bit integer squared distances between the passes,
+ * see UseIntegerDistances.
+ *
  * Core methods described in the InsightJournal article:
  * "Morphology with parabolic structuring elements"
  *
@@ -97,9 +100,8 @@ public:
   using InputImageConstPointer = typename TInputImage::ConstPointer;
 
   using InternalRealType = typename NumericTraits<PixelType>::FloatType;
-  // perhaps a bit dodgy, change to int if you want to do enormous
-  // binary operations
-  using InternalIntType = short;
+  // the rectangular erosion stays between 0 and 1
+  using InternalIntType = unsigned char;
 
   /** Image dimension. */
   static constexpr unsigned int ImageDimension = TInputImage::ImageDimension;
@@ -119,6 +121,8 @@ public:
     m_RectDilate->SetUseImageSpacing(g);
     m_CircErode->SetUseImageSpacing(g);
     m_CircDilate->SetUseImageSpacing(g);
+    m_IntegerErode->SetUseImageSpacing(g);
+    m_IntegerDilate->SetUseImageSpacing(g);
   }
 
   /**
@@ -129,12 +133,30 @@ public:
   itkGetConstReferenceMacro(Circular, bool);
   itkBooleanMacro(Circular);
 
-  /** A safe border is added to input image to avoid borders effects
-   * and remove it once the closing is done */
+  /** A safe border avoids border effects, as if the input were padded
+   * before the operation and cropped after it. The border is
+   * virtual, see ParabolicErodeDilateImageFilter::SetBorder, so
+   * neither copy is made. */
   itkSetMacro(SafeBorder, bool);
   itkGetConstReferenceMacro(SafeBorder, bool);
   itkBooleanMacro(SafeBorder);
 
+  /**
+   * Set/Get whether circular operations store integer squared
+   * distances between the passes, in the narrowest unsigned type that
+   * holds the radius, when the radius is the same in all dimensions
+   * and, in world units, the squared spacings are whole numbers. See
+   * ParabolicBinaryMorphologyImageFilter. Otherwise InternalRealType
+   * is used. Default is true.
+   */
+  itkSetMacro(UseIntegerDistances, bool);
+  itkGetConstReferenceMacro(UseIntegerDistances, bool);
+  itkBooleanMacro(UseIntegerDistances);
+
+  /** Size in bytes of the pixels stored between the passes of the
+   * last update. */
+  itkGetConstReferenceMacro(WorkPixelSize, unsigned int);
+
   /** Image related type alias. */
 
   /* add in the traits here */
@@ -142,6 +164,12 @@ protected:
   void
   GenerateData() override;
 
+  /** Run the erode stage, from the input, and the dilate stage
+   * into the output */
+  template <typename TFirst, typename TSecond>
+  void
+  GenerateDataWithFilters(TFirst * first, TSecond * second, const typename TInputImage::SizeType & pad);
+
   BinaryOpenParaImageFilter();
   ~BinaryOpenParaImageFilter() override = default;
   void
@@ -149,33 +177,31 @@ protected:
 
   using InternalRealImageType = typename itk::Image<InternalRealType, InputImageType::ImageDimension>;
   using InternalIntImageType = typename itk::Image<InternalIntType, InputImageType::ImageDimension>;
-  using CircErodeType = typename itk::ParabolicErodeImageFilter<TInputImage, InternalRealImageType>;
-  using RectErodeType = typename itk::ParabolicErodeImageFilter<TInputImage, InternalIntImageType>;
-  using CircDilateType = typename itk::ParabolicDilateImageFilter<OutputImageType, InternalRealImageType>;
-  using RectDilateType = typename itk::ParabolicDilateImageFilter<OutputImageType, InternalRealImageType>;
-
-  using CCastTypeA = typename itk::GreaterEqualValImageFilter<InternalRealImageType, OutputImageType>;
-  using CCastTypeB = typename itk::BinaryThresholdImageFilter<InternalRealImageType, OutputImageType>;
-
-  using RCastTypeA = typename itk::GreaterEqualValImageFilter<InternalIntImageType, OutputImageType>;
-  using RCastTypeB = typename itk::BinaryThresholdImageFilter<InternalRealImageType, OutputImageType>;
+  using CircErodeType = typename itk::ParabolicErodeImageFilter<TInputImage, OutputImageType, InternalRealImageType>;
+  using RectErodeType = typename itk::ParabolicErodeImageFilter<TInputImage, OutputImageType, InternalIntImageType>;
+  using CircDilateType =
+    typename itk::ParabolicDilateImageFilter<OutputImageType, OutputImageType, InternalRealImageType>;
+  using RectDilateType =
+    typename itk::ParabolicDilateImageFilter<OutputImageType, OutputImageType, InternalRealImageType>;
+  using IntegerErodeType = typename itk::ParabolicBinaryMorphologyImageFilter<TInputImage, false, OutputImageType>;
+  using IntegerDilateType =
+    typename itk::ParabolicBinaryMorphologyImageFilter<OutputImageType, true, OutputImageType>;
 
 private:
-  RadiusType m_Radius;
-  bool       m_Circular;
-  bool       m_SafeBorder;
+  RadiusType   m_Radius;
+  bool         m_Circular;
+  bool         m_SafeBorder;
+  bool         m_UseIntegerDistances;
+  unsigned int m_WorkPixelSize;
 
   typename CircErodeType::Pointer  m_CircErode;
   typename CircDilateType::Pointer m_CircDilate;
 
-  typename CCastTypeA::Pointer m_CircCastA;
-  typename CCastTypeB::Pointer m_CircCastB;
-
   typename RectErodeType::Pointer  m_RectErode;
   typename RectDilateType::Pointer m_RectDilate;
 
-  typename RCastTypeA::Pointer m_RectCastA;
-  typename RCastTypeB::Pointer m_RectCastB;
+  typename IntegerErodeType::Pointer  m_IntegerErode;
+  typename IntegerDilateType::Pointer m_IntegerDilate;
 };
 } // end namespace itk
 
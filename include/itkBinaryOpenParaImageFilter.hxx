@@ -20,9 +20,6 @@
 
 #include "itkProgressAccumulator.h"
 #include "itkParabolicErodeImageFilter.h"
-#include "itkProgressAccumulator.h"
-#include "itkCropImageFilter.h"
-#include "itkConstantPadImageFilter.h"
 #include "itkMath.h"
 
 namespace itk
@@ -34,14 +31,33 @@ BinaryOpenParaImageFilter<TInputImage, TOutputImage>::BinaryOpenParaImageFilter(
   this->SetNumberOfRequiredInputs(1);
   this->m_CircErode = CircErodeType::New();
   this->m_CircDilate = CircDilateType::New();
-  this->m_CircCastA = CCastTypeA::New();
-  this->m_CircCastB = CCastTypeB::New();
 
   this->m_RectErode = RectErodeType::New();
   this->m_RectDilate = RectDilateType::New();
-  this->m_RectCastA = RCastTypeA::New();
-  this->m_RectCastB = RCastTypeB::New();
+  this->m_IntegerErode = IntegerErodeType::New();
+  this->m_IntegerDilate = IntegerDilateType::New();
+  // the stages threshold as they write their output - voxels that
+  // stay at 1 are inside the erosion, voxels above 0 inside the
+  // dilation
+  this->m_CircErode->SetUseOutputThreshold(true);
+  this->m_CircErode->SetLowerOutputThreshold(1.0);
+  this->m_CircErode->SetOutputInsideValue(1);
+  this->m_CircErode->SetOutputOutsideValue(0);
+  this->m_RectErode->SetUseOutputThreshold(true);
+  this->m_RectErode->SetLowerOutputThreshold(1);
+  this->m_RectErode->SetOutputInsideValue(1);
+  this->m_RectErode->SetOutputOutsideValue(0);
+  this->m_CircDilate->SetUseOutputThreshold(true);
+  this->m_CircDilate->SetUpperOutputThreshold(0);
+  this->m_CircDilate->SetOutputInsideValue(0);
+  this->m_CircDilate->SetOutputOutsideValue(1);
+  this->m_RectDilate->SetUseOutputThreshold(true);
+  this->m_RectDilate->SetUpperOutputThreshold(0);
+  this->m_RectDilate->SetOutputInsideValue(0);
+  this->m_RectDilate->SetOutputOutsideValue(1);
   this->m_Circular = true;
+  this->m_UseIntegerDistances = true;
+  this->m_WorkPixelSize = 0;
   // Need to call this after filters are created
   this->SetUseImageSpacing(false);
   this->SetSafeBorder(true);
@@ -116,110 +132,65 @@ BinaryOpenParaImageFilter<TInputImage, TOutputImage>::GenerateData()
     m_CircDilate->SetScale(R);
   }
 
-  if (m_Circular)
+  // circles and spheres are thresholded integer squared distances
+  // when the radius and spacing allow it
+  const bool integer = m_Circular && m_UseIntegerDistances &&
+                       IntegerErodeType::SupportsScale(
+                         m_CircErode->GetScale(), this->GetInput()->GetSpacing(), m_CircErode->GetUseImageSpacing());
+  if (integer)
   {
-    ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
-    progress->SetMiniPipelineFilter(this);
-    InputImageConstPointer inputImage;
-    inputImage = this->GetInput();
-
-    progress->RegisterInternalFilter(m_CircErode, 0.4f);
-    progress->RegisterInternalFilter(m_CircCastA, 0.1f);
-    progress->RegisterInternalFilter(m_CircDilate, 0.4f);
-    progress->RegisterInternalFilter(m_CircCastB, 0.1f);
-
-    m_CircCastA->SetInput(m_CircErode->GetOutput());
-    //    m_CircCastA->SetVal(1.0 - margin);
-    m_CircCastA->SetVal(1.0);
-
-    m_CircDilate->SetInput(m_CircCastA->GetOutput());
-
-    m_CircCastB->SetInput(m_CircDilate->GetOutput());
-    m_CircCastB->SetUpperThreshold(0.0);
-    m_CircCastB->SetOutsideValue(1);
-    m_CircCastB->SetInsideValue(0);
-
-    if (m_SafeBorder)
-    {
-      using PadType = typename itk::ConstantPadImageFilter<InputImageType, InputImageType>;
-      typename PadType::Pointer pad = PadType::New();
-      pad->SetPadLowerBound(Pad);
-      pad->SetPadUpperBound(Pad);
-      pad->SetConstant(1);
-      pad->SetInput(inputImage);
-      m_CircErode->SetInput(pad->GetOutput());
-      using CropType = typename itk::CropImageFilter<TOutputImage, TOutputImage>;
-      typename CropType::Pointer crop = CropType::New();
-      crop->SetInput(m_CircCastB->GetOutput());
-      crop->SetUpperBoundaryCropSize(Pad);
-      crop->SetLowerBoundaryCropSize(Pad);
-
-      crop->GraftOutput(this->GetOutput());
-      crop->Update();
-      this->GraftOutput(crop->GetOutput());
-    }
-    else
-    {
-      m_CircErode->SetInput(inputImage);
-
-      m_CircCastB->GraftOutput(this->GetOutput());
-      m_CircCastB->Update();
-      this->GraftOutput(m_CircCastB->GetOutput());
-    }
+    m_IntegerErode->SetScale(m_CircErode->GetScale()[0]);
+    m_IntegerDilate->SetScale(m_CircDilate->GetScale()[0]);
+    this->GenerateDataWithFilters(m_IntegerErode.GetPointer(), m_IntegerDilate.GetPointer(), Pad);
+    m_WorkPixelSize = std::max(m_IntegerErode->GetWorkPixelSize(), m_IntegerDilate->GetWorkPixelSize());
+  }
+  else if (m_Circular)
+  {
+    this->GenerateDataWithFilters(m_CircErode.GetPointer(), m_CircDilate.GetPointer(), Pad);
+    m_WorkPixelSize = sizeof(InternalRealType);
   }
   else
   {
-    ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
-    progress->SetMiniPipelineFilter(this);
-    InputImageConstPointer inputImage;
-    inputImage = this->GetInput();
-
-    progress->RegisterInternalFilter(m_RectErode, 0.4f);
-    progress->RegisterInternalFilter(m_RectCastA, 0.1f);
-    progress->RegisterInternalFilter(m_RectDilate, 0.4f);
-    progress->RegisterInternalFilter(m_RectCastB, 0.1f);
-
-    m_RectCastA->SetInput(m_RectErode->GetOutput());
-    m_RectCastA->SetVal(1);
-
-    m_RectDilate->SetInput(m_RectCastA->GetOutput());
-
-    m_RectCastB->SetInput(m_RectDilate->GetOutput());
-    m_RectCastB->SetUpperThreshold(0);
-    m_RectCastB->SetOutsideValue(1);
-    m_RectCastB->SetInsideValue(0);
-
-    if (m_SafeBorder)
-    {
-      using PadType = typename itk::ConstantPadImageFilter<InputImageType, InputImageType>;
-      typename PadType::Pointer pad = PadType::New();
-      pad->SetPadLowerBound(Pad);
-      pad->SetPadUpperBound(Pad);
-      pad->SetConstant(1);
-      pad->SetInput(inputImage);
-      m_RectErode->SetInput(pad->GetOutput());
-
-      using CropType = typename itk::CropImageFilter<TOutputImage, TOutputImage>;
-      typename CropType::Pointer crop = CropType::New();
-      crop->SetInput(m_RectCastB->GetOutput());
-      crop->SetUpperBoundaryCropSize(Pad);
-      crop->SetLowerBoundaryCropSize(Pad);
-
-      crop->GraftOutput(this->GetOutput());
-      crop->Update();
-      this->GraftOutput(crop->GetOutput());
-    }
-    else
-    {
-      m_RectErode->SetInput(inputImage);
-      m_RectCastB->GraftOutput(this->GetOutput());
-      m_RectCastB->Update();
-
-      this->GraftOutput(m_RectCastB->GetOutput());
-    }
+    this->GenerateDataWithFilters(m_RectErode.GetPointer(), m_RectDilate.GetPointer(), Pad);
+    m_WorkPixelSize =
+      std::max(sizeof(typename RectErodeType::WorkPixelType), sizeof(typename RectDilateType::WorkPixelType));
   }
 }
 
+template <typename TInputImage, typename TOutputImage>
+template <typename TFirst, typename TSecond>
+void
+BinaryOpenParaImageFilter<TInputImage, TOutputImage>::GenerateDataWithFilters(
+  TFirst *                               first,
+  TSecond *                              second,
+  const typename TInputImage::SizeType & padSize)
+{
+  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+  progress->SetMiniPipelineFilter(this);
+  InputImageConstPointer inputImage;
+  inputImage = this->GetInput();
+
+  progress->RegisterInternalFilter(first, 0.5f);
+  progress->RegisterInternalFilter(second, 0.5f);
+
+  // a safe border is a virtual border of foreground that the first
+  // stage grows into and the second crops, so neither a padded nor a
+  // cropped copy of the image is made
+  typename TInputImage::SizeType none;
+  none.Fill(0);
+  first->SetBorder(m_SafeBorder ? padSize : none);
+  first->SetBorderValue(1);
+  first->SetCrop(none);
+  second->SetBorder(none);
+  second->SetCrop(m_SafeBorder ? padSize : none);
+
+  first->SetInput(inputImage);
+  second->SetInput(first->GetOutput());
+  second->GraftOutput(this->GetOutput());
+  second->Update();
+  this->GraftOutput(second->GetOutput());
+}
+
 template <typename TInputImage, typename TOutputImage>
 void
 BinaryOpenParaImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
@@ -251,6 +222,8 @@ BinaryOpenParaImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & o
   {
     os << "Radius in voxels: " << this->GetRadius() << std::endl;
   }
+  os << indent << "UseIntegerDistances: " << m_UseIntegerDistances << std::endl;
+  os << indent << "WorkPixelSize: " << m_WorkPixelSize << std::endl;
 }
 } // namespace itk
 #endif
@@ -21,9 +21,7 @@
 #include "itkImageToImageFilter.h"
 #include "itkProgressReporter.h"
 
-#include "itkBinaryThresholdImageFilter.h"
 #include "itkParabolicErodeImageFilter.h"
-#include "itkSqrtImageFilter.h"
 
 namespace itk
 {
@@ -39,9 +37,29 @@ namespace itk
  * the nearest zero valued voxel. Thus we can compute the distance
  * transform by taking the sqrt of the erosion.
  *
+ * The mask is thresholded as the first pass of the erosion reads it
+ * and the square root is taken as the last pass writes the output,
+ * so the output is the only full size image.
+ *
  * The output pixel type needs to support values as large as the
  * square of the largest value of the distance - just use float to be
- * safe.
+ * safe. Squared distances beyond the largest value of the pixel type
+ * are clamped to it.
+ *
+ * When only distances up to some limit are needed, set
+ * MaximumDistance. Distances are then clamped to it, the erosion
+ * skips voxels that are further than the limit from any outside
+ * voxel, and the output pixel type only needs to hold the square of
+ * MaximumDistance. With unsigned char or unsigned short outputs,
+ * distances are rounded down.
+ *
+ * When the spacing is integral, or not used, the squared distances
+ * are whole numbers and are computed exactly with integer arithmetic.
+ *
+ * The feature transform - the location of the nearest "Outside"
+ * voxel for every voxel - can be computed in the same passes, by
+ * carrying the position of the winning parabola through each
+ * dimension. It is the second output, see GetFeatureImage.
  *
  * Core methods described in the InsightJournal article:
  * "Morphology with parabolic structuring elements"
@@ -58,6 +76,7 @@ namespace itk
 template <typename TInputImage, typename TOutputImage = TInputImage>
 class ITK_TEMPLATE_EXPORT MorphologicalDistanceTransformImageFilter
   : public ImageToImageFilter<TInputImage, TOutputImage>
+  , public ParabolicMorphologyEnums
 {
 public:
   ITK_DISALLOW_COPY_AND_MOVE(MorphologicalDistanceTransformImageFilter);
@@ -115,10 +134,121 @@ public:
     return m_Erode->GetUseImageSpacing();
   }
 
+  /** Set/Get the way lines are transferred between the image and the
+   * line buffers by the internal erosion. See
+   * ParabolicErodeDilateImageFilter. */
+  void
+  SetExecutionMode(int mode)
+  {
+    m_Erode->SetExecutionMode(mode);
+    this->Modified();
+  }
+
+  const int &
+  GetExecutionMode() const
+  {
+    return m_Erode->GetExecutionMode();
+  }
+
+  using ExecutionStrategyType = FixedArray<int, ImageDimension>;
+  /** The line transfer used for each dimension by the last update */
+  const ExecutionStrategyType &
+  GetExecutionStrategy() const
+  {
+    return m_Erode->GetExecutionStrategy();
+  }
+
+  /** Set/Get the precision of the line buffers of the internal
+   * erosion. See ParabolicErodeDilateImageFilter. */
+  void
+  SetKernelPrecision(int precision)
+  {
+    m_Erode->SetKernelPrecision(precision);
+    this->Modified();
+  }
+
+  const int &
+  GetKernelPrecision() const
+  {
+    return m_Erode->GetKernelPrecision();
+  }
+
+  /** Set/Get precision validation of the internal erosion. See
+   * ParabolicErodeDilateImageFilter. */
+  void
+  SetValidatePrecision(bool validate)
+  {
+    m_Erode->SetValidatePrecision(validate);
+    this->Modified();
+  }
+
+  const bool &
+  GetValidatePrecision() const
+  {
+    return m_Erode->GetValidatePrecision();
+  }
+  itkBooleanMacro(ValidatePrecision);
+
+  /** Largest difference from the double precision output found by
+   * the last update with ValidatePrecision on */
+  const double &
+  GetMaximumPrecisionError() const
+  {
+    return m_Erode->GetMaximumPrecisionError();
+  }
+
   itkSetMacro(SqrDist, bool);
   itkGetConstReferenceMacro(SqrDist, bool);
   itkBooleanMacro(SqrDist);
 
+  /** Fraction of the lines of the last update skipped by the erosion
+   * because they were constant. See ParabolicErodeDilateImageFilter. */
+  const double &
+  GetSkippedLineFraction() const
+  {
+    return m_Erode->GetSkippedLineFraction();
+  }
+
+  /** Set/Get the largest distance computed, in the units of the
+   * transform. Larger distances are reported as MaximumDistance.
+   * Default is unlimited. */
+  itkSetMacro(MaximumDistance, double);
+  itkGetConstReferenceMacro(MaximumDistance, double);
+
+  using FeatureImageType = Image<OffsetValueType, ImageDimension>;
+
+  /** Set/Get whether the feature transform is computed - default is
+   * off. */
+  void
+  SetComputeFeatureTransform(bool compute)
+  {
+    m_Erode->SetComputeFeatures(compute);
+    this->Modified();
+  }
+
+  const bool &
+  GetComputeFeatureTransform() const
+  {
+    return m_Erode->GetComputeFeatures();
+  }
+  itkBooleanMacro(ComputeFeatureTransform);
+
+  /** The feature transform. Each voxel holds the buffer offset of the
+   * nearest voxel with OutsideValue, which
+   * GetOutput()->ComputeIndex() converts to an index. Subtracting the
+   * voxel's own index gives the offset to the nearest voxel. Voxels
+   * refer to themselves if there is no OutsideValue voxel. */
+  FeatureImageType *
+  GetFeatureImage()
+  {
+    return itkDynamicCastInDebugMode<FeatureImageType *>(this->ProcessObject::GetOutput(1));
+  }
+
+  using DataObjectPointerArraySizeType = ProcessObject::DataObjectPointerArraySizeType;
+  using Superclass::MakeOutput;
+  DataObject::Pointer
+  MakeOutput(DataObjectPointerArraySizeType idx) override;
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro(SameDimension,
@@ -140,16 +270,13 @@ protected:
   GenerateData() override;
 
   // do everything in the output image type, which should have high precision
-  using ThreshType = typename itk::BinaryThresholdImageFilter<InputImageType, OutputImageType>;
-  using ErodeType = typename itk::ParabolicErodeImageFilter<OutputImageType, OutputImageType>;
-  using SqrtType = typename itk::SqrtImageFilter<OutputImageType, OutputImageType>;
+  using ErodeType = typename itk::ParabolicErodeImageFilter<InputImageType, OutputImageType>;
 
 private:
-  InputPixelType               m_OutsideValue;
-  typename ErodeType::Pointer  m_Erode;
-  typename ThreshType::Pointer m_Thresh;
-  typename SqrtType::Pointer   m_Sqrt;
-  bool                         m_SqrDist;
+  InputPixelType              m_OutsideValue;
+  typename ErodeType::Pointer m_Erode;
+  bool                        m_SqrDist;
+  double                      m_MaximumDistance;
 };
 } // namespace itk
 #ifndef ITK_MANUAL_INSTANTIATION
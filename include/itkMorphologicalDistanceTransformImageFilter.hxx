@@ -29,12 +29,24 @@ MorphologicalDistanceTransformImageFilter<TInputImage, TOutputImage>::Morphologi
   this->SetNumberOfRequiredInputs(1);
 
   m_Erode = ErodeType::New();
-  m_Thresh = ThreshType::New();
-  m_Sqrt = SqrtType::New();
   m_OutsideValue = 0;
   m_Erode->SetScale(0.5);
   this->SetUseImageSpacing(true);
   m_SqrDist = false;
+  m_MaximumDistance = NumericTraits<double>::max();
+
+  this->SetNthOutput(1, this->MakeOutput(1));
+}
+
+template <typename TInputImage, typename TOutputImage>
+DataObject::Pointer
+MorphologicalDistanceTransformImageFilter<TInputImage, TOutputImage>::MakeOutput(DataObjectPointerArraySizeType idx)
+{
+  if (idx == 1)
+  {
+    return FeatureImageType::New().GetPointer();
+  }
+  return Superclass::MakeOutput(idx);
 }
 
 template <typename TInputImage, typename TOutputImage>
@@ -43,8 +55,6 @@ MorphologicalDistanceTransformImageFilter<TInputImage, TOutputImage>::Modified()
 {
   Superclass::Modified();
   m_Erode->Modified();
-  m_Thresh->Modified();
-  m_Sqrt->Modified();
 }
 
 template <typename TInputImage, typename TOutputImage>
@@ -54,11 +64,7 @@ MorphologicalDistanceTransformImageFilter<TInputImage, TOutputImage>::GenerateDa
   ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
 
   progress->SetMiniPipelineFilter(this);
-  // these values are guesses at present - need to profile to get a
-  // real idea
-  progress->RegisterInternalFilter(m_Thresh, 0.1f);
-  progress->RegisterInternalFilter(m_Erode, 0.8f);
-  progress->RegisterInternalFilter(m_Sqrt, 0.1f);
+  progress->RegisterInternalFilter(m_Erode, 1.0f);
 
   // std::cout << "DT" << std::endl;
 
@@ -98,28 +104,60 @@ MorphologicalDistanceTransformImageFilter<TInputImage, TOutputImage>::GenerateDa
   //       }
   //     }
   //   Wt = sqrt(Wt);
-  this->AllocateOutputs();
+  // squared distances are whole numbers when the spacing is integral,
+  // so the exact integer version of the intersection algorithm can be
+  // used
+  bool integral = true;
+  if (this->GetUseImageSpacing())
+  {
+    for (unsigned k = 0; k < TOutputImage::ImageDimension; k++)
+    {
+      if (sp[k] != std::floor(sp[k]))
+      {
+        integral = false;
+      }
+    }
+  }
+  // a band limit replaces the initial distance of the inside voxels,
+  // so that everything beyond it is clamped
+  const double maxSqrDist = m_MaximumDistance * m_MaximumDistance;
+  bool         banded = maxSqrDist < MaxDist;
+  if (banded)
+  {
+    MaxDist = maxSqrDist;
+    integral = integral && (MaxDist == std::floor(MaxDist));
+  }
+  // squared distances the output pixel type can't hold are clamped to
+  // its maximum
+  const double pixelMax = static_cast<double>(NumericTraits<OutputPixelType>::max());
+  if (MaxDist > pixelMax)
+  {
+    MaxDist = pixelMax;
+    banded = true;
+    integral = integral && (MaxDist == std::floor(MaxDist));
+  }
+  m_Erode->SetUseClampValue(banded);
+  m_Erode->SetClampValue(MaxDist);
 
-  m_Thresh->SetLowerThreshold(m_OutsideValue);
-  m_Thresh->SetUpperThreshold(m_OutsideValue);
-  m_Thresh->SetOutsideValue(MaxDist);
-  m_Thresh->SetInsideValue(0);
+  m_Erode->SetParabolicAlgorithm(integral ? ErodeType::INTEGERINTERSECTION : ErodeType::INTERSECTION);
 
-  m_Thresh->SetInput(this->GetInput());
-  m_Erode->SetInput(m_Thresh->GetOutput());
+  // the outside voxels start at 0 and the rest at the largest
+  // distance, mapped as the first pass reads the mask. The last pass
+  // takes the square root as it writes.
+  m_Erode->SetUseInputThreshold(true);
+  m_Erode->SetLowerInputThreshold(m_OutsideValue);
+  m_Erode->SetUpperInputThreshold(m_OutsideValue);
+  m_Erode->SetInputInsideValue(0);
+  m_Erode->SetInputOutsideValue(MaxDist);
+  m_Erode->SetOutputSquareRoot(!m_SqrDist);
 
-  if (m_SqrDist)
-  {
-    m_Erode->GraftOutput(this->GetOutput());
-    m_Erode->Update();
-    this->GraftOutput(m_Erode->GetOutput());
-  }
-  else
+  m_Erode->SetInput(this->GetInput());
+  m_Erode->GraftOutput(this->GetOutput());
+  m_Erode->Update();
+  this->GraftOutput(m_Erode->GetOutput());
+  if (this->GetComputeFeatureTransform())
   {
-    m_Sqrt->SetInput(m_Erode->GetOutput());
-    m_Sqrt->GraftOutput(this->GetOutput());
-    m_Sqrt->Update();
-    this->GraftOutput(m_Sqrt->GetOutput());
+    this->GraftNthOutput(1, m_Erode->GetFeatureImage());
   }
 }
 
@@ -130,6 +168,8 @@ MorphologicalDistanceTransformImageFilter<TInputImage, TOutputImage>::PrintSelf(
   Superclass::PrintSelf(os, indent);
   os << "Outside Value = " << (OutputPixelType)m_OutsideValue << std::endl;
   os << "ImageScale = " << m_Erode->GetUseImageSpacing() << std::endl;
+  os << "ComputeFeatureTransform = " << m_Erode->GetComputeFeatures() << std::endl;
+  os << "MaximumDistance = " << m_MaximumDistance << std::endl;
 }
 } // namespace itk
 
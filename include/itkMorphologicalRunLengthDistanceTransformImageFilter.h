@@ -0,0 +1,173 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMorphologicalRunLengthDistanceTransformImageFilter_h
+#define itkMorphologicalRunLengthDistanceTransformImageFilter_h
+
+#include "itkImageToImageFilter.h"
+#include "itkLabelMap.h"
+
+#include "itkParabolicErodeImageFilter.h"
+
+namespace itk
+{
+/**
+ * \class MorphologicalRunLengthDistanceTransformImageFilter
+ * \brief Distance transform of a run length encoded mask using
+ * parabolic morphological methods
+ *
+ * The mask is a LabelMap - the runs of all label objects form the
+ * mask, anything else is background. Large sparse masks are much
+ * smaller in this form than as a dense image.
+ *
+ * The first pass of MorphologicalDistanceTransformImageFilter, along
+ * dimension 0, is the distance to the nearest outside voxel in the
+ * same row. LabelMap lines are runs along dimension 0, so this pass
+ * is computed directly from the run end points, without building a
+ * dense threshold image. The remaining dimensions are processed by a
+ * parabolic erosion as usual.
+ *
+ * By default the distance from the voxels in the runs to the nearest
+ * voxel that isn't in a run is computed, which is the same as the
+ * dense filter with the background as OutsideValue. With
+ * DistanceToRuns on, it is the distance from the voxels outside the
+ * runs to the nearest run voxel instead. Thresholding that gives the
+ * dilation of the mask by a sphere, and thresholding the default
+ * gives the erosion.
+ *
+ * The output is a dense image, see
+ * MorphologicalDistanceTransformImageFilter for the requirements on
+ * its pixel type and for MaximumDistance.
+ *
+ * \sa MorphologicalDistanceTransformImageFilter
+ *
+ * \ingroup ParabolicMorphology
+ *
+ * \author Richard Beare, Monash University, Department of Medicine,
+ * Melbourne, Australia. <Richard.Beare@monash.edu>
+ *
+ **/
+
+template <typename TInputImage, typename TOutputImage>
+class ITK_TEMPLATE_EXPORT MorphologicalRunLengthDistanceTransformImageFilter
+  : public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(MorphologicalRunLengthDistanceTransformImageFilter);
+
+  /** Standard class type alias. */
+  using Self = MorphologicalRunLengthDistanceTransformImageFilter;
+  using Superclass = ImageToImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(MorphologicalRunLengthDistanceTransformImageFilter, ImageToImageFilter);
+
+  /** Type of the input label map */
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using LabelObjectType = typename TInputImage::LabelObjectType;
+  using OutputPixelType = typename TOutputImage::PixelType;
+  using ScalarRealType = typename NumericTraits<OutputPixelType>::ScalarRealType;
+
+  /** Image related type alias. */
+  static constexpr unsigned int OutputImageDimension = TOutputImage::ImageDimension;
+  static constexpr unsigned int InputImageDimension = TInputImage::ImageDimension;
+  static constexpr unsigned int ImageDimension = TOutputImage::ImageDimension;
+
+  void
+  Modified() const override;
+
+  /** Is the transform in world or voxel units - default is world */
+  itkSetMacro(UseImageSpacing, bool);
+  itkGetConstReferenceMacro(UseImageSpacing, bool);
+  itkBooleanMacro(UseImageSpacing);
+
+  itkSetMacro(SqrDist, bool);
+  itkGetConstReferenceMacro(SqrDist, bool);
+  itkBooleanMacro(SqrDist);
+
+  /** Set/Get whether the distance is measured from the voxels outside
+   * the runs to the nearest run, rather than from the voxels in the
+   * runs to the nearest voxel outside them - default is off. */
+  itkSetMacro(DistanceToRuns, bool);
+  itkGetConstReferenceMacro(DistanceToRuns, bool);
+  itkBooleanMacro(DistanceToRuns);
+
+  /** Set/Get the largest distance computed, in the units of the
+   * transform. Larger distances are reported as MaximumDistance.
+   * Default is unlimited. */
+  itkSetMacro(MaximumDistance, double);
+  itkGetConstReferenceMacro(MaximumDistance, double);
+
+  /** Fraction of the lines of the last update skipped by the erosion
+   * because they were constant. See ParabolicErodeDilateImageFilter. */
+  const double &
+  GetSkippedLineFraction() const
+  {
+    return m_Erode->GetSkippedLineFraction();
+  }
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  /** Begin concept checking */
+  itkConceptMacro(SameDimension,
+                  (Concept::SameDimension<itkGetStaticConstMacro(InputImageDimension),
+                                          itkGetStaticConstMacro(OutputImageDimension)>));
+
+  /** End concept checking */
+#endif
+protected:
+  MorphologicalRunLengthDistanceTransformImageFilter();
+  ~MorphologicalRunLengthDistanceTransformImageFilter() override = default;
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** The whole label map is needed */
+  void
+  GenerateInputRequestedRegion() override;
+
+  /** The whole output is produced */
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  /** Generate Data */
+  void
+  GenerateData() override;
+
+  /** Squared distances along dimension 0, from the run end points */
+  void
+  RunLengthFirstPass(OutputImageType * image, double maxDist, double spacing);
+
+  using ErodeType = typename itk::ParabolicErodeImageFilter<OutputImageType, OutputImageType>;
+
+private:
+  typename ErodeType::Pointer m_Erode;
+  bool                        m_UseImageSpacing;
+  bool                        m_SqrDist;
+  bool                        m_DistanceToRuns;
+  double                      m_MaximumDistance;
+};
+} // namespace itk
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkMorphologicalRunLengthDistanceTransformImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,275 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkMorphologicalRunLengthDistanceTransformImageFilter_hxx
+#define itkMorphologicalRunLengthDistanceTransformImageFilter_hxx
+
+#include "itkProgressAccumulator.h"
+#include <algorithm>
+#include <vector>
+
+namespace itk
+{
+template <typename TInputImage, typename TOutputImage>
+MorphologicalRunLengthDistanceTransformImageFilter<TInputImage,
+                                                   TOutputImage>::MorphologicalRunLengthDistanceTransformImageFilter()
+{
+  this->SetNumberOfRequiredOutputs(1);
+  this->SetNumberOfRequiredInputs(1);
+
+  m_Erode = ErodeType::New();
+  // dimension 0 comes from the runs and is left as it is by the erosion
+  typename ErodeType::RadiusType scale;
+  scale.Fill(0.5);
+  scale[0] = 0;
+  m_Erode->SetScale(scale);
+  m_UseImageSpacing = true;
+  m_SqrDist = false;
+  m_DistanceToRuns = false;
+  m_MaximumDistance = NumericTraits<double>::max();
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+MorphologicalRunLengthDistanceTransformImageFilter<TInputImage, TOutputImage>::Modified() const
+{
+  Superclass::Modified();
+  m_Erode->Modified();
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+MorphologicalRunLengthDistanceTransformImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  auto * input = const_cast<InputImageType *>(this->GetInput());
+  if (input)
+  {
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+MorphologicalRunLengthDistanceTransformImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedRegion(
+  DataObject * output)
+{
+  auto * out = dynamic_cast<OutputImageType *>(output);
+  if (out)
+  {
+    out->SetRequestedRegion(out->GetLargestPossibleRegion());
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+MorphologicalRunLengthDistanceTransformImageFilter<TInputImage, TOutputImage>::RunLengthFirstPass(
+  OutputImageType * image,
+  double            maxDist,
+  double            spacing)
+{
+  using RegionType = typename OutputImageType::RegionType;
+  using IndexType = typename OutputImageType::IndexType;
+  using RunType = std::pair<IndexValueType, IndexValueType>;
+
+  struct LineRun
+  {
+    SizeValueType  line;
+    IndexValueType first;
+    IndexValueType last;
+  };
+
+  const RegionType     region = image->GetBufferedRegion();
+  const IndexType      start = region.GetIndex();
+  const IndexValueType length = region.GetSize()[0];
+
+  // gather the runs, numbered by the line they are in
+  std::vector<LineRun> runs;
+  for (typename InputImageType::ConstIterator it(this->GetInput()); !it.IsAtEnd(); ++it)
+  {
+    for (typename LabelObjectType::ConstLineIterator lit(it.GetLabelObject()); !lit.IsAtEnd(); ++lit)
+    {
+      IndexType            index = lit.GetLine().GetIndex();
+      const IndexValueType first = index[0] - start[0];
+      const IndexValueType last = first + static_cast<IndexValueType>(lit.GetLine().GetLength()) - 1;
+      index[0] = start[0];
+      if (!region.IsInside(index) || last < 0 || first >= length)
+      {
+        continue;
+      }
+      runs.push_back({ static_cast<SizeValueType>(image->ComputeOffset(index)) / length,
+                       std::max(first, IndexValueType{ 0 }),
+                       std::min(last, length - 1) });
+    }
+  }
+  std::sort(runs.begin(), runs.end(), [](const LineRun & a, const LineRun & b) {
+    return (a.line < b.line) || (a.line == b.line && a.first < b.first);
+  });
+
+  // lines without runs are either all outside or all inside
+  image->FillBuffer(static_cast<OutputPixelType>(m_DistanceToRuns ? maxDist : 0.0));
+
+  // distances across the segment [first, last] to the outside voxels
+  // on either side of it, if there are any
+  auto fillSegment = [=](OutputPixelType * line, IndexValueType first, IndexValueType last) {
+    const bool left = first > 0;
+    const bool right = last < length - 1;
+    for (IndexValueType x = first; x <= last; x++)
+    {
+      double value = maxDist;
+      if (left || right)
+      {
+        IndexValueType d = left ? x - first + 1 : length;
+        if (right)
+        {
+          d = std::min(d, last + 1 - x);
+        }
+        const double dist = d * spacing;
+        value = std::min(dist * dist, maxDist);
+      }
+      line[x] = static_cast<OutputPixelType>(value);
+    }
+  };
+
+  OutputPixelType *    buffer = image->GetBufferPointer();
+  std::vector<RunType> merged;
+  for (size_t i = 0; i < runs.size();)
+  {
+    const SizeValueType lineNumber = runs[i].line;
+    OutputPixelType *   line = buffer + lineNumber * length;
+
+    // runs of different label objects may touch or overlap
+    merged.clear();
+    for (; i < runs.size() && runs[i].line == lineNumber; i++)
+    {
+      if (!merged.empty() && runs[i].first <= merged.back().second + 1)
+      {
+        merged.back().second = std::max(merged.back().second, runs[i].last);
+      }
+      else
+      {
+        merged.emplace_back(runs[i].first, runs[i].last);
+      }
+    }
+
+    if (m_DistanceToRuns)
+    {
+      // the runs are the outside voxels, the gaps between them are
+      // measured
+      IndexValueType next = 0;
+      for (const RunType & run : merged)
+      {
+        if (run.first > next)
+        {
+          fillSegment(line, next, run.first - 1);
+        }
+        std::fill(line + run.first, line + run.second + 1, OutputPixelType{});
+        next = run.second + 1;
+      }
+      if (next < length)
+      {
+        fillSegment(line, next, length - 1);
+      }
+    }
+    else
+    {
+      for (const RunType & run : merged)
+      {
+        fillSegment(line, run.first, run.second);
+      }
+    }
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+MorphologicalRunLengthDistanceTransformImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
+  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+
+  progress->SetMiniPipelineFilter(this);
+  progress->RegisterInternalFilter(m_Erode, 1.0f);
+
+  OutputImageType * output = this->GetOutput();
+
+  double                                   MaxDist = 0.0;
+  const typename TOutputImage::SpacingType sp = output->GetSpacing();
+  const typename TOutputImage::SizeType    sz = output->GetLargestPossibleRegion().GetSize();
+  bool                                     integral = true;
+  for (unsigned k = 0; k < TOutputImage::ImageDimension; k++)
+  {
+    const double scale = m_UseImageSpacing ? sp[k] : 1.0;
+    const double thisdim = sz[k] * scale;
+    MaxDist += thisdim * thisdim;
+    if (scale != std::floor(scale))
+    {
+      integral = false;
+    }
+  }
+  const double maxSqrDist = m_MaximumDistance * m_MaximumDistance;
+  bool         banded = maxSqrDist < MaxDist;
+  if (banded)
+  {
+    MaxDist = maxSqrDist;
+    integral = integral && (MaxDist == std::floor(MaxDist));
+  }
+  // squared distances the output pixel type can't hold are clamped to
+  // its maximum
+  const double pixelMax = static_cast<double>(NumericTraits<OutputPixelType>::max());
+  if (MaxDist > pixelMax)
+  {
+    MaxDist = pixelMax;
+    banded = true;
+    integral = integral && (MaxDist == std::floor(MaxDist));
+  }
+
+  // the first pass replaces the threshold image of the dense filter.
+  // Its buffer becomes the output, as the erosion of the other
+  // dimensions works in place.
+  typename OutputImageType::Pointer firstPass = OutputImageType::New();
+  firstPass->CopyInformation(output);
+  firstPass->SetRegions(output->GetRequestedRegion());
+  firstPass->Allocate();
+  this->RunLengthFirstPass(firstPass, MaxDist, m_UseImageSpacing ? sp[0] : 1.0);
+
+  m_Erode->SetUseImageSpacing(m_UseImageSpacing);
+  m_Erode->SetUseClampValue(banded);
+  m_Erode->SetClampValue(MaxDist);
+  m_Erode->SetParabolicAlgorithm(integral ? ErodeType::INTEGERINTERSECTION : ErodeType::INTERSECTION);
+  m_Erode->SetOutputSquareRoot(!m_SqrDist);
+  m_Erode->m_InPlace = true;
+  m_Erode->SetInput(firstPass);
+  m_Erode->GraftOutput(output);
+  m_Erode->Update();
+  this->GraftOutput(m_Erode->GetOutput());
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+MorphologicalRunLengthDistanceTransformImageFilter<TInputImage, TOutputImage>::PrintSelf(std::ostream & os,
+                                                                                       Indent         indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << "ImageScale = " << m_UseImageSpacing << std::endl;
+  os << "SqrDist = " << m_SqrDist << std::endl;
+  os << "DistanceToRuns = " << m_DistanceToRuns << std::endl;
+  os << "MaximumDistance = " << m_MaximumDistance << std::endl;
+}
+} // namespace itk
+
+#endif
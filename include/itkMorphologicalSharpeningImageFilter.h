@@ -18,11 +18,10 @@
 #ifndef itkMorphologicalSharpeningImageFilter_h
 #define itkMorphologicalSharpeningImageFilter_h
 
+#include <atomic>
+#include <vector>
+
 #include "itkImageToImageFilter.h"
-//#include "itkProgressReporter.h"
-#include "itkCastImageFilter.h"
-#include "itkParabolicErodeImageFilter.h"
-#include "itkParabolicDilateImageFilter.h"
 #include "itkSharpenOpImageFilter.h"
 
 namespace itk
@@ -33,8 +32,13 @@ namespace itk
  * structuring elements.
  *
  * This is an implemtentation of the method of Schavemaker for testing
- * the parabolic morphology routines. No particular efforts have been
- * made to minimize memory consumption.
+ * the parabolic morphology routines.
+ *
+ * Each pass along a dimension computes the erosion and the dilation
+ * of the same lines together, and the last pass applies the
+ * sharpening selection (see SharpenOpImageFilter) as it writes the
+ * output, reading the input directly. Apart from the output, only the
+ * erosion and dilation images are stored.
  *
  *
  * \@article{Schavemaker2000,
@@ -104,39 +108,39 @@ public:
   itkSetMacro(Iterations, int);
   itkGetConstReferenceMacro(Iterations, int);
 
+  /**
+   * Set/Get early stopping. When on, the iterations stop once one of
+   * them changes no more than ConvergenceThreshold pixels, so
+   * Iterations becomes an upper limit. An iteration that changes
+   * nothing leaves all later ones nothing to change, so with a
+   * threshold of 0 the output is the same as without stopping. Default
+   * is off.
+   */
+  itkSetMacro(StopOnConvergence, bool);
+  itkGetConstReferenceMacro(StopOnConvergence, bool);
+  itkBooleanMacro(StopOnConvergence);
+  itkSetMacro(ConvergenceThreshold, SizeValueType);
+  itkGetConstReferenceMacro(ConvergenceThreshold, SizeValueType);
+
+  /** Number of iterations run by the last update */
+  itkGetConstReferenceMacro(IterationsUsed, int);
+
+  /** Number of pixels changed by each iteration of the last update */
+  itkGetConstReferenceMacro(ChangedPixels, std::vector<SizeValueType>);
+
   void
   SetScale(ScalarRealType scale)
   {
-    m_Erode->SetScale(scale);
-    m_Dilate->SetScale(scale);
+    RadiusType s;
+    s.Fill(scale);
+    this->SetScale(s);
   }
 
-  void
-  SetScale(RadiusType scale)
-  {
-    m_Erode->SetScale(scale);
-    m_Dilate->SetScale(scale);
-  }
+  itkSetMacro(Scale, RadiusType);
+  itkGetConstReferenceMacro(Scale, RadiusType);
 
-  void
-  SetUseImageSpacing(bool uis)
-  {
-    m_Erode->SetUseImageSpacing(uis);
-    m_Dilate->SetUseImageSpacing(uis);
-  }
-
-  // need to include the Get methods
-  const RadiusType &
-  GetScale()
-  {
-    return m_Erode->GetScale();
-  }
-
-  const bool &
-  GetUseImageSpacing()
-  {
-    return m_Erode->GetUseImageSpacing();
-  }
+  itkSetMacro(UseImageSpacing, bool);
+  itkGetConstReferenceMacro(UseImageSpacing, bool);
 
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
@@ -158,21 +162,43 @@ protected:
   void
   GenerateData() override;
 
-  // do everything in the output image type, which should have high precision
-  using ErodeType = typename itk::ParabolicErodeImageFilter<OutputImageType, OutputImageType>;
-  using DilateType = typename itk::ParabolicDilateImageFilter<OutputImageType, OutputImageType>;
-  using CastType = typename itk::CastImageFilter<InputImageType, OutputImageType>;
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+
+  unsigned int
+  SplitRequestedRegion(unsigned int i, unsigned int num, OutputImageRegionType & splitRegion) override;
+
+  void
+  ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId) override;
+
+  void
+  GenerateInputRequestedRegion() override;
+
+  // Override since the filter produces the entire dataset.
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
 
-  using SharpenOpType =
-    typename itk::SharpenOpImageFilter<OutputImageType, OutputImageType, OutputImageType, OutputImageType>;
+  // the erosion and dilation are stored in the output image type,
+  // which should have high precision
+  using SelectType = Function::SharpM<OutputPixelType, OutputPixelType, OutputPixelType, OutputPixelType>;
 
 private:
-  int m_Iterations;
+  int           m_Iterations;
+  RadiusType    m_Scale;
+  bool          m_UseImageSpacing;
+  bool          m_StopOnConvergence;
+  SizeValueType m_ConvergenceThreshold;
+  int           m_IterationsUsed;
+
+  std::vector<SizeValueType> m_ChangedPixels;
+
+  int m_CurrentDimension;
+  int m_CurrentIteration;
+
+  typename OutputImageType::Pointer m_Erosion;
+  typename OutputImageType::Pointer m_Dilation;
 
-  typename ErodeType::Pointer     m_Erode;
-  typename DilateType::Pointer    m_Dilate;
-  typename CastType::Pointer      m_Cast;
-  typename SharpenOpType::Pointer m_SharpenOp;
+  // pixels changed by the threads in the current iteration
+  std::atomic<SizeValueType> m_ChangedInIteration{ 0 };
 };
 } // namespace itk
 #ifndef ITK_MANUAL_INSTANTIATION
@@ -18,7 +18,8 @@
 #ifndef itkMorphologicalSharpeningImageFilter_hxx
 #define itkMorphologicalSharpeningImageFilter_hxx
 
-#include "itkProgressAccumulator.h"
+#include "itkParabolicLineAccessor.h"
+#include "itkParabolicMorphUtils.h"
 
 namespace itk
 
@@ -29,64 +30,257 @@ MorphologicalSharpeningImageFilter<TInputImage, TOutputImage>::MorphologicalShar
   this->SetNumberOfRequiredOutputs(1);
   this->SetNumberOfRequiredInputs(1);
 
-  m_Erode = ErodeType::New();
-  m_Dilate = DilateType::New();
-  m_Cast = CastType::New();
-  m_SharpenOp = SharpenOpType::New();
   m_Iterations = 1;
-  this->SetScale(1);
-  this->SetUseImageSpacing(false);
+  m_Scale.Fill(1);
+  m_UseImageSpacing = false;
+  m_StopOnConvergence = false;
+  m_ConvergenceThreshold = 0;
+  m_IterationsUsed = 0;
+  m_CurrentDimension = 0;
+  m_CurrentIteration = 0;
+
+  this->DynamicMultiThreadingOff();
+}
+
+template <typename TInputImage, typename TOutputImage>
+unsigned int
+MorphologicalSharpeningImageFilter<TInputImage, TOutputImage>::SplitRequestedRegion(unsigned int            i,
+                                                                                   unsigned int            num,
+                                                                                   OutputImageRegionType & splitRegion)
+{
+  // Get the output pointer
+  OutputImageType * outputPtr = this->GetOutput();
+
+  // Initialize the splitRegion to the output requested region
+  splitRegion = outputPtr->GetRequestedRegion();
+
+  const typename OutputImageType::SizeType & requestedRegionSize = splitRegion.GetSize();
+
+  typename OutputImageType::IndexType splitIndex = splitRegion.GetIndex();
+  typename OutputImageType::SizeType  splitSize = splitRegion.GetSize();
+
+  // split on the outermost dimension available
+  // and avoid the current dimension
+  int splitAxis = static_cast<int>(outputPtr->GetImageDimension()) - 1;
+  while ((requestedRegionSize[splitAxis] == 1) || (splitAxis == static_cast<int>(m_CurrentDimension)))
+  {
+    --splitAxis;
+    if (splitAxis < 0)
+    { // cannot split
+      itkDebugMacro("Cannot Split");
+      return 1;
+    }
+  }
+
+  // determine the actual number of pieces that will be generated
+  auto range = static_cast<double>(requestedRegionSize[splitAxis]);
+
+  auto         valuesPerThread = static_cast<unsigned int>(std::ceil(range / static_cast<double>(num)));
+  unsigned int maxThreadIdUsed = static_cast<unsigned int>(std::ceil(range / static_cast<double>(valuesPerThread))) - 1;
+
+  // Split the region
+  if (i < maxThreadIdUsed)
+  {
+    splitIndex[splitAxis] += i * valuesPerThread;
+    splitSize[splitAxis] = valuesPerThread;
+  }
+  if (i == maxThreadIdUsed)
+  {
+    splitIndex[splitAxis] += i * valuesPerThread;
+    // last thread needs to process the "rest" dimension being split
+    splitSize[splitAxis] = splitSize[splitAxis] - i * valuesPerThread;
+  }
+
+  // set the split region ivars
+  splitRegion.SetIndex(splitIndex);
+  splitRegion.SetSize(splitSize);
+
+  itkDebugMacro("Split Piece: " << splitRegion);
+
+  return maxThreadIdUsed + 1;
 }
 
 template <typename TInputImage, typename TOutputImage>
 void
-MorphologicalSharpeningImageFilter<TInputImage, TOutputImage>::GenerateData()
+MorphologicalSharpeningImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  // This filter needs all of the input
+  InputImagePointer image = const_cast<InputImageType *>(this->GetInput());
+  if (image)
+  {
+    image->SetRequestedRegion(this->GetInput()->GetLargestPossibleRegion());
+  }
+}
+
+template <typename TInputImage, typename TOutputImage>
+void
+MorphologicalSharpeningImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedRegion(DataObject * output)
 {
-  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+  auto * out = dynamic_cast<TOutputImage *>(output);
 
-  progress->SetMiniPipelineFilter(this);
+  if (out)
+  {
+    out->SetRequestedRegion(out->GetLargestPossibleRegion());
+  }
+}
 
+template <typename TInputImage, typename TOutputImage>
+void
+MorphologicalSharpeningImageFilter<TInputImage, TOutputImage>::GenerateData()
+{
   // Allocate the output
   this->AllocateOutputs();
+  typename TOutputImage::Pointer outputImage(this->GetOutput());
 
-  InputImageConstPointer inputImage = this->GetInput();
-  m_Cast->SetInput(inputImage);
-
-  // set the input to the morph operations
-  m_Erode->SetInput(m_Cast->GetOutput());
-  m_Dilate->SetInput(m_Cast->GetOutput());
-  m_SharpenOp->SetInput(m_Dilate->GetOutput());
-  m_SharpenOp->SetInput2(m_Cast->GetOutput());
-  m_SharpenOp->SetInput3(m_Erode->GetOutput());
+  // the erosion and dilation between the passes. A single pass goes
+  // straight from the input to the output.
+  if (ImageDimension > 1)
+  {
+    m_Erosion = OutputImageType::New();
+    m_Erosion->SetRegions(outputImage->GetRequestedRegion());
+    m_Erosion->Allocate();
+    m_Dilation = OutputImageType::New();
+    m_Dilation->SetRegions(outputImage->GetRequestedRegion());
+    m_Dilation->Allocate();
+  }
 
-  progress->RegisterInternalFilter(m_Erode, 1.0f);
-  progress->RegisterInternalFilter(m_Dilate, 1.0f);
-  progress->RegisterInternalFilter(m_SharpenOp, 1.0f);
+  typename ImageSource<OutputImageType>::ThreadStruct str;
+  str.Filter = this;
 
-  // set up the progrss monitor
-  // WatershedMiniPipelineProgressCommand::Pointer c =
-  //   WatershedMiniPipelineProgressCommand::New();
-  // c->SetFilter(this);
-  // c->SetNumberOfFilters(3 * m_Iterations);
+  ProcessObject::MultiThreaderType * multithreader = this->GetMultiThreader();
+  multithreader->SetNumberOfWorkUnits(this->GetNumberOfWorkUnits());
+  multithreader->SetSingleMethod(this->ThreaderCallback, &str);
 
-  // m_Erode->AddObserver(ProgressEvent(), c);
-  // m_Dilate->AddObserver(ProgressEvent(), c);
-  // m_SharpenOp->AddObserver(ProgressEvent(), c);
+  // iterations after the first sharpen the output in place. The last
+  // pass sees each pixel before and after, so changes are counted as
+  // it writes.
+  m_ChangedPixels.clear();
+  m_IterationsUsed = 0;
+  for (m_CurrentIteration = 0; m_CurrentIteration < m_Iterations; m_CurrentIteration++)
+  {
+    m_ChangedInIteration = 0;
+    for (unsigned int d = 0; d < ImageDimension; d++)
+    {
+      m_CurrentDimension = d;
+      multithreader->SingleMethodExecute();
+    }
+    m_ChangedPixels.push_back(m_ChangedInIteration);
+    ++m_IterationsUsed;
+    if (m_StopOnConvergence && m_ChangedInIteration <= m_ConvergenceThreshold)
+    {
+      break;
+    }
+  }
+  m_Erosion = nullptr;
+  m_Dilation = nullptr;
+}
 
-  for (int i = 0; i < m_Iterations; i++)
+template <typename TInputImage, typename TOutputImage>
+void
+MorphologicalSharpeningImageFilter<TInputImage, TOutputImage>::ThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType                  threadId)
+{
+  const unsigned int d = m_CurrentDimension;
+  const bool         first = (d == 0);
+  const bool         last = (d == ImageDimension - 1);
+  const bool         process = m_Scale[d] > 0;
+  if (!process && !first && !last)
   {
-    if (i != 0)
+    // the erosion and dilation stay where they are
+    return;
+  }
+
+  const typename OutputImageType::SizeType & size = outputRegionForThread.GetSize();
+  const size_t                               rows = outputRegionForThread.GetNumberOfPixels() / size[d];
+  const float                                progressPerPass = 1.0 / (ImageDimension * std::max(m_Iterations, 1));
+  ProgressReporter progress(
+    this, threadId, rows, 30, (m_CurrentIteration * ImageDimension + d) * progressPerPass, progressPerPass);
+
+  using InputConstIteratorType = ParabolicLineAccessor<const TInputImage>;
+  using OutputIteratorType = ParabolicLineAccessor<TOutputImage>;
+  using OutputConstIteratorType = ParabolicLineAccessor<const TOutputImage>;
+
+  const OutputImageRegionType & region = outputRegionForThread;
+
+  typename TInputImage::ConstPointer inputImage(this->GetInput());
+  typename TOutputImage::Pointer     outputImage(this->GetOutput());
+  OutputIteratorType                 outputIterator(outputImage.GetPointer(), region);
+
+  SelectType select;
+  auto       runPass = [&](auto & sourceIterator) {
+    const auto image_scale = static_cast<RealType>(inputImage->GetSpacing()[d]);
+    const auto scale = static_cast<RealType>(m_Scale[d]);
+    if (ImageDimension == 1)
+    {
+      m_ChangedInIteration += doOneDimensionSharpen(sourceIterator,
+                                                    sourceIterator,
+                                                    outputIterator,
+                                                    outputIterator,
+                                                    sourceIterator,
+                                                    outputIterator,
+                                                    select,
+                                                    progress,
+                                                    size[d],
+                                                    d,
+                                                    m_UseImageSpacing,
+                                                    image_scale,
+                                                    scale,
+                                                    true);
+      return;
+    }
+    OutputIteratorType      erodeIterator(m_Erosion.GetPointer(), region);
+    OutputIteratorType      dilateIterator(m_Dilation.GetPointer(), region);
+    OutputConstIteratorType erodeInputIterator(m_Erosion.GetPointer(), region);
+    OutputConstIteratorType dilateInputIterator(m_Dilation.GetPointer(), region);
+    if (first)
+    {
+      // both start from the image being sharpened, which is read once
+      doOneDimensionSharpen(sourceIterator,
+                            sourceIterator,
+                            erodeIterator,
+                            dilateIterator,
+                            sourceIterator,
+                            outputIterator,
+                            select,
+                            progress,
+                            size[d],
+                            d,
+                            m_UseImageSpacing,
+                            image_scale,
+                            scale,
+                            false);
+    }
+    else
     {
-      m_Erode->SetInput(this->GetOutput());
-      m_Dilate->SetInput(this->GetOutput());
-      m_SharpenOp->SetInput2(this->GetOutput());
-      m_Erode->Modified();
-      m_Dilate->Modified();
+      m_ChangedInIteration += doOneDimensionSharpen(erodeInputIterator,
+                                                    dilateInputIterator,
+                                                    erodeIterator,
+                                                    dilateIterator,
+                                                    sourceIterator,
+                                                    outputIterator,
+                                                    select,
+                                                    progress,
+                                                    size[d],
+                                                    d,
+                                                    m_UseImageSpacing,
+                                                    image_scale,
+                                                    scale,
+                                                    last);
     }
+  };
 
-    m_SharpenOp->GraftOutput(this->GetOutput());
-    m_SharpenOp->Update();
-    this->GraftOutput(m_SharpenOp->GetOutput());
+  if (m_CurrentIteration == 0)
+  {
+    InputConstIteratorType sourceIterator(inputImage.GetPointer(), region);
+    runPass(sourceIterator);
+  }
+  else
+  {
+    OutputConstIteratorType sourceIterator(outputImage.GetPointer(), region);
+    runPass(sourceIterator);
   }
 }
 
@@ -96,6 +290,11 @@ MorphologicalSharpeningImageFilter<TInputImage, TOutputImage>::PrintSelf(std::os
 {
   Superclass::PrintSelf(os, indent);
   os << "Iterations = " << m_Iterations << std::endl;
+  os << indent << "Scale: " << m_Scale << std::endl;
+  os << indent << "UseImageSpacing: " << m_UseImageSpacing << std::endl;
+  os << indent << "StopOnConvergence: " << m_StopOnConvergence << std::endl;
+  os << indent << "ConvergenceThreshold: " << m_ConvergenceThreshold << std::endl;
+  os << indent << "IterationsUsed: " << m_IterationsUsed << std::endl;
 }
 } // end namespace itk
 
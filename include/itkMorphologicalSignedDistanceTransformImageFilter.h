@@ -21,10 +21,7 @@
 #include "itkImageToImageFilter.h"
 #include "itkProgressReporter.h"
 
-#include "itkBinaryThresholdImageFilter.h"
 #include "itkParabolicErodeImageFilter.h"
-#include "itkParabolicDilateImageFilter.h"
-#include "itkMorphSDTHelperImageFilter.h"
 
 namespace itk
 {
@@ -41,6 +38,10 @@ namespace itk
  * the nearest zero valued voxel. Thus we can compute the distance
  * transform by taking the sqrt of the erosion.
  *
+ * Both sides are computed by a single erosion in SignedDistances
+ * mode, which reads the mask directly and writes the signed square
+ * root in its last pass, so the only full size image is the output.
+ *
  * The output pixel type needs to support values as large as the
  * square of the largest value of the distance - just use float to be
  * safe.
@@ -70,6 +71,7 @@ namespace itk
 template <typename TInputImage, typename TOutputImage = TInputImage>
 class ITK_TEMPLATE_EXPORT MorphologicalSignedDistanceTransformImageFilter
   : public ImageToImageFilter<TInputImage, TOutputImage>
+  , public ParabolicMorphologyEnums
 {
 public:
   ITK_DISALLOW_COPY_AND_MOVE(MorphologicalSignedDistanceTransformImageFilter);
@@ -135,27 +137,83 @@ public:
   SetUseImageSpacing(bool uis)
   {
     m_Erode->SetUseImageSpacing(uis);
-    m_Dilate->SetUseImageSpacing(uis);
     this->Modified();
   }
 
-  enum ParabolicAlgorithm
-  {
-    NOCHOICE = 0,     // decices based on scale - experimental
-    CONTACTPOINT = 1, // sometimes faster at low scale
-    INTERSECTION = 2  // default
-  };
-
   /**
-   * Set/Get the method used. Choices are contact point or
-   * intersection. Intersection is the default. Contact point can be
-   * faster at small scales. This is very unlikely to be the case for
-   * a distance transform.
+   * Set/Get the method used. The signed passes only have the
+   * intersection algorithms, so INTEGERINTERSECTION is computed with
+   * integer arithmetic and every other choice with INTERSECTION, the
+   * default. When the spacing is integral, or not used, INTERSECTION
+   * is computed exactly with integer arithmetic as well.
    */
 
   itkSetMacro(ParabolicAlgorithm, int);
   itkGetConstReferenceMacro(ParabolicAlgorithm, int);
 
+  /** Set/Get the way lines are transferred between the image and the
+   * line buffers by the internal erosion. See
+   * ParabolicErodeDilateImageFilter. */
+  void
+  SetExecutionMode(int mode)
+  {
+    m_Erode->SetExecutionMode(mode);
+    this->Modified();
+  }
+
+  const int &
+  GetExecutionMode() const
+  {
+    return m_Erode->GetExecutionMode();
+  }
+
+  using ExecutionStrategyType = FixedArray<int, ImageDimension>;
+  /** The line transfer used for each dimension by the last update */
+  const ExecutionStrategyType &
+  GetExecutionStrategy() const
+  {
+    return m_Erode->GetExecutionStrategy();
+  }
+
+  /** Set/Get the precision of the line buffers of the internal
+   * erosion. See ParabolicErodeDilateImageFilter. */
+  void
+  SetKernelPrecision(int precision)
+  {
+    m_Erode->SetKernelPrecision(precision);
+    this->Modified();
+  }
+
+  const int &
+  GetKernelPrecision() const
+  {
+    return m_Erode->GetKernelPrecision();
+  }
+
+  /** Set/Get precision validation of the internal erosion. See
+   * ParabolicErodeDilateImageFilter. */
+  void
+  SetValidatePrecision(bool validate)
+  {
+    m_Erode->SetValidatePrecision(validate);
+    this->Modified();
+  }
+
+  const bool &
+  GetValidatePrecision() const
+  {
+    return m_Erode->GetValidatePrecision();
+  }
+  itkBooleanMacro(ValidatePrecision);
+
+  /** Largest difference from the double precision output found by
+   * the last update with ValidatePrecision on */
+  const double &
+  GetMaximumPrecisionError() const
+  {
+    return m_Erode->GetMaximumPrecisionError();
+  }
+
   const bool &
   GetUseImageSpacing()
   {
@@ -184,19 +242,13 @@ protected:
 
   int m_ParabolicAlgorithm;
 
-  // do everything in the output image type, which should have high precision
-  using ThreshType = typename itk::BinaryThresholdImageFilter<InputImageType, OutputImageType>;
-  using ErodeType = typename itk::ParabolicErodeImageFilter<OutputImageType, OutputImageType>;
-  using DilateType = typename itk::ParabolicDilateImageFilter<OutputImageType, OutputImageType>;
-  using HelperType = typename itk::MorphSDTHelperImageFilter<OutputImageType, OutputImageType>;
+  // the passes work in the output image type, which should have high precision
+  using ErodeType = typename itk::ParabolicErodeImageFilter<InputImageType, OutputImageType>;
 
 private:
-  InputPixelType               m_OutsideValue;
-  bool                         m_InsideIsPositive;
-  typename ErodeType::Pointer  m_Erode;
-  typename DilateType::Pointer m_Dilate;
-  typename ThreshType::Pointer m_Thresh;
-  typename HelperType::Pointer m_Helper;
+  InputPixelType              m_OutsideValue;
+  bool                        m_InsideIsPositive;
+  typename ErodeType::Pointer m_Erode;
 };
 } // namespace itk
 #ifndef ITK_MANUAL_INSTANTIATION
@@ -30,11 +30,10 @@ MorphologicalSignedDistanceTransformImageFilter<TInputImage,
   this->SetNumberOfRequiredInputs(1);
 
   m_Erode = ErodeType::New();
-  m_Dilate = DilateType::New();
-  m_Thresh = ThreshType::New();
-  m_Helper = HelperType::New();
   m_Erode->SetScale(0.5);
-  m_Dilate->SetScale(0.5);
+  m_Erode->SetSignedDistances(true);
+  m_Erode->SetOutputSquareRoot(true);
+  m_Erode->SetUseInputThreshold(true);
   this->SetUseImageSpacing(true);
   this->SetInsideIsPositive(false);
   m_OutsideValue = 0;
@@ -47,9 +46,6 @@ MorphologicalSignedDistanceTransformImageFilter<TInputImage, TOutputImage>::Modi
 {
   Superclass::Modified();
   m_Erode->Modified();
-  m_Dilate->Modified();
-  m_Thresh->Modified();
-  m_Helper->Modified();
 }
 
 template <typename TInputImage, typename TOutputImage>
@@ -59,15 +55,7 @@ MorphologicalSignedDistanceTransformImageFilter<TInputImage, TOutputImage>::Gene
   ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
 
   progress->SetMiniPipelineFilter(this);
-  // these values are guesses at present - need to profile to get a
-  // real idea
-  progress->RegisterInternalFilter(m_Thresh, 0.1f);
-  progress->RegisterInternalFilter(m_Erode, 0.4f);
-  progress->RegisterInternalFilter(m_Dilate, 0.4f);
-  progress->RegisterInternalFilter(m_Helper, 0.1f);
-
-  m_Erode->SetParabolicAlgorithm(m_ParabolicAlgorithm);
-  m_Dilate->SetParabolicAlgorithm(m_ParabolicAlgorithm);
+  progress->RegisterInternalFilter(m_Erode, 1.0f);
 
   this->AllocateOutputs();
   // figure out the maximum value of distance transform using the
@@ -75,6 +63,31 @@ MorphologicalSignedDistanceTransformImageFilter<TInputImage, TOutputImage>::Gene
   typename TOutputImage::SizeType    sz = this->GetOutput()->GetRequestedRegion().GetSize();
   typename TOutputImage::SpacingType sp = this->GetOutput()->GetSpacing();
 
+  // the signed passes only have the intersection algorithms. Squared
+  // distances are whole numbers when the spacing is integral, so the
+  // exact integer version can be used.
+  int algorithm = m_ParabolicAlgorithm;
+  if (algorithm != INTEGERINTERSECTION)
+  {
+    algorithm = INTERSECTION;
+    bool integral = true;
+    if (this->GetUseImageSpacing())
+    {
+      for (unsigned k = 0; k < TOutputImage::ImageDimension; k++)
+      {
+        if (sp[k] != std::floor(sp[k]))
+        {
+          integral = false;
+        }
+      }
+    }
+    if (integral)
+    {
+      algorithm = INTEGERINTERSECTION;
+    }
+  }
+  m_Erode->SetParabolicAlgorithm(algorithm);
+
   double MaxDist = 0.0;
   if (this->GetUseImageSpacing())
   {
@@ -93,35 +106,20 @@ MorphologicalSignedDistanceTransformImageFilter<TInputImage, TOutputImage>::Gene
     }
   }
 
-  m_Thresh->SetLowerThreshold(m_OutsideValue);
-  m_Thresh->SetUpperThreshold(m_OutsideValue);
-  if (this->GetInsideIsPositive())
-  {
-    m_Thresh->SetOutsideValue(MaxDist);
-    m_Thresh->SetInsideValue(-MaxDist);
-  }
-  else
-  {
-    m_Thresh->SetOutsideValue(-MaxDist);
-    m_Thresh->SetInsideValue(MaxDist);
-  }
+  // pixels with OutsideValue start at +MaxDist or -MaxDist, and the
+  // others at the opposite value. The erosion leaves the positive
+  // side with the squared distances to the negative one and vice
+  // versa, and writes their signed square roots.
+  const double outsideStart = this->GetInsideIsPositive() ? -MaxDist : MaxDist;
+  m_Erode->SetLowerInputThreshold(m_OutsideValue);
+  m_Erode->SetUpperInputThreshold(m_OutsideValue);
+  m_Erode->SetInputInsideValue(outsideStart);
+  m_Erode->SetInputOutsideValue(-outsideStart);
 
-  m_Thresh->SetInput(this->GetInput());
-  m_Erode->SetInput(m_Thresh->GetOutput());
-  m_Dilate->SetInput(m_Thresh->GetOutput());
-#if 1
-  m_Helper->SetInput(m_Erode->GetOutput());
-  m_Helper->SetInput2(m_Dilate->GetOutput());
-  m_Helper->SetInput3(m_Thresh->GetOutput());
-  m_Helper->SetVal(MaxDist);
-  m_Helper->GraftOutput(this->GetOutput());
-  m_Helper->Update();
-  this->GraftOutput(m_Helper->GetOutput());
-#else
-  m_Dilate->GraftOutput(this->GetOutput());
-  m_Dilate->Update();
-  this->GraftOutput(m_Dilate->GetOutput());
-#endif
+  m_Erode->SetInput(this->GetInput());
+  m_Erode->GraftOutput(this->GetOutput());
+  m_Erode->Update();
+  this->GraftOutput(m_Erode->GetOutput());
 }
 
 template <typename TInputImage, typename TOutputImage>
@@ -0,0 +1,160 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicAutoTuneCache_h
+#define itkParabolicAutoTuneCache_h
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+namespace itk
+{
+/**
+ * \class ParabolicAutoTuneCache
+ * \brief Remembers which line algorithm was fastest for a given
+ * kind of line.
+ *
+ * Used by the AUTOTUNE algorithm choice of the parabolic filters. The
+ * keys describe the pixel type, scale, line length and direction,
+ * the values are the algorithm that won the timing comparison.
+ *
+ * Results are kept in memory for the life of the process. So that
+ * later runs start already tuned, they can also be kept in a small
+ * text file, given with SetFileName or by the environment variable
+ * ITK_PARABOLIC_AUTOTUNE_FILE. Its results are then loaded and new
+ * ones are appended to it. Nothing is written unless a file is
+ * given.
+ *
+ * \ingroup ParabolicMorphology
+ *
+ * \author Richard Beare, Department of Medicine, Monash University,
+ * Australia.  <Richard.Beare@monash.edu>
+ *
+ **/
+class ParabolicAutoTuneCache
+{
+public:
+  /** The cached algorithm for key, or -1 if there isn't one */
+  static int
+  Find(const std::string & key)
+  {
+    Cache &                     cache = GetCache();
+    std::lock_guard<std::mutex> lock(cache.m_Mutex);
+    auto                        it = cache.m_Entries.find(key);
+    return (it == cache.m_Entries.end()) ? -1 : it->second;
+  }
+
+  /** Record the algorithm for key. The first result for a key is kept. */
+  static void
+  Insert(const std::string & key, int algorithm)
+  {
+    Cache &                     cache = GetCache();
+    std::lock_guard<std::mutex> lock(cache.m_Mutex);
+    if (!cache.m_Entries.emplace(key, algorithm).second)
+    {
+      return;
+    }
+    if (!cache.m_FileName.empty())
+    {
+      std::ofstream out(cache.m_FileName.c_str(), std::ios::app);
+      if (out)
+      {
+        out << key << " " << algorithm << "\n";
+      }
+    }
+  }
+
+  /** Forget all results held in memory. The file isn't changed. */
+  static void
+  Clear()
+  {
+    Cache &                     cache = GetCache();
+    std::lock_guard<std::mutex> lock(cache.m_Mutex);
+    cache.m_Entries.clear();
+  }
+
+  /** Keep the results in a file as well, loading the ones it already
+   * holds. An empty name keeps them in memory only. */
+  static void
+  SetFileName(const std::string & fileName)
+  {
+    Cache &                     cache = GetCache();
+    std::lock_guard<std::mutex> lock(cache.m_Mutex);
+    cache.Load(fileName);
+  }
+
+  static std::string
+  GetFileName()
+  {
+    Cache &                     cache = GetCache();
+    std::lock_guard<std::mutex> lock(cache.m_Mutex);
+    return cache.m_FileName;
+  }
+
+private:
+  struct Cache
+  {
+    Cache()
+    {
+      const char * name = std::getenv("ITK_PARABOLIC_AUTOTUNE_FILE");
+      if (name != nullptr)
+      {
+        this->Load(name);
+      }
+    }
+
+    void
+    Load(const std::string & fileName)
+    {
+      m_FileName = fileName;
+      if (m_FileName.empty())
+      {
+        return;
+      }
+      std::ifstream in(m_FileName.c_str());
+      std::string   line;
+      while (std::getline(in, line))
+      {
+        std::istringstream entry(line);
+        std::string        key;
+        int                algorithm;
+        if (entry >> key >> algorithm)
+        {
+          m_Entries.emplace(key, algorithm);
+        }
+      }
+    }
+
+    std::mutex                 m_Mutex;
+    std::map<std::string, int> m_Entries;
+    std::string                m_FileName;
+  };
+
+  static Cache &
+  GetCache()
+  {
+    static Cache cache;
+    return cache;
+  }
+};
+} // namespace itk
+
+#endif
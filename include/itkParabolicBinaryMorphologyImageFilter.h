@@ -0,0 +1,185 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicBinaryMorphologyImageFilter_h
+#define itkParabolicBinaryMorphologyImageFilter_h
+
+#include <cmath>
+#include <cstdint>
+
+#include "itkImageToImageFilter.h"
+
+namespace itk
+{
+/**
+ * \class ParabolicBinaryMorphologyImageFilter
+ * \brief Binary erosion or dilation by a circle/sphere using integer
+ * squared distances.
+ *
+ * A binary dilation by a circle/sphere thresholds the squared
+ * distance to the foreground, an erosion the squared distance to the
+ * background. Squared distances of voxels on a grid with whole
+ * number squared spacings are whole numbers, so they are computed
+ * exactly by an integer parabolic erosion. Squared distances at or
+ * beyond the threshold all give the same result, so the erosion is
+ * band limited to them and the passes store the narrowest unsigned
+ * integer type that holds the band - 8, 16 or 32 bits, chosen from
+ * the scale on every update. The mask is mapped to the starting
+ * distances as the first pass reads it and thresholded as the last
+ * pass writes the output, so no other full size image is used.
+ *
+ * The scale has the meaning of the parabolic filters: the result is
+ * the same as dilating (eroding) the 0/1 mask with
+ * ParabolicDilateImageFilter (ParabolicErodeImageFilter) at that
+ * scale and keeping the voxels above 0 (at or above 1), but exact.
+ * Use SupportsScale to check that the integer distances apply.
+ *
+ * This is used by the binary filters, such as
+ * BinaryDilateParaImageFilter, when the radius and spacing allow it.
+ *
+ * Also note that the inputs must be 0/1 not 0/max for pixel type.
+ *
+ * \sa BinaryDilateParaImageFilter BinaryErodeParaImageFilter
+ *
+ * \ingroup ParabolicMorphology
+ *
+ * \author Richard Beare, Department of Medicine, Monash University,
+ * Australia.  <Richard.Beare@monash.edu>
+ **/
+template <typename TInputImage, bool doDilate, typename TOutputImage = TInputImage>
+class ITK_TEMPLATE_EXPORT ParabolicBinaryMorphologyImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(ParabolicBinaryMorphologyImageFilter);
+
+  /** Standard class type alias. */
+  using Self = ParabolicBinaryMorphologyImageFilter;
+  using Superclass = ImageToImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(ParabolicBinaryMorphologyImageFilter, ImageToImageFilter);
+
+  /** Pixel Type of the input image */
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using PixelType = typename TInputImage::PixelType;
+  using OutputPixelType = typename TOutputImage::PixelType;
+  using SpacingType = typename TInputImage::SpacingType;
+  using SizeType = typename TInputImage::SizeType;
+
+  /** Image dimension. */
+  static constexpr unsigned int ImageDimension = TInputImage::ImageDimension;
+
+  /** Set/Get the scale of the parabolic structuring function, the
+   * same in all dimensions - default is 1 */
+  itkSetMacro(Scale, double);
+  itkGetConstReferenceMacro(Scale, double);
+
+  /**
+   * Set/Get whether the scale refers to pixels or world units -
+   * default is false
+   */
+  itkSetMacro(UseImageSpacing, bool);
+  itkGetConstReferenceMacro(UseImageSpacing, bool);
+  itkBooleanMacro(UseImageSpacing);
+
+  /** Set/Get a virtual border of BorderValue pixels that the output
+   * grows into, or a crop that it shrinks by, without a padded or
+   * cropped copy. See ParabolicErodeDilateImageFilter. Default is
+   * neither. */
+  itkSetMacro(Border, SizeType);
+  itkGetConstReferenceMacro(Border, SizeType);
+  itkSetMacro(BorderValue, PixelType);
+  itkGetConstReferenceMacro(BorderValue, PixelType);
+  itkSetMacro(Crop, SizeType);
+  itkGetConstReferenceMacro(Crop, SizeType);
+
+  /** Size in bytes of the pixels the passes of the last update
+   * stored - 1, 2 or 4. */
+  itkGetConstReferenceMacro(WorkPixelSize, unsigned int);
+
+  /** Fraction of the lines of the last update skipped because they
+   * were constant. See ParabolicErodeDilateImageFilter. */
+  itkGetConstReferenceMacro(SkippedLineFraction, double);
+
+  /** Whether the integer distances give the result of the floating
+   * point filters for these per dimension scales: the scales must all
+   * be the same and positive, and with UseImageSpacing on the squared
+   * spacings whole numbers. */
+  template <typename TScale>
+  static bool
+  SupportsScale(const TScale & scale, const SpacingType & spacing, bool useImageSpacing)
+  {
+    for (unsigned int d = 0; d < ImageDimension; d++)
+    {
+      const double weight = useImageSpacing ? spacing[d] * spacing[d] : 1.0;
+      if (scale[d] <= 0 || scale[d] != scale[0] || weight != std::floor(weight))
+      {
+        return false;
+      }
+    }
+    return 2.0 * scale[0] <= static_cast<double>(NumericTraits<uint32_t>::max());
+  }
+
+protected:
+  ParabolicBinaryMorphologyImageFilter();
+  ~ParabolicBinaryMorphologyImageFilter() override = default;
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** The output is larger or smaller than the input with a border or
+   * crop */
+  void
+  GenerateOutputInformation() override;
+
+  /** This filter needs all of the input */
+  void
+  GenerateInputRequestedRegion() override;
+
+  /** The whole output is produced */
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  void
+  GenerateData() override;
+
+  /** Band limited erosion storing TWorkPixel between the passes */
+  template <typename TWorkPixel>
+  void
+  GenerateDataWithWorkType(double band);
+
+private:
+  double       m_Scale;
+  bool         m_UseImageSpacing;
+  SizeType     m_Border;
+  PixelType    m_BorderValue;
+  SizeType     m_Crop;
+  unsigned int m_WorkPixelSize;
+  double       m_SkippedLineFraction;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkParabolicBinaryMorphologyImageFilter.hxx"
+#endif
+
+#endif
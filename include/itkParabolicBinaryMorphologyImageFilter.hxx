@@ -0,0 +1,185 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicBinaryMorphologyImageFilter_hxx
+#define itkParabolicBinaryMorphologyImageFilter_hxx
+
+#include "itkProgressAccumulator.h"
+#include "itkParabolicErodeImageFilter.h"
+#include "itkParabolicMorphUtils.h"
+
+namespace itk
+{
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+ParabolicBinaryMorphologyImageFilter<TInputImage, doDilate, TOutputImage>::ParabolicBinaryMorphologyImageFilter()
+{
+  this->SetNumberOfRequiredOutputs(1);
+  this->SetNumberOfRequiredInputs(1);
+  m_Scale = 1;
+  m_UseImageSpacing = false;
+  m_Border.Fill(0);
+  m_BorderValue = NumericTraits<PixelType>::ZeroValue();
+  m_Crop.Fill(0);
+  m_WorkPixelSize = 0;
+  m_SkippedLineFraction = 0;
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicBinaryMorphologyImageFilter<TInputImage, doDilate, TOutputImage>::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  const InputImageType * input = this->GetInput();
+  OutputImageType *      output = this->GetOutput();
+  if (input && output)
+  {
+    output->SetLargestPossibleRegion(
+      ParabolicBorderRegion(input->GetLargestPossibleRegion(), m_Border, m_Crop, 0, ImageDimension));
+  }
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicBinaryMorphologyImageFilter<TInputImage, doDilate, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  auto * input = const_cast<InputImageType *>(this->GetInput());
+  if (input)
+  {
+    input->SetRequestedRegionToLargestPossibleRegion();
+  }
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicBinaryMorphologyImageFilter<TInputImage, doDilate, TOutputImage>::EnlargeOutputRequestedRegion(
+  DataObject * output)
+{
+  auto * out = dynamic_cast<OutputImageType *>(output);
+  if (out)
+  {
+    out->SetRequestedRegion(out->GetLargestPossibleRegion());
+  }
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicBinaryMorphologyImageFilter<TInputImage, doDilate, TOutputImage>::GenerateData()
+{
+  // a voxel is in the dilation if its squared distance to the
+  // foreground is below twice the scale, and in the erosion if its
+  // squared distance to the background isn't. Distances are whole
+  // numbers, so everything from the first whole number at or above
+  // twice the scale can be clamped to it.
+  const double band = std::max(std::ceil(2.0 * m_Scale), 1.0);
+  if (band <= static_cast<double>(NumericTraits<uint8_t>::max()))
+  {
+    this->GenerateDataWithWorkType<uint8_t>(band);
+  }
+  else if (band <= static_cast<double>(NumericTraits<uint16_t>::max()))
+  {
+    this->GenerateDataWithWorkType<uint16_t>(band);
+  }
+  else if (band <= static_cast<double>(NumericTraits<uint32_t>::max()))
+  {
+    this->GenerateDataWithWorkType<uint32_t>(band);
+  }
+  else
+  {
+    itkExceptionMacro("Scale " << m_Scale << " is too large for 32 bit squared distances");
+  }
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+template <typename TWorkPixel>
+void
+ParabolicBinaryMorphologyImageFilter<TInputImage, doDilate, TOutputImage>::GenerateDataWithWorkType(double band)
+{
+  using WorkImageType = Image<TWorkPixel, ImageDimension>;
+  using ErodeType = ParabolicErodeImageFilter<TInputImage, TOutputImage, WorkImageType>;
+
+  typename ErodeType::Pointer erode = ErodeType::New();
+
+  ProgressAccumulator::Pointer progress = ProgressAccumulator::New();
+  progress->SetMiniPipelineFilter(this);
+  progress->RegisterInternalFilter(erode, 1.0f);
+
+  // unit parabola weights, or the squared spacing, give squared
+  // distances
+  erode->SetScale(0.5);
+  erode->SetUseImageSpacing(m_UseImageSpacing);
+  erode->SetParabolicAlgorithm(ErodeType::INTEGERINTERSECTION);
+  erode->SetUseClampValue(true);
+  erode->SetClampValue(band);
+
+  // the distances are measured from the foreground for a dilation and
+  // from the background for an erosion
+  const auto top = static_cast<TWorkPixel>(band);
+  erode->SetUseInputThreshold(true);
+  if (doDilate)
+  {
+    erode->SetLowerInputThreshold(1);
+  }
+  else
+  {
+    erode->SetUpperInputThreshold(0);
+  }
+  erode->SetInputInsideValue(0);
+  erode->SetInputOutsideValue(top);
+  erode->SetBorder(m_Border);
+  erode->SetBorderValue(m_BorderValue);
+  erode->SetCrop(m_Crop);
+
+  erode->SetUseOutputThreshold(true);
+  erode->SetLowerOutputThreshold(doDilate ? 0 : top);
+  erode->SetUpperOutputThreshold(doDilate ? static_cast<TWorkPixel>(top - 1) : top);
+  erode->SetOutputInsideValue(1);
+  erode->SetOutputOutsideValue(0);
+
+  erode->SetInput(this->GetInput());
+  erode->GraftOutput(this->GetOutput());
+  erode->Update();
+  this->GraftOutput(erode->GetOutput());
+
+  m_WorkPixelSize = sizeof(TWorkPixel);
+  m_SkippedLineFraction = erode->GetSkippedLineFraction();
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicBinaryMorphologyImageFilter<TInputImage, doDilate, TOutputImage>::PrintSelf(std::ostream & os,
+                                                                                     Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  if (m_UseImageSpacing)
+  {
+    os << indent << "Scale in world units: " << m_Scale << std::endl;
+  }
+  else
+  {
+    os << indent << "Scale in voxels: " << m_Scale << std::endl;
+  }
+  os << indent << "Border: " << m_Border << std::endl;
+  os << indent << "BorderValue: " << static_cast<double>(m_BorderValue) << std::endl;
+  os << indent << "Crop: " << m_Crop << std::endl;
+  os << indent << "WorkPixelSize: " << m_WorkPixelSize << std::endl;
+  os << indent << "SkippedLineFraction: " << m_SkippedLineFraction << std::endl;
+}
+} // namespace itk
+#endif
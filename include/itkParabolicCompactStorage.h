@@ -0,0 +1,214 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicCompactStorage_h
+#define itkParabolicCompactStorage_h
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace itk
+{
+// IEEE half precision conversions, rounding to nearest even
+inline uint16_t
+ParabolicFloatToHalf(float value)
+{
+  uint32_t x;
+  std::memcpy(&x, &value, sizeof(x));
+  const uint32_t sign = (x >> 16) & 0x8000;
+  x &= 0x7FFFFFFF;
+  if (x >= 0x47800000)
+  {
+    // beyond the half range, infinity or nan
+    return static_cast<uint16_t>(sign | ((x > 0x7F800000) ? 0x7E00 : 0x7C00));
+  }
+  if (x < 0x38800000)
+  {
+    // subnormal half
+    if (x < 0x33000000)
+    {
+      return static_cast<uint16_t>(sign);
+    }
+    const uint32_t shift = 126 - (x >> 23);
+    const uint32_t mantissa = (x & 0x7FFFFF) | 0x800000;
+    uint32_t       h = mantissa >> shift;
+    const uint32_t rest = mantissa & ((1u << shift) - 1);
+    const uint32_t halfway = 1u << (shift - 1);
+    if (rest > halfway || (rest == halfway && (h & 1)))
+    {
+      ++h;
+    }
+    return static_cast<uint16_t>(sign | h);
+  }
+  // rebias the exponent, a carry out of the mantissa rounds up to
+  // the next exponent or to infinity
+  uint32_t       h = (x - 0x38000000) >> 13;
+  const uint32_t rest = x & 0x1FFF;
+  if (rest > 0x1000 || (rest == 0x1000 && (h & 1)))
+  {
+    ++h;
+  }
+  return static_cast<uint16_t>(sign | h);
+}
+
+inline float
+ParabolicHalfToFloat(uint16_t h)
+{
+  const uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+  const uint32_t exponent = (h >> 10) & 0x1F;
+  const uint32_t mantissa = h & 0x3FF;
+  uint32_t       x;
+  if (exponent == 0)
+  {
+    const float value = std::ldexp(static_cast<float>(mantissa), -24);
+    return sign ? -value : value;
+  }
+  if (exponent == 31)
+  {
+    x = sign | 0x7F800000 | (mantissa << 13);
+  }
+  else
+  {
+    x = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  }
+  float value;
+  std::memcpy(&value, &x, sizeof(value));
+  return value;
+}
+
+// bfloat16 is the upper half of a float
+inline uint16_t
+ParabolicFloatToBFloat16(float value)
+{
+  uint32_t x;
+  std::memcpy(&x, &value, sizeof(x));
+  if ((x & 0x7FFFFFFF) > 0x7F800000)
+  {
+    return static_cast<uint16_t>((x >> 16) | 0x40);
+  }
+  x += 0x7FFF + ((x >> 16) & 1);
+  return static_cast<uint16_t>(x >> 16);
+}
+
+inline float
+ParabolicBFloat16ToFloat(uint16_t b)
+{
+  const uint32_t x = static_cast<uint32_t>(b) << 16;
+  float          value;
+  std::memcpy(&value, &x, sizeof(value));
+  return value;
+}
+
+/**
+ * \class ParabolicCompactCodec
+ * \brief Stores line values in 16 bits.
+ *
+ * A codec for ParabolicLineAccessor, used for intermediate images
+ * between the passes of the separable filters. Values are stored as
+ * IEEE half floats, bfloat16 or as fixed point values spanning
+ * [minimum, maximum].
+ *
+ * \ingroup ParabolicMorphology
+ *
+ * \author Richard Beare, Department of Medicine, Monash University,
+ * Australia.  <Richard.Beare@monash.edu>
+ *
+ **/
+class ParabolicCompactCodec
+{
+public:
+  using StorageType = uint16_t;
+
+  enum Format
+  {
+    HALFFLOAT = 1, // IEEE half, 11 significant bits
+    BFLOAT16 = 2,  // 8 significant bits, float range
+    FIXED16 = 3    // 65536 levels between minimum and maximum
+  };
+
+  ParabolicCompactCodec() = default;
+
+  ParabolicCompactCodec(int format, double minimum, double maximum)
+    : m_Format(format)
+    , m_Offset(minimum)
+    , m_MaxAbs(std::max(std::abs(minimum), std::abs(maximum)))
+  {
+    m_Step = (maximum > minimum) ? (maximum - minimum) / 65535.0 : 1.0;
+    m_InverseStep = 1.0 / m_Step;
+  }
+
+  template <typename TReal>
+  TReal
+  Decode(const StorageType & stored) const
+  {
+    switch (m_Format)
+    {
+      case FIXED16:
+        return static_cast<TReal>(m_Offset + m_Step * stored);
+      case HALFFLOAT:
+        return static_cast<TReal>(ParabolicHalfToFloat(stored));
+      default:
+        return static_cast<TReal>(ParabolicBFloat16ToFloat(stored));
+    }
+  }
+
+  template <typename TPixel, typename TReal>
+  StorageType
+  Encode(const TReal & value) const
+  {
+    switch (m_Format)
+    {
+      case FIXED16:
+      {
+        const double level = std::nearbyint((static_cast<double>(value) - m_Offset) * m_InverseStep);
+        return static_cast<StorageType>(std::min(std::max(level, 0.0), 65535.0));
+      }
+      case HALFFLOAT:
+        return ParabolicFloatToHalf(static_cast<float>(value));
+      default:
+        return ParabolicFloatToBFloat16(static_cast<float>(value));
+    }
+  }
+
+  /** Largest error of storing and reloading a value in [minimum,
+   * maximum]. Conversion of doubles to float first is included. */
+  double
+  GetStoreError() const
+  {
+    switch (m_Format)
+    {
+      case FIXED16:
+        return 0.5 * m_Step;
+      case HALFFLOAT:
+        return std::max(m_MaxAbs * (std::ldexp(1.0, -11) + std::ldexp(1.0, -24)), std::ldexp(1.0, -25));
+      default:
+        return m_MaxAbs * (std::ldexp(1.0, -8) + std::ldexp(1.0, -24));
+    }
+  }
+
+private:
+  int    m_Format{ BFLOAT16 };
+  double m_Offset{ 0.0 };
+  double m_Step{ 1.0 };
+  double m_InverseStep{ 1.0 };
+  double m_MaxAbs{ 0.0 };
+};
+} // namespace itk
+
+#endif
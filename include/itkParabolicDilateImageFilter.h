@@ -45,16 +45,16 @@ namespace itk
  *
  **/
 
-template <typename TInputImage, typename TOutputImage = TInputImage>
+template <typename TInputImage, typename TOutputImage = TInputImage, typename TWorkImage = TOutputImage>
 class ITK_TEMPLATE_EXPORT ParabolicDilateImageFilter
-  : public ParabolicErodeDilateImageFilter<TInputImage, true, TOutputImage>
+  : public ParabolicErodeDilateImageFilter<TInputImage, true, TOutputImage, TWorkImage>
 {
 public:
   ITK_DISALLOW_COPY_AND_MOVE(ParabolicDilateImageFilter);
 
   /** Standard class type alias. */
   using Self = ParabolicDilateImageFilter;
-  using Superclass = ParabolicErodeDilateImageFilter<TInputImage, true, TOutputImage>;
+  using Superclass = ParabolicErodeDilateImageFilter<TInputImage, true, TOutputImage, TWorkImage>;
   using Pointer = SmartPointer<Self>;
   using ConstPointer = SmartPointer<const Self>;
 
@@ -18,12 +18,19 @@
 #ifndef itkParabolicErodeDilateImageFilter_h
 #define itkParabolicErodeDilateImageFilter_h
 
+#include <atomic>
+
 #include "itkImageToImageFilter.h"
 #include "itkNumericTraits.h"
 #include "itkProgressReporter.h"
+#include "itkParabolicMorphologyEnums.h"
+#include "itkParabolicCompactStorage.h"
 
 namespace itk
 {
+template <typename TInputImage, typename TOutputImage>
+class MorphologicalRunLengthDistanceTransformImageFilter;
+
 /**
  * \class ParabolicErodeDilateImageFilter
  * \brief Parent class for morphological operations with parabolic
@@ -49,12 +56,21 @@ namespace itk
  * image sharpening and distance transform computation.
  *
  * This class uses an internal buffer of RealType pixels for each
- * line. This line is cast to the output pixel type when written back
+ * line, or InternalRealType pixels if KernelPrecision is
+ * FLOATPRECISION. This line is cast to the output pixel type when written back
  * to the output image. Since the filter uses dimensional
  * decomposition this approach could result in inaccuracy as pixels
  * are cast back and forth between low and high precision types. Use a
  * high precision output type and cast manually if this is a problem.
  *
+ * TWorkImage is the type that the passes before the last one store
+ * their results in. By default it is the output type, and the passes
+ * work in place in the output. A different type needs an extra
+ * image, but allows, for example, a float result to be thresholded
+ * into a byte output as it is written by the last pass (see
+ * UseOutputThreshold), without a float output image and a separate
+ * thresholding filter.
+ *
  * Boomgaard, R. van den and Dorst, L. and Makram-Ebeid, L.S. and
  * Schavemaker, J. Quadratic structuring functions in mathematical
  * morphology. Mathematical Morphology and its Applications to Image
@@ -79,8 +95,13 @@ namespace itk
  *
  **/
 
-template <typename TInputImage, bool doDilate, typename TOutputImage = TInputImage>
-class ITK_TEMPLATE_EXPORT ParabolicErodeDilateImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
+template <typename TInputImage,
+          bool doDilate,
+          typename TOutputImage = TInputImage,
+          typename TWorkImage = TOutputImage>
+class ITK_TEMPLATE_EXPORT ParabolicErodeDilateImageFilter
+  : public ImageToImageFilter<TInputImage, TOutputImage>
+  , public ParabolicMorphologyEnums
 {
 public:
   ITK_DISALLOW_COPY_AND_MOVE(ParabolicErodeDilateImageFilter);
@@ -113,6 +134,9 @@ public:
 
   using OutputIndexType = typename OutputImageType::IndexType;
 
+  using WorkImageType = TWorkImage;
+  using WorkPixelType = typename TWorkImage::PixelType;
+
   /** a type to represent the "kernel radius" */
   using RadiusType = typename itk::FixedArray<ScalarRealType, TInputImage::ImageDimension>;
 
@@ -137,21 +161,222 @@ public:
   itkSetMacro(Scale, RadiusType);
   itkGetConstReferenceMacro(Scale, RadiusType);
 
-  enum ParabolicAlgorithm
-  {
-    NOCHOICE = 0,     // decices based on scale - experimental
-    CONTACTPOINT = 1, // sometimes faster at low scale
-    INTERSECTION = 2  // default
-  };
   /**
    * Set/Get the method used. Choices are contact point or
    * intersection. Intersection is the default. Contact point can be
-   * faster at small scales.
+   * faster at small scales. AUTOTUNE times both on a sample of the
+   * lines and uses the faster, remembering the result (see
+   * ParabolicAutoTuneCache).
    */
 
   itkSetMacro(ParabolicAlgorithm, int);
   itkGetConstReferenceMacro(ParabolicAlgorithm, int);
 
+  /**
+   * Set/Get the way lines are transferred between the image and the
+   * line buffers. Passes along dimensions other than 0 stride through
+   * memory. The tiled mode gathers groups of neighbouring lines
+   * together so that memory is read in contiguous runs. Default is
+   * STRIDEDLINES.
+   */
+  itkSetMacro(ExecutionMode, int);
+  itkGetConstReferenceMacro(ExecutionMode, int);
+
+  using ExecutionStrategyType = FixedArray<int, ImageDimension>;
+  /** The line transfer used for each dimension by the last update,
+   * either STRIDEDLINES or TILEDLINES */
+  itkGetConstReferenceMacro(ExecutionStrategy, ExecutionStrategyType);
+
+  /**
+   * Set/Get the precision of the line buffers. FLOATPRECISION uses
+   * InternalRealType (float for integer pixels), which halves the
+   * scratch memory and doubles the SIMD width. It is also the only
+   * way to get the multi-line SIMD kernels of the INTERSECTION
+   * algorithm, which work on float lines only. The precision is never
+   * lowered automatically, as float rounds the parabola values even
+   * for 8 bit input. Default is DOUBLEPRECISION.
+   */
+  itkSetMacro(KernelPrecision, int);
+  itkGetConstReferenceMacro(KernelPrecision, int);
+
+  /**
+   * Set/Get precision validation. When on, and KernelPrecision is
+   * FLOATPRECISION, the output is also computed with DOUBLEPRECISION
+   * and the largest absolute difference between the two is reported
+   * by GetMaximumPrecisionError. The float result is the output.
+   * Doubles the run time. Default is off.
+   */
+  itkSetMacro(ValidatePrecision, bool);
+  itkGetConstReferenceMacro(ValidatePrecision, bool);
+  itkBooleanMacro(ValidatePrecision);
+
+  /** Largest difference from the double precision output found by
+   * the last update with ValidatePrecision on */
+  itkGetConstReferenceMacro(MaximumPrecisionError, double);
+
+  enum IntermediateStorage
+  {
+    FULLSTORAGE = 0,      // passes store WorkPixelType - default
+    HALFFLOATSTORAGE = 1, // IEEE half floats
+    BFLOAT16STORAGE = 2,  // bfloat16
+    FIXED16STORAGE = 3    // 16 bit fixed point over the input range
+  };
+  /**
+   * Set/Get the storage used between passes. All passes but the last
+   * write to a 16 bit intermediate image instead of the output, which
+   * reduces the memory traffic of the later passes. Only used for
+   * WorkPixelType, by default the output pixel type, wider than 16
+   * bits. The values stored are assumed to lie within the thresholded
+   * values with UseInputThreshold, InputMinimum and InputMaximum with
+   * UseInputRange, or otherwise the range of PixelType, so floating
+   * point input needs UseInputRange for FIXED16STORAGE and
+   * HALFFLOATSTORAGE, which requires a range within +/-65504. Default
+   * is FULLSTORAGE.
+   */
+  itkSetMacro(IntermediateStorage, int);
+  itkGetConstReferenceMacro(IntermediateStorage, int);
+
+  /** Bound on the error introduced by the intermediate storage in the
+   * last update. Erosions and dilations stay within the input range
+   * and never increase differences, so this is the error of one store
+   * times the number of stored passes. */
+  itkGetConstReferenceMacro(IntermediateErrorBound, double);
+
+  /**
+   * Set/Get a limit on the output - erosions are clamped to at most
+   * ClampValue and dilations to at least ClampValue. Input values
+   * beyond it can only produce output beyond it, so their parabolas
+   * are skipped and lines entirely beyond it are not processed. Only
+   * used when UseClampValue is on, default is off. For
+   * INTEGERINTERSECTION the value should be a whole number.
+   */
+  itkSetMacro(ClampValue, RealType);
+  itkGetConstReferenceMacro(ClampValue, RealType);
+  itkSetMacro(UseClampValue, bool);
+  itkGetConstReferenceMacro(UseClampValue, bool);
+  itkBooleanMacro(UseClampValue);
+
+  /**
+   * Set/Get a threshold applied as the last pass writes the
+   * output. Values, as stored in WorkPixelType, between the lower and
+   * upper thresholds inclusive become OutputInsideValue and the
+   * others OutputOutsideValue, like BinaryThresholdImageFilter. Only
+   * used when UseOutputThreshold is on, default is off.
+   */
+  itkSetMacro(UseOutputThreshold, bool);
+  itkGetConstReferenceMacro(UseOutputThreshold, bool);
+  itkBooleanMacro(UseOutputThreshold);
+  itkSetMacro(LowerOutputThreshold, WorkPixelType);
+  itkGetConstReferenceMacro(LowerOutputThreshold, WorkPixelType);
+  itkSetMacro(UpperOutputThreshold, WorkPixelType);
+  itkGetConstReferenceMacro(UpperOutputThreshold, WorkPixelType);
+  itkSetMacro(OutputInsideValue, OutputPixelType);
+  itkGetConstReferenceMacro(OutputInsideValue, OutputPixelType);
+  itkSetMacro(OutputOutsideValue, OutputPixelType);
+  itkGetConstReferenceMacro(OutputOutsideValue, OutputPixelType);
+
+  /**
+   * Set/Get whether the last pass writes the square root of its
+   * result, as stored in WorkPixelType, for example to turn squared
+   * distances into distances without a separate filter. Ignored when
+   * UseOutputThreshold is on. Default is off.
+   */
+  itkSetMacro(OutputSquareRoot, bool);
+  itkGetConstReferenceMacro(OutputSquareRoot, bool);
+  itkBooleanMacro(OutputSquareRoot);
+
+  /**
+   * Set/Get whether the values are signed squared distances, for
+   * erosions. Positive values are squared distances from one phase to
+   * the other and negative values are negated squared distances from
+   * the other phase to the first. Each line is eroded as two
+   * envelopes, one per sign, with the values of the other sign taken
+   * as zero, and every pixel keeps the envelope of its own sign. With
+   * input values of +/-MaxDist this computes both sides of a signed
+   * distance transform in one set of passes. Uses the intersection
+   * algorithms. ComputeFeatures is ignored. Default is off.
+   */
+  itkSetMacro(SignedDistances, bool);
+  itkGetConstReferenceMacro(SignedDistances, bool);
+  itkBooleanMacro(SignedDistances);
+
+  /**
+   * Set/Get a threshold applied as the first pass reads the
+   * input. Input pixels between the lower and upper thresholds
+   * inclusive are read as InputInsideValue and the others as
+   * InputOutsideValue, so a mask can be turned into the starting
+   * values of the passes without a separate image. The thresholded
+   * values needn't fit PixelType, so the intersection algorithm is
+   * used instead of the contact point one. Only used when
+   * UseInputThreshold is on, default is off.
+   */
+  itkSetMacro(UseInputThreshold, bool);
+  itkGetConstReferenceMacro(UseInputThreshold, bool);
+  itkBooleanMacro(UseInputThreshold);
+  itkSetMacro(LowerInputThreshold, PixelType);
+  itkGetConstReferenceMacro(LowerInputThreshold, PixelType);
+  itkSetMacro(UpperInputThreshold, PixelType);
+  itkGetConstReferenceMacro(UpperInputThreshold, PixelType);
+  itkSetMacro(InputInsideValue, WorkPixelType);
+  itkGetConstReferenceMacro(InputInsideValue, WorkPixelType);
+  itkSetMacro(InputOutsideValue, WorkPixelType);
+  itkGetConstReferenceMacro(InputOutsideValue, WorkPixelType);
+
+  /**
+   * Set/Get a known range of the input values. An output pixel then
+   * only depends on the input within ParabolicSupportRadius of it, so
+   * just that part of the input is requested and the output requested
+   * region isn't enlarged, which allows streaming. The passes run
+   * over that part of the input and the last one writes just the
+   * requested region. With line buffers of float, from float pixels
+   * or FLOATPRECISION, the result only matches that of the whole image
+   * to within rounding, as the lines start elsewhere. With
+   * UseInputThreshold the range is that of the thresholded values
+   * instead. Ignored when ComputeFeatures is on, as the features are
+   * offsets in the whole output. Default is off, when the whole input
+   * is requested and the whole output is produced.
+   */
+  itkSetMacro(UseInputRange, bool);
+  itkGetConstReferenceMacro(UseInputRange, bool);
+  itkBooleanMacro(UseInputRange);
+  itkSetMacro(InputMinimum, PixelType);
+  itkGetConstReferenceMacro(InputMinimum, PixelType);
+  itkSetMacro(InputMaximum, PixelType);
+  itkGetConstReferenceMacro(InputMaximum, PixelType);
+
+  /**
+   * Set/Get the size of a virtual border, in pixels, on each side of
+   * each dimension. The output is then larger than the input by the
+   * border, and the same as padding the input with BorderValue and
+   * filtering, but the border is never stored on its own: each pass
+   * extends its lines by it in the line buffers and grows the region
+   * into it. BorderValue goes through the input threshold, if there
+   * is one. Default is no border.
+   */
+  itkSetMacro(Border, InputSizeType);
+  itkGetConstReferenceMacro(Border, InputSizeType);
+
+  /** Set/Get the value of the virtual border pixels. */
+  itkSetMacro(BorderValue, PixelType);
+  itkGetConstReferenceMacro(BorderValue, PixelType);
+
+  /**
+   * Set/Get the number of pixels cropped from each side of each
+   * dimension. The output is then smaller than the input, and the
+   * same as filtering and cropping, but each pass only writes the
+   * part of its lines that is kept, so there is no cropped copy.
+   * Border and Crop need the whole input, so UseInputRange is ignored
+   * with either, and they can't be combined with each other,
+   * ComputeFeatures or SignedDistances. Default is no crop.
+   */
+  itkSetMacro(Crop, InputSizeType);
+  itkGetConstReferenceMacro(Crop, InputSizeType);
+
+  /** Fraction of the lines of the last update that were constant.
+   * Erosions and dilations don't change constant lines, so they are
+   * skipped. Binary masks typically have many. */
+  itkGetConstReferenceMacro(SkippedLineFraction, double);
+
   /**
    * Set/Get whether the scale refers to pixels or world units -
    * default is false
@@ -161,6 +386,26 @@ public:
   itkBooleanMacro(UseImageSpacing);
   /** Image related type alias. */
 
+  using FeatureImageType = Image<OffsetValueType, ImageDimension>;
+  /**
+   * Set/Get whether to compute the feature image. For every output
+   * pixel it holds the buffer offset of the input pixel whose
+   * parabola produced the output value (see Image::ComputeIndex). In
+   * a distance transform this is the nearest background pixel. The
+   * intersection algorithms are used, and IntermediateStorage is
+   * ignored. Default is off.
+   */
+  itkSetMacro(ComputeFeatures, bool);
+  itkGetConstReferenceMacro(ComputeFeatures, bool);
+  itkBooleanMacro(ComputeFeatures);
+
+  /** The feature image computed by the last update */
+  FeatureImageType *
+  GetFeatureImage()
+  {
+    return m_FeatureImage.GetPointer();
+  }
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro(SameDimension,
@@ -187,20 +432,130 @@ protected:
   void
   ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId) override;
 
+  // the output is larger or smaller than the input with a border or
+  // crop
+  void
+  GenerateOutputInformation() override;
+
   void
   GenerateInputRequestedRegion() override;
 
-  // Override since the filter produces the entire dataset.
+  // Override since the filter produces the entire dataset, unless
+  // the input range is known
   void
   EnlargeOutputRequestedRegion(DataObject * output) override;
 
+  // the input region needed for an output region
+  OutputImageRegionType
+  ComputeInputRegion(const OutputImageRegionType & region) const;
+
   bool m_UseImageSpacing;
   int  m_ParabolicAlgorithm;
+  int  m_ExecutionMode;
+  int  m_KernelPrecision;
+  bool m_ValidatePrecision;
+  int  m_IntermediateStorage;
+  bool m_ComputeFeatures;
+  bool m_UseClampValue;
+  bool m_UseOutputThreshold;
+  bool m_UseInputThreshold;
+  bool m_OutputSquareRoot;
+  bool m_SignedDistances;
+  bool m_UseInputRange;
+
+  RealType        m_ClampValue;
+  WorkPixelType   m_LowerOutputThreshold;
+  WorkPixelType   m_UpperOutputThreshold;
+  OutputPixelType m_OutputInsideValue;
+  OutputPixelType m_OutputOutsideValue;
+  PixelType       m_LowerInputThreshold;
+  PixelType       m_UpperInputThreshold;
+  WorkPixelType   m_InputInsideValue;
+  WorkPixelType   m_InputOutsideValue;
+  PixelType       m_InputMinimum;
+  PixelType       m_InputMaximum;
+  InputSizeType   m_Border;
+  PixelType       m_BorderValue;
+  InputSizeType   m_Crop;
+
+  ExecutionStrategyType m_ExecutionStrategy;
+  double                m_MaximumPrecisionError;
+  double                m_IntermediateErrorBound;
+  double                m_SkippedLineFraction;
 
 private:
+  using IntermediateImageType = Image<ParabolicCompactCodec::StorageType, ImageDimension>;
+
+  // copy the lines of the current dimension
+  template <typename TInIter, typename TOutIter>
+  void
+  CopyLines(TInIter & inputIterator, TOutIter & outputIterator, const OutputImageRegionType & region);
+
+  // the pass of the current dimension. The first pass reads the
+  // input, the last one writes the output and the others stay in the
+  // work image. inPlace is set when the work image is the output.
+  template <typename TInIter, typename TWorkConstIter, typename TWorkIter, typename TOutIter>
+  void
+  ProcessPass(TInIter &                     inputIterator,
+              TWorkConstIter &              workInputIterator,
+              TWorkIter &                   workIterator,
+              TOutIter &                    outputIterator,
+              ProgressReporter &            progress,
+              const OutputImageRegionType & region,
+              bool                          inPlace);
+
+  // doOneDimension for the current dimension, with line buffers of
+  // the current precision
+  template <typename TInIter, typename TOutIter>
+  void
+  ProcessDimension(TInIter &                     inputIterator,
+                   TOutIter &                    outputIterator,
+                   ProgressReporter &            progress,
+                   const OutputImageRegionType & region);
+
+  // the run length distance transform hands over an image of its own
+  // and lets the passes run in its buffer
+  template <typename, typename>
+  friend class MorphologicalRunLengthDistanceTransformImageFilter;
+
+  // hands the input buffer to the output, when the types allow it
+  template <typename TImage>
+  static bool
+  ShareBuffer(const TImage * input, TImage * output);
+  template <typename TInImage, typename TOutImage>
+  static bool
+  ShareBuffer(const TInImage * input, TOutImage * output);
+
   RadiusType m_Scale;
 
-  int m_CurrentDimension;
+  // whether Border or Crop is set
+  bool
+  UsesBorder() const;
+
+  // the region the passes run over, which holds the output buffer
+  OutputImageRegionType m_ProcessRegion;
+
+  // the lines of the current pass. Without a border or crop they are
+  // those of the region processed, otherwise those of the input with
+  // the border added or the crop removed along the dimensions already
+  // processed.
+  OutputImageRegionType m_PassRegion;
+
+  // the border pixels as they are read by the first pass
+  RealType m_BorderWorkValue;
+
+  int  m_CurrentDimension;
+  int  m_CurrentPrecision;
+  bool m_InPlace;
+  bool m_ReuseInput;
+
+  typename IntermediateImageType::Pointer m_Intermediate;
+  typename WorkImageType::Pointer         m_Work;
+  ParabolicCompactCodec                   m_Codec;
+  typename FeatureImageType::Pointer      m_FeatureImage;
+
+  // constant lines found by the threads
+  std::atomic<size_t> m_SkippedLines{ 0 };
 };
 } // end namespace itk
 
@@ -18,36 +18,64 @@
 #ifndef itkParabolicErodeDilateImageFilter_hxx
 #define itkParabolicErodeDilateImageFilter_hxx
 
-#include "itkImageRegionConstIterator.h"
+#include <numeric>
+#include <type_traits>
+
 #include "itkImageRegionIterator.h"
 
-//#define NOINDEX
-#ifndef NOINDEX
-#  include "itkImageLinearIteratorWithIndex.h"
-#  include "itkImageLinearConstIteratorWithIndex.h"
-#else
-#  include "itkImageLinearIterator.h"
-#  include "itkImageLinearConstIterator.h"
-#endif
+#include "itkParabolicLineAccessor.h"
 #include "itkParabolicMorphUtils.h"
 
 namespace itk
 {
-template <typename TInputImage, bool doDilate, typename TOutputImage>
-ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::ParabolicErodeDilateImageFilter()
+template <typename TInputImage, bool doDilate, typename TOutputImage, typename TWorkImage>
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage, TWorkImage>::ParabolicErodeDilateImageFilter()
 {
   this->SetNumberOfRequiredOutputs(1);
   this->SetNumberOfRequiredInputs(1);
 
   m_UseImageSpacing = false;
   m_ParabolicAlgorithm = INTERSECTION;
+  m_ExecutionMode = STRIDEDLINES;
+  m_ExecutionStrategy.Fill(STRIDEDLINES);
+  m_KernelPrecision = DOUBLEPRECISION;
+  m_CurrentPrecision = DOUBLEPRECISION;
+  m_ValidatePrecision = false;
+  m_InPlace = false;
+  m_ReuseInput = false;
+  m_MaximumPrecisionError = 0;
+  m_IntermediateStorage = FULLSTORAGE;
+  m_IntermediateErrorBound = 0;
+  m_ComputeFeatures = false;
+  m_UseClampValue = false;
+  m_SkippedLineFraction = 0;
+  m_ClampValue = ParabolicNoClamp<doDilate, RealType>();
+  m_UseOutputThreshold = false;
+  m_LowerOutputThreshold = NumericTraits<WorkPixelType>::NonpositiveMin();
+  m_UpperOutputThreshold = NumericTraits<WorkPixelType>::max();
+  m_OutputInsideValue = NumericTraits<OutputPixelType>::max();
+  m_OutputOutsideValue = NumericTraits<OutputPixelType>::ZeroValue();
+  m_UseInputThreshold = false;
+  m_OutputSquareRoot = false;
+  m_SignedDistances = false;
+  m_LowerInputThreshold = NumericTraits<PixelType>::NonpositiveMin();
+  m_UpperInputThreshold = NumericTraits<PixelType>::max();
+  m_InputInsideValue = NumericTraits<WorkPixelType>::max();
+  m_InputOutsideValue = NumericTraits<WorkPixelType>::ZeroValue();
+  m_UseInputRange = false;
+  m_InputMinimum = NumericTraits<PixelType>::NonpositiveMin();
+  m_InputMaximum = NumericTraits<PixelType>::max();
+  m_Border.Fill(0);
+  m_BorderValue = NumericTraits<PixelType>::ZeroValue();
+  m_Crop.Fill(0);
+  m_BorderWorkValue = 0;
 
   this->DynamicMultiThreadingOff();
 }
 
-template <typename TInputImage, bool doDilate, typename TOutputImage>
+template <typename TInputImage, bool doDilate, typename TOutputImage, typename TWorkImage>
 unsigned int
-ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::SplitRequestedRegion(
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage, TWorkImage>::SplitRequestedRegion(
   unsigned int            i,
   unsigned int            num,
   OutputImageRegionType & splitRegion)
@@ -55,8 +83,8 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::SplitReque
   // Get the output pointer
   OutputImageType * outputPtr = this->GetOutput();
 
-  // Initialize the splitRegion to the output requested region
-  splitRegion = outputPtr->GetRequestedRegion();
+  // Initialize the splitRegion to the lines of the current pass
+  splitRegion = m_PassRegion;
 
   const OutputSizeType & requestedRegionSize = splitRegion.GetSize();
 
@@ -104,9 +132,9 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::SplitReque
   return maxThreadIdUsed + 1;
 }
 
-template <typename TInputImage, bool doDilate, typename TOutputImage>
+template <typename TInputImage, bool doDilate, typename TOutputImage, typename TWorkImage>
 void
-ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::SetScale(ScalarRealType scale)
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage, TWorkImage>::SetScale(ScalarRealType scale)
 {
   RadiusType s;
 
@@ -114,32 +142,78 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::SetScale(S
   this->SetScale(s);
 }
 
+template <typename TInputImage, bool doDilate, typename TOutputImage, typename TWorkImage>
+bool
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage, TWorkImage>::UsesBorder() const
+{
+  for (unsigned int d = 0; d < ImageDimension; d++)
+  {
+    if (m_Border[d] > 0 || m_Crop[d] > 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage, typename TWorkImage>
+void
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage, TWorkImage>::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  const InputImageType * input = this->GetInput();
+  OutputImageType *      output = this->GetOutput();
+  if (!input || !output || !this->UsesBorder())
+  {
+    return;
+  }
+  const OutputImageRegionType & largest = input->GetLargestPossibleRegion();
+  bool                          grow = false;
+  bool                          shrink = false;
+  for (unsigned int d = 0; d < ImageDimension; d++)
+  {
+    grow = grow || m_Border[d] > 0;
+    shrink = shrink || m_Crop[d] > 0;
+    if (2 * m_Crop[d] >= largest.GetSize(d))
+    {
+      itkExceptionMacro("Crop " << m_Crop << " leaves nothing of " << largest.GetSize());
+    }
+  }
+  if (grow && shrink)
+  {
+    itkExceptionMacro("Border and Crop can't both be set");
+  }
+  output->SetLargestPossibleRegion(ParabolicBorderRegion(largest, m_Border, m_Crop, 0, ImageDimension));
+}
+
 #if 1
-template <typename TInputImage, bool doDilate, typename TOutputImage>
+template <typename TInputImage, bool doDilate, typename TOutputImage, typename TWorkImage>
 void
-ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::GenerateInputRequestedRegion()
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage, TWorkImage>::GenerateInputRequestedRegion()
 {
   // call the superclass' implementation of this method. this should
   // copy the output requested region to the input requested region
   Superclass::GenerateInputRequestedRegion();
 
-  // This filter needs all of the input
+  // This filter needs all of the input, unless its range is known
   InputImagePointer image = const_cast<InputImageType *>(this->GetInput());
   if (image)
   {
-    image->SetRequestedRegion(this->GetInput()->GetLargestPossibleRegion());
+    image->SetRequestedRegion(this->ComputeInputRegion(this->GetOutput()->GetRequestedRegion()));
   }
 }
 
 #endif
 #if 1
-template <typename TInputImage, bool doDilate, typename TOutputImage>
+template <typename TInputImage, bool doDilate, typename TOutputImage, typename TWorkImage>
 void
-ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::EnlargeOutputRequestedRegion(DataObject * output)
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage, TWorkImage>::EnlargeOutputRequestedRegion(
+  DataObject * output)
 {
   auto * out = dynamic_cast<TOutputImage *>(output);
 
-  if (out)
+  if (out && (!m_UseInputRange || m_ComputeFeatures || this->UsesBorder()))
   {
     out->SetRequestedRegion(out->GetLargestPossibleRegion());
   }
@@ -147,18 +221,80 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::EnlargeOut
 
 #endif
 
-template <typename TInputImage, bool doDilate, typename TOutputImage>
+template <typename TInputImage, bool doDilate, typename TOutputImage, typename TWorkImage>
+typename ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage, TWorkImage>::OutputImageRegionType
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage, TWorkImage>::ComputeInputRegion(
+  const OutputImageRegionType & region) const
+{
+  const InputImageType * input = this->GetInput();
+  if (!m_UseInputRange || m_ComputeFeatures || this->UsesBorder())
+  {
+    return input->GetLargestPossibleRegion();
+  }
+
+  // the output region grown by the support of the parabolas
+  double range = static_cast<double>(m_InputMaximum) - static_cast<double>(m_InputMinimum);
+  if (m_UseInputThreshold)
+  {
+    range = std::abs(static_cast<double>(m_InputInsideValue) - static_cast<double>(m_InputOutsideValue));
+  }
+  OutputImageRegionType inputRegion = region;
+  inputRegion.PadByRadius(
+    ParabolicSupportRadius<OutputSizeType>(m_Scale, input->GetSpacing(), m_UseImageSpacing, std::max(range, 0.0)));
+  inputRegion.Crop(input->GetLargestPossibleRegion());
+  return inputRegion;
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage, typename TWorkImage>
 void
-ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::GenerateData()
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage, TWorkImage>::GenerateData()
 {
   ThreadIdType nbthreads = this->GetNumberOfWorkUnits();
 
   typename TInputImage::ConstPointer inputImage(this->GetInput());
   typename TOutputImage::Pointer     outputImage(this->GetOutput());
 
-  // const unsigned int imageDimension = inputImage->GetImageDimension();
-  outputImage->SetBufferedRegion(outputImage->GetRequestedRegion());
-  outputImage->Allocate();
+  // with a known input range the passes run over the input region,
+  // which holds the requested region and the input it depends on.
+  // Only the requested region is exact, so the output buffer holds
+  // just that and the last pass writes the part of its lines inside
+  // it. A crop is the same, with the whole input, and a border grows
+  // the region processed to the output.
+  const OutputImageRegionType & requestedRegion = outputImage->GetRequestedRegion();
+  const bool                    border = this->UsesBorder();
+  if (border && (m_ComputeFeatures || m_SignedDistances))
+  {
+    itkExceptionMacro("Border and Crop can't be used with ComputeFeatures or SignedDistances");
+  }
+  if (border)
+  {
+    bool grow = false;
+    for (unsigned int d = 0; d < ImageDimension; d++)
+    {
+      grow = grow || m_Border[d] > 0;
+    }
+    m_ProcessRegion = grow ? requestedRegion : inputImage->GetLargestPossibleRegion();
+  }
+  else
+  {
+    m_ProcessRegion = m_UseInputRange ? this->ComputeInputRegion(requestedRegion) : requestedRegion;
+  }
+  const OutputImageRegionType & processRegion = m_ProcessRegion;
+  const bool                    cropped = processRegion != requestedRegion;
+  outputImage->SetBufferedRegion(requestedRegion);
+
+  // precision validation runs the passes twice, so needs the input
+  // to stay as it is
+  const bool validate = m_ValidatePrecision && (m_KernelPrecision == FLOATPRECISION);
+  m_ReuseInput = false;
+  if (m_InPlace && !validate && !cropped && inputImage->GetBufferedRegion() == processRegion)
+  {
+    m_ReuseInput = ShareBuffer(inputImage.GetPointer(), outputImage.GetPointer());
+  }
+  if (!m_ReuseInput)
+  {
+    outputImage->Allocate();
+  }
 
   // Set up the multithreaded processing
   typename ImageSource<OutputImageType>::ThreadStruct str;
@@ -168,23 +304,415 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::GenerateDa
   multithreader->SetNumberOfWorkUnits(nbthreads);
   multithreader->SetSingleMethod(this->ThreaderCallback, &str);
 
-  // multithread the execution
+  // choose how lines are transferred for each dimension. Tiles are
+  // made from neighbouring lines along dimension 0, so passes along
+  // dimension 0 always read lines in place.
+  const OutputSizeType & regionSize = processRegion.GetSize();
+  for (unsigned int d = 0; d < ImageDimension; d++)
+  {
+    const bool tiled = (d > 0) && ((m_ExecutionMode == TILEDLINES) ||
+                                   (m_ExecutionMode == AUTOLINES && regionSize[0] >= ParabolicTileLines / 2));
+    m_ExecutionStrategy[d] = tiled ? TILEDLINES : STRIDEDLINES;
+  }
+
+  // the border pixels read by the first pass, which the passes keep
+  // as they are, apart from the clamp
+  m_BorderWorkValue = static_cast<RealType>(m_BorderValue);
+  if (m_UseInputThreshold)
+  {
+    const ParabolicThresholdCodec<PixelType> codec(
+      m_LowerInputThreshold, m_UpperInputThreshold, m_InputInsideValue, m_InputOutsideValue);
+    m_BorderWorkValue = codec.template Decode<RealType>(m_BorderValue);
+  }
+  if (m_UseClampValue)
+  {
+    m_BorderWorkValue = ParabolicClamp<doDilate, RealType>(m_BorderWorkValue, m_ClampValue);
+  }
+
+  // compact storage between the passes, for pixel types where it
+  // saves memory traffic
+  m_IntermediateErrorBound = 0;
+  if (m_IntermediateStorage != FULLSTORAGE && ImageDimension > 1 && !m_ComputeFeatures &&
+      sizeof(WorkPixelType) > sizeof(ParabolicCompactCodec::StorageType))
+  {
+    // the stored values stay within the input range, so take a known
+    // one rather than scanning the input. Without one, that of
+    // PixelType is only useful for integer pixels.
+    double minimum = NumericTraits<PixelType>::NonpositiveMin();
+    double maximum = NumericTraits<PixelType>::max();
+    if (m_UseInputThreshold)
+    {
+      minimum = std::min<double>(m_InputInsideValue, m_InputOutsideValue);
+      maximum = std::max<double>(m_InputInsideValue, m_InputOutsideValue);
+    }
+    else if (m_UseInputRange)
+    {
+      minimum = m_InputMinimum;
+      maximum = m_InputMaximum;
+    }
+    else if (m_IntermediateStorage == FIXED16STORAGE && !NumericTraits<PixelType>::is_integer)
+    {
+      itkExceptionMacro("FIXED16STORAGE of floating point input needs UseInputRange");
+    }
+    if (border)
+    {
+      minimum = std::min(minimum, static_cast<double>(m_BorderWorkValue));
+      maximum = std::max(maximum, static_cast<double>(m_BorderWorkValue));
+    }
+    if (m_IntermediateStorage == HALFFLOATSTORAGE && std::max(std::abs(minimum), std::abs(maximum)) > 65504.0)
+    {
+      itkExceptionMacro("Input range [" << minimum << ", " << maximum << "] exceeds half float storage");
+    }
+    m_Codec = ParabolicCompactCodec(m_IntermediateStorage, minimum, maximum);
+    m_IntermediateErrorBound = (ImageDimension - 1) * m_Codec.GetStoreError();
+
+    m_Intermediate = IntermediateImageType::New();
+    m_Intermediate->SetRegions(processRegion);
+    m_Intermediate->Allocate();
+  }
+
+  // a separate work image, unless the passes can stay in the output
+  m_Work = nullptr;
+  if ((!std::is_same<WorkImageType, OutputImageType>::value || cropped) && ImageDimension > 1 && !m_Intermediate)
+  {
+    m_Work = WorkImageType::New();
+    m_Work->SetRegions(processRegion);
+    m_Work->Allocate();
+  }
+
+  const size_t numberOfPixels = processRegion.GetNumberOfPixels();
+  m_FeatureImage = nullptr;
+  if (m_ComputeFeatures && !(m_SignedDistances && !doDilate))
+  {
+    m_FeatureImage = FeatureImageType::New();
+    m_FeatureImage->CopyInformation(outputImage);
+    m_FeatureImage->SetRequestedRegion(outputImage->GetRequestedRegion());
+    m_FeatureImage->SetBufferedRegion(outputImage->GetBufferedRegion());
+    m_FeatureImage->Allocate();
+  }
+
+  // the lines of the pass along dimension d
+  auto setPassRegion = [&](unsigned int d) {
+    m_PassRegion = processRegion;
+    if (border)
+    {
+      m_PassRegion = ParabolicBorderRegion(inputImage->GetLargestPossibleRegion(), m_Border, m_Crop, 0, d);
+    }
+  };
+
+  // lines of all the passes
+  size_t totalLines = 0;
   for (unsigned int d = 0; d < ImageDimension; d++)
   {
-    m_CurrentDimension = d;
-    multithreader->SingleMethodExecute();
+    setPassRegion(d);
+    if (m_Scale[d] > 0 && m_PassRegion.GetSize(d) > 0)
+    {
+      totalLines += m_PassRegion.GetNumberOfPixels() / m_PassRegion.GetSize(d);
+    }
+  }
+
+  // multithread the execution
+  auto runDimensions = [&]() {
+    m_SkippedLines = 0;
+    if (m_FeatureImage)
+    {
+      // every pixel starts as its own feature
+      OffsetValueType * features = m_FeatureImage->GetBufferPointer();
+      std::iota(features, features + numberOfPixels, OffsetValueType{ 0 });
+    }
+    for (unsigned int d = 0; d < ImageDimension; d++)
+    {
+      m_CurrentDimension = d;
+      setPassRegion(d);
+      multithreader->SingleMethodExecute();
+    }
+  };
+
+  m_MaximumPrecisionError = 0;
+  const size_t                 numberOfOutputPixels = requestedRegion.GetNumberOfPixels();
+  std::vector<OutputPixelType> reference;
+  if (validate)
+  {
+    m_CurrentPrecision = DOUBLEPRECISION;
+    runDimensions();
+    reference.assign(outputImage->GetBufferPointer(), outputImage->GetBufferPointer() + numberOfOutputPixels);
+  }
+
+  m_CurrentPrecision = m_KernelPrecision;
+  runDimensions();
+
+  if (validate)
+  {
+    const OutputPixelType * out = outputImage->GetBufferPointer();
+    for (size_t i = 0; i < numberOfOutputPixels; i++)
+    {
+      const double diff = std::abs(static_cast<double>(out[i]) - static_cast<double>(reference[i]));
+      m_MaximumPrecisionError = std::max(m_MaximumPrecisionError, diff);
+    }
+  }
+  m_SkippedLineFraction = (totalLines > 0) ? static_cast<double>(m_SkippedLines) / totalLines : 0.0;
+  m_Intermediate = nullptr;
+  m_Work = nullptr;
+  m_ReuseInput = false;
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage, typename TWorkImage>
+template <typename TImage>
+bool
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage, TWorkImage>::ShareBuffer(const TImage * input,
+                                                                                            TImage *       output)
+{
+  output->SetPixelContainer(const_cast<TImage *>(input)->GetPixelContainer());
+  return true;
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage, typename TWorkImage>
+template <typename TInImage, typename TOutImage>
+bool
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage, TWorkImage>::ShareBuffer(const TInImage *,
+                                                                                            TOutImage *)
+{
+  return false;
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage, typename TWorkImage>
+template <typename TInIter, typename TOutIter>
+void
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage, TWorkImage>::CopyLines(
+  TInIter &                     inputIterator,
+  TOutIter &                    outputIterator,
+  const OutputImageRegionType & region)
+{
+  std::vector<RealType> line(region.GetSize()[m_CurrentDimension]);
+  inputIterator.SetDirection(m_CurrentDimension);
+  outputIterator.SetDirection(m_CurrentDimension);
+  while (!inputIterator.IsAtEnd())
+  {
+    inputIterator.GetLine(line.data());
+    outputIterator.SetLine(line.data());
+    inputIterator.NextLine();
+    outputIterator.NextLine();
   }
 }
 
-template <typename TInputImage, bool doDilate, typename TOutputImage>
+template <typename TInputImage, bool doDilate, typename TOutputImage, typename TWorkImage>
+template <typename TInIter, typename TOutIter>
 void
-ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::ThreadedGenerateData(
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage, TWorkImage>::ProcessDimension(
+  TInIter &                     inputIterator,
+  TOutIter &                    outputIterator,
+  ProgressReporter &            progress,
+  const OutputImageRegionType & region)
+{
+  const unsigned int  d = m_CurrentDimension;
+  const unsigned long LineLength = region.GetSize()[d];
+  const double        image_scale = this->GetInput()->GetSpacing()[d];
+  const bool          tiled = m_ExecutionStrategy[d] == TILEDLINES;
+
+  // the contact point search starts from the extremes of PixelType,
+  // which thresholded input values may lie beyond
+  int algorithm = m_ParabolicAlgorithm;
+  if (m_UseInputThreshold && algorithm != INTEGERINTERSECTION)
+  {
+    algorithm = INTERSECTION;
+  }
+
+  if (m_SignedDistances && !doDilate)
+  {
+    if (m_CurrentPrecision == FLOATPRECISION)
+    {
+      m_SkippedLines += doOneDimensionSigned<TInIter, TOutIter, InternalRealType>(
+        inputIterator,
+        outputIterator,
+        progress,
+        LineLength,
+        d,
+        this->m_UseImageSpacing,
+        static_cast<InternalRealType>(image_scale),
+        static_cast<InternalRealType>(this->m_Scale[d]),
+        algorithm,
+        tiled);
+    }
+    else
+    {
+      m_SkippedLines += doOneDimensionSigned<TInIter, TOutIter, RealType>(inputIterator,
+                                                                         outputIterator,
+                                                                         progress,
+                                                                         LineLength,
+                                                                         d,
+                                                                         this->m_UseImageSpacing,
+                                                                         static_cast<RealType>(image_scale),
+                                                                         static_cast<RealType>(this->m_Scale[d]),
+                                                                         algorithm,
+                                                                         tiled);
+    }
+    return;
+  }
+
+  if (m_FeatureImage)
+  {
+    // the features are updated in place, like the output
+    using FeatureOutIterType = ParabolicLineAccessor<FeatureImageType>;
+    using FeatureInIterType = ParabolicLineAccessor<const FeatureImageType>;
+
+    FeatureInIterType  featureInputIterator(m_FeatureImage.GetPointer(), region);
+    FeatureOutIterType featureOutputIterator(m_FeatureImage.GetPointer(), region);
+    if (m_CurrentPrecision == FLOATPRECISION)
+    {
+      m_SkippedLines +=
+        doOneDimensionFeature<TInIter, TOutIter, FeatureInIterType, FeatureOutIterType, InternalRealType, doDilate>(
+          inputIterator,
+          outputIterator,
+          featureInputIterator,
+          featureOutputIterator,
+          progress,
+          LineLength,
+          d,
+          this->m_UseImageSpacing,
+          static_cast<InternalRealType>(image_scale),
+          static_cast<InternalRealType>(this->m_Scale[d]),
+          algorithm,
+          tiled);
+    }
+    else
+    {
+      m_SkippedLines +=
+        doOneDimensionFeature<TInIter, TOutIter, FeatureInIterType, FeatureOutIterType, RealType, doDilate>(
+          inputIterator,
+          outputIterator,
+          featureInputIterator,
+          featureOutputIterator,
+          progress,
+          LineLength,
+          d,
+          this->m_UseImageSpacing,
+          static_cast<RealType>(image_scale),
+          static_cast<RealType>(this->m_Scale[d]),
+          algorithm,
+          tiled);
+    }
+    return;
+  }
+
+  if (this->UsesBorder())
+  {
+    // the lines are extended by the border as they are read, or
+    // written from the end of the crop. The border pixels stay as the
+    // first pass reads them, stored as the work pixels after it.
+    const long     border = static_cast<long>(m_Border[d]);
+    const long     outputStart = static_cast<long>(m_Crop[d]);
+    const RealType borderValue =
+      (d == 0) ? m_BorderWorkValue : static_cast<RealType>(static_cast<WorkPixelType>(m_BorderWorkValue));
+    if (m_CurrentPrecision == FLOATPRECISION)
+    {
+      doOneDimensionBorder<TInIter, TOutIter, InternalRealType, PixelType, OutputPixelType, doDilate, false>(
+        inputIterator,
+        outputIterator,
+        progress,
+        LineLength,
+        d,
+        this->m_UseImageSpacing,
+        static_cast<InternalRealType>(image_scale),
+        static_cast<InternalRealType>(this->m_Scale[d]),
+        algorithm,
+        border,
+        border,
+        static_cast<InternalRealType>(borderValue),
+        outputStart,
+        tiled,
+        m_UseClampValue ? static_cast<InternalRealType>(m_ClampValue) : ParabolicNoClamp<doDilate, InternalRealType>());
+    }
+    else
+    {
+      doOneDimensionBorder<TInIter, TOutIter, RealType, PixelType, OutputPixelType, doDilate, false>(
+        inputIterator,
+        outputIterator,
+        progress,
+        LineLength,
+        d,
+        this->m_UseImageSpacing,
+        static_cast<RealType>(image_scale),
+        static_cast<RealType>(this->m_Scale[d]),
+        algorithm,
+        border,
+        border,
+        borderValue,
+        outputStart,
+        tiled,
+        m_UseClampValue ? m_ClampValue : ParabolicNoClamp<doDilate, RealType>());
+    }
+    return;
+  }
+
+  if (m_CurrentPrecision == FLOATPRECISION)
+  {
+    m_SkippedLines += doOneDimension<TInIter, TOutIter, InternalRealType, PixelType, OutputPixelType, doDilate>(
+      inputIterator,
+      outputIterator,
+      progress,
+      LineLength,
+      d,
+      this->m_UseImageSpacing,
+      static_cast<InternalRealType>(image_scale),
+      static_cast<InternalRealType>(this->m_Scale[d]),
+      algorithm,
+      tiled,
+      m_UseClampValue ? static_cast<InternalRealType>(m_ClampValue) : ParabolicNoClamp<doDilate, InternalRealType>());
+  }
+  else
+  {
+    m_SkippedLines += doOneDimension<TInIter, TOutIter, RealType, PixelType, OutputPixelType, doDilate>(
+      inputIterator,
+      outputIterator,
+      progress,
+      LineLength,
+      d,
+      this->m_UseImageSpacing,
+      static_cast<RealType>(image_scale),
+      static_cast<RealType>(this->m_Scale[d]),
+      algorithm,
+      tiled,
+      m_UseClampValue ? m_ClampValue : ParabolicNoClamp<doDilate, RealType>());
+  }
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage, typename TWorkImage>
+void
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage, TWorkImage>::ThreadedGenerateData(
   const OutputImageRegionType & outputRegionForThread,
   ThreadIdType                  threadId)
 {
+  using RegionType = ImageRegion<TInputImage::ImageDimension>;
+
+  typename TInputImage::ConstPointer inputImage(this->GetInput());
+  typename TOutputImage::Pointer     outputImage(this->GetOutput());
+
+  // when the output only holds the requested region, the passes
+  // before the last stay in the work image and don't write it. The
+  // last pass only needs the lines that cross the output, and writes
+  // the part of them inside it.
+  RegionType region = outputRegionForThread;
+  RegionType outputRegion = outputImage->GetBufferedRegion();
+  const bool cropped = outputRegion != m_ProcessRegion;
+  if (cropped && m_CurrentDimension == static_cast<int>(ImageDimension) - 1 &&
+      !ParabolicCropLines(region, outputRegion, m_CurrentDimension))
+  {
+    return;
+  }
+
+  // the lines as they are written, grown into the border or with the
+  // crop removed. Only the first pass reads the input.
+  const RegionType lineRegion =
+    ParabolicBorderRegion(region, m_Border, m_Crop, m_CurrentDimension, m_CurrentDimension + 1);
+  const RegionType inputRegion = (m_CurrentDimension == 0) ? region : inputImage->GetBufferedRegion();
+  if (!cropped)
+  {
+    outputRegion = lineRegion;
+  }
+
   // compute the number of rows first, so we can setup a progress reporter
   typename std::vector<unsigned int> NumberOfRows;
-  InputSizeType                      size = outputRegionForThread.GetSize();
+  InputSizeType                      size = region.GetSize();
 
   for (unsigned int i = 0; i < InputImageDimension; i++)
   {
@@ -206,90 +734,152 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::ThreadedGe
                             m_CurrentDimension * progressPerDimension,
                             progressPerDimension);
 
-  using InputConstIteratorType = ImageLinearConstIteratorWithIndex<TInputImage>;
-  using OutputIteratorType = ImageLinearIteratorWithIndex<TOutputImage>;
+  using InputConstIteratorType = ParabolicLineAccessor<const TInputImage>;
+  using OutputIteratorType = ParabolicCroppedLineAccessor<TOutputImage>;
 
   // for stages after the first
-  using OutputConstIteratorType = ImageLinearConstIteratorWithIndex<TOutputImage>;
+  using OutputConstIteratorType = ParabolicLineAccessor<const TOutputImage>;
 
-  using RegionType = ImageRegion<TInputImage::ImageDimension>;
+  InputConstIteratorType inputIterator(inputImage.GetPointer(), inputRegion);
+  OutputIteratorType     outputIterator(outputImage.GetPointer(), outputRegion, lineRegion);
 
-  typename TInputImage::ConstPointer inputImage(this->GetInput());
-  typename TOutputImage::Pointer     outputImage(this->GetOutput());
+  // the first pass reads the input and the last pass writes the
+  // output, each transformed if requested
+  auto runOutputPass = [&](auto & passInputIterator, auto & workInputIterator, auto & workIterator, bool inPlace) {
+    if (m_UseOutputThreshold)
+    {
+      using ThresholdIteratorType =
+        ParabolicCroppedLineAccessor<TOutputImage, ParabolicThresholdCodec<WorkPixelType>>;
+      ThresholdIteratorType thresholdIterator(
+        outputImage.GetPointer(),
+        outputRegion,
+        lineRegion,
+        ParabolicThresholdCodec<WorkPixelType>(
+          m_LowerOutputThreshold, m_UpperOutputThreshold, m_OutputInsideValue, m_OutputOutsideValue));
+      this->ProcessPass(
+        passInputIterator, workInputIterator, workIterator, thresholdIterator, progress, region, inPlace);
+    }
+    else if (m_OutputSquareRoot)
+    {
+      using SqrtIteratorType = ParabolicCroppedLineAccessor<TOutputImage, ParabolicSqrtCodec<WorkPixelType>>;
+      SqrtIteratorType sqrtIterator(outputImage.GetPointer(), outputRegion, lineRegion);
+      this->ProcessPass(passInputIterator, workInputIterator, workIterator, sqrtIterator, progress, region, inPlace);
+    }
+    else
+    {
+      this->ProcessPass(passInputIterator, workInputIterator, workIterator, outputIterator, progress, region, inPlace);
+    }
+  };
+  auto runPass = [&](auto & workInputIterator, auto & workIterator, bool inPlace) {
+    if (m_UseInputThreshold)
+    {
+      using ThresholdIteratorType = ParabolicLineAccessor<const TInputImage, ParabolicThresholdCodec<PixelType>>;
+      ThresholdIteratorType thresholdIterator(
+        inputImage.GetPointer(),
+        inputRegion,
+        ParabolicThresholdCodec<PixelType>(
+          m_LowerInputThreshold, m_UpperInputThreshold, m_InputInsideValue, m_InputOutsideValue));
+      runOutputPass(thresholdIterator, workInputIterator, workIterator, inPlace);
+    }
+    else
+    {
+      runOutputPass(inputIterator, workInputIterator, workIterator, inPlace);
+    }
+  };
 
-  // outputImage->SetBufferedRegion( outputImage->GetRequestedRegion() );
-  // outputImage->Allocate();
-  RegionType region = outputRegionForThread;
+  if (m_Intermediate)
+  {
+    // passes go through the compact intermediate image, only the last
+    // one writes the output
+    using IntermediateIteratorType = ParabolicLineAccessor<IntermediateImageType, ParabolicCompactCodec>;
+    using IntermediateConstIteratorType = ParabolicLineAccessor<const IntermediateImageType, ParabolicCompactCodec>;
+
+    IntermediateIteratorType      intermediateIterator(m_Intermediate.GetPointer(), lineRegion, m_Codec);
+    IntermediateConstIteratorType intermediateIteratorStage2(m_Intermediate.GetPointer(), region, m_Codec);
+    runPass(intermediateIteratorStage2, intermediateIterator, false);
+  }
+  else if (m_Work)
+  {
+    using WorkIteratorType = ParabolicLineAccessor<WorkImageType>;
+    using WorkConstIteratorType = ParabolicLineAccessor<const WorkImageType>;
 
-  InputConstIteratorType  inputIterator(inputImage, region);
-  OutputIteratorType      outputIterator(outputImage, region);
-  OutputConstIteratorType inputIteratorStage2(outputImage, region);
+    WorkIteratorType      workIterator(m_Work.GetPointer(), lineRegion);
+    WorkConstIteratorType workIteratorStage2(m_Work.GetPointer(), region);
+    runPass(workIteratorStage2, workIterator, false);
+  }
+  else
+  {
+    // the passes after the first work in place in the output
+    OutputConstIteratorType inputIteratorStage2(outputImage.GetPointer(), region);
+    runPass(inputIteratorStage2, outputIterator, true);
+  }
+}
 
-  // deal with the first dimension - this should be copied to the
-  // output if the scale is 0
-  if (m_CurrentDimension == 0)
+template <typename TInputImage, bool doDilate, typename TOutputImage, typename TWorkImage>
+template <typename TInIter, typename TWorkConstIter, typename TWorkIter, typename TOutIter>
+void
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage, TWorkImage>::ProcessPass(
+  TInIter &                     inputIterator,
+  TWorkConstIter &              workInputIterator,
+  TWorkIter &                   workIterator,
+  TOutIter &                    outputIterator,
+  ProgressReporter &            progress,
+  const OutputImageRegionType & region,
+  bool                          inPlace)
+{
+  // a border or crop changes the length of the lines, so then every
+  // pass is processed
+  const bool process = m_Scale[m_CurrentDimension] > 0 || this->UsesBorder();
+  const bool first = m_CurrentDimension == 0;
+  const bool last = m_CurrentDimension == static_cast<int>(ImageDimension) - 1;
+
+  // dimensions with a zero scale are copied where they change image.
+  // An output in the input buffer already holds the input, unless a
+  // threshold changes it on the way.
+  const bool inputInPlace = m_ReuseInput && !m_UseInputThreshold;
+  if (first && last)
   {
-    if (m_Scale[0] > 0)
+    if (process)
     {
-      // Perform as normal
-      // RealType magnitude = 1.0/(2.0 * m_Scale[0]);
-      unsigned long LineLength = region.GetSize()[0];
-      RealType      image_scale = this->GetInput()->GetSpacing()[0];
-
-      doOneDimension<InputConstIteratorType, OutputIteratorType, RealType, PixelType, OutputPixelType, doDilate>(
-        inputIterator,
-        outputIterator,
-        progress,
-        LineLength,
-        0,
-        this->m_UseImageSpacing,
-        image_scale,
-        this->m_Scale[0],
-        m_ParabolicAlgorithm);
+      this->ProcessDimension(inputIterator, outputIterator, progress, region);
     }
-    else
+    else if (!inputInPlace || m_UseOutputThreshold || m_OutputSquareRoot)
     {
-      // copy to output
-      using InItType = ImageRegionConstIterator<TInputImage>;
-      using OutItType = ImageRegionIterator<TOutputImage>;
-
-      InItType  InIt(inputImage, region);
-      OutItType OutIt(outputImage, region);
-      while (!InIt.IsAtEnd())
-      {
-        OutIt.Set(static_cast<OutputPixelType>(InIt.Get()));
-        ++InIt;
-        ++OutIt;
-      }
+      this->CopyLines(inputIterator, outputIterator, region);
     }
   }
-  else
+  else if (first)
   {
-    // other dimensions
-    if (m_Scale[m_CurrentDimension] > 0)
+    if (process)
     {
-      // create a vector to buffer lines
-      unsigned long LineLength = region.GetSize()[m_CurrentDimension];
-      // RealType magnitude = 1.0/(2.0 * m_Scale[dd]);
-      RealType image_scale = this->GetInput()->GetSpacing()[m_CurrentDimension];
-
-      doOneDimension<OutputConstIteratorType, OutputIteratorType, RealType, PixelType, OutputPixelType, doDilate>(
-        inputIteratorStage2,
-        outputIterator,
-        progress,
-        LineLength,
-        m_CurrentDimension,
-        this->m_UseImageSpacing,
-        image_scale,
-        this->m_Scale[m_CurrentDimension],
-        m_ParabolicAlgorithm);
+      this->ProcessDimension(inputIterator, workIterator, progress, region);
     }
+    else if (!inputInPlace || !inPlace)
+    {
+      this->CopyLines(inputIterator, workIterator, region);
+    }
+  }
+  else if (!last)
+  {
+    if (process)
+    {
+      this->ProcessDimension(workInputIterator, workIterator, progress, region);
+    }
+  }
+  else if (process)
+  {
+    this->ProcessDimension(workInputIterator, outputIterator, progress, region);
+  }
+  else if (!inPlace || m_UseOutputThreshold || m_OutputSquareRoot)
+  {
+    this->CopyLines(workInputIterator, outputIterator, region);
   }
 }
 
-template <typename TInputImage, bool doDilate, typename TOutputImage>
+template <typename TInputImage, bool doDilate, typename TOutputImage, typename TWorkImage>
 void
-ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::PrintSelf(std::ostream & os, Indent indent) const
+ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage, TWorkImage>::PrintSelf(std::ostream & os,
+                                                                                          Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
   if (m_UseImageSpacing)
@@ -300,6 +890,35 @@ ParabolicErodeDilateImageFilter<TInputImage, doDilate, TOutputImage>::PrintSelf(
   {
     os << "Scale in voxels: " << m_Scale << std::endl;
   }
+  os << indent << "ExecutionMode: " << m_ExecutionMode << std::endl;
+  os << indent << "ExecutionStrategy: " << m_ExecutionStrategy << std::endl;
+  os << indent << "KernelPrecision: " << m_KernelPrecision << std::endl;
+  os << indent << "ValidatePrecision: " << m_ValidatePrecision << std::endl;
+  os << indent << "MaximumPrecisionError: " << m_MaximumPrecisionError << std::endl;
+  os << indent << "IntermediateStorage: " << m_IntermediateStorage << std::endl;
+  os << indent << "IntermediateErrorBound: " << m_IntermediateErrorBound << std::endl;
+  os << indent << "ComputeFeatures: " << m_ComputeFeatures << std::endl;
+  os << indent << "UseClampValue: " << m_UseClampValue << std::endl;
+  os << indent << "ClampValue: " << m_ClampValue << std::endl;
+  os << indent << "UseOutputThreshold: " << m_UseOutputThreshold << std::endl;
+  os << indent << "LowerOutputThreshold: " << static_cast<double>(m_LowerOutputThreshold) << std::endl;
+  os << indent << "UpperOutputThreshold: " << static_cast<double>(m_UpperOutputThreshold) << std::endl;
+  os << indent << "OutputInsideValue: " << static_cast<double>(m_OutputInsideValue) << std::endl;
+  os << indent << "OutputOutsideValue: " << static_cast<double>(m_OutputOutsideValue) << std::endl;
+  os << indent << "OutputSquareRoot: " << m_OutputSquareRoot << std::endl;
+  os << indent << "SignedDistances: " << m_SignedDistances << std::endl;
+  os << indent << "UseInputThreshold: " << m_UseInputThreshold << std::endl;
+  os << indent << "LowerInputThreshold: " << static_cast<double>(m_LowerInputThreshold) << std::endl;
+  os << indent << "UpperInputThreshold: " << static_cast<double>(m_UpperInputThreshold) << std::endl;
+  os << indent << "InputInsideValue: " << static_cast<double>(m_InputInsideValue) << std::endl;
+  os << indent << "InputOutsideValue: " << static_cast<double>(m_InputOutsideValue) << std::endl;
+  os << indent << "UseInputRange: " << m_UseInputRange << std::endl;
+  os << indent << "InputMinimum: " << static_cast<double>(m_InputMinimum) << std::endl;
+  os << indent << "InputMaximum: " << static_cast<double>(m_InputMaximum) << std::endl;
+  os << indent << "Border: " << m_Border << std::endl;
+  os << indent << "BorderValue: " << static_cast<double>(m_BorderValue) << std::endl;
+  os << indent << "Crop: " << m_Crop << std::endl;
+  os << indent << "SkippedLineFraction: " << m_SkippedLineFraction << std::endl;
 }
 } // namespace itk
 #endif
@@ -0,0 +1,199 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicErodeDilateStackImageFilter_h
+#define itkParabolicErodeDilateStackImageFilter_h
+
+#include <vector>
+
+#include "itkImageToImageFilter.h"
+#include "itkVectorImage.h"
+#include "itkNumericTraits.h"
+#include "itkProgressReporter.h"
+#include "itkParabolicMorphologyEnums.h"
+
+namespace itk
+{
+/**
+ * \class ParabolicErodeDilateStackImageFilter
+ * \brief Parent class for parabolic erosions or dilations at a list
+ * of scales, returned as the components of a VectorImage.
+ *
+ * Parabolic erosions and dilations form a semigroup - the dilation
+ * at scale s1 + s2 is the dilation at scale s1 dilated at scale
+ * s2. The scales are processed in increasing order and each is
+ * computed from the previous one by dilating (or eroding) with the
+ * difference of the scales, so the work per scale doesn't grow with
+ * the scale. All scales share one working image and each pass is a
+ * single thread dispatch. Component k of the output holds the result
+ * for the k'th scale given to SetScales.
+ *
+ * On the sampled grid the composition of two parabolas is not exactly
+ * the parabola of the summed scale, so the incremental results can
+ * differ slightly from a direct computation (by less than 0.1 grey
+ * levels for unit spaced scales of a few pixels). IncrementalOff
+ * computes every scale from the input instead.
+ *
+ * The output pixels are the components of a VectorImage. Use a real
+ * component type to avoid rounding between scales.
+ *
+ * \sa ParabolicErodeDilateImageFilter
+ *
+ * \ingroup ParabolicMorphology
+ *
+ * \author Richard Beare, Department of Medicine, Monash University,
+ * Australia.  <Richard.Beare@monash.edu>
+ *
+ **/
+template <typename TInputImage,
+          bool doDilate,
+          typename TOutputImage = VectorImage<float, TInputImage::ImageDimension>>
+class ITK_TEMPLATE_EXPORT ParabolicErodeDilateStackImageFilter
+  : public ImageToImageFilter<TInputImage, TOutputImage>
+  , public ParabolicMorphologyEnums
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(ParabolicErodeDilateStackImageFilter);
+
+  /** Standard class type alias. */
+  using Self = ParabolicErodeDilateStackImageFilter;
+  using Superclass = ImageToImageFilter<TInputImage, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(ParabolicErodeDilateStackImageFilter, ImageToImageFilter);
+
+  /** Pixel Type of the input image */
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using PixelType = typename TInputImage::PixelType;
+  using RealType = typename NumericTraits<PixelType>::RealType;
+  using ScalarRealType = typename NumericTraits<PixelType>::ScalarRealType;
+  using OutputComponentType = typename TOutputImage::InternalPixelType;
+
+  using InputSizeType = typename TInputImage::SizeType;
+  using OutputSizeType = typename TOutputImage::SizeType;
+  using OutputIndexType = typename OutputImageType::IndexType;
+
+  using ScalesType = std::vector<ScalarRealType>;
+
+  /** Image dimension. */
+  static constexpr unsigned int ImageDimension = TInputImage::ImageDimension;
+  static constexpr unsigned int OutputImageDimension = TOutputImage::ImageDimension;
+  static constexpr unsigned int InputImageDimension = TInputImage::ImageDimension;
+
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+
+  /** Set/Get the scales, one output component per scale */
+  void
+  SetScales(const ScalesType & scales)
+  {
+    if (scales != m_Scales)
+    {
+      m_Scales = scales;
+      this->Modified();
+    }
+  }
+  itkGetConstReferenceMacro(Scales, ScalesType);
+
+  /**
+   * Set/Get whether each scale is computed from the previous one -
+   * default is true
+   */
+  itkSetMacro(Incremental, bool);
+  itkGetConstReferenceMacro(Incremental, bool);
+  itkBooleanMacro(Incremental);
+
+  /**
+   * Set/Get the method used. See ParabolicErodeDilateImageFilter.
+   */
+  itkSetMacro(ParabolicAlgorithm, int);
+  itkGetConstReferenceMacro(ParabolicAlgorithm, int);
+
+  /**
+   * Set/Get whether the scale refers to pixels or world units -
+   * default is false
+   */
+  itkSetMacro(UseImageSpacing, bool);
+  itkGetConstReferenceMacro(UseImageSpacing, bool);
+  itkBooleanMacro(UseImageSpacing);
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  /** Begin concept checking */
+  itkConceptMacro(SameDimension,
+                  (Concept::SameDimension<itkGetStaticConstMacro(InputImageDimension),
+                                          itkGetStaticConstMacro(OutputImageDimension)>));
+
+  itkConceptMacro(Comparable, (Concept::Comparable<PixelType>));
+
+  /** End concept checking */
+#endif
+protected:
+  ParabolicErodeDilateStackImageFilter();
+  ~ParabolicErodeDilateStackImageFilter() override = default;
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  void
+  GenerateOutputInformation() override;
+
+  /** Generate Data */
+  void
+  GenerateData() override;
+
+  unsigned int
+  SplitRequestedRegion(unsigned int i, unsigned int num, OutputImageRegionType & splitRegion) override;
+
+  void
+  ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId) override;
+
+  void
+  GenerateInputRequestedRegion() override;
+
+  // Override since the filter produces the entire dataset.
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  bool m_UseImageSpacing;
+  bool m_Incremental;
+  int  m_ParabolicAlgorithm;
+
+private:
+  // scalar image holding the current scale
+  using WorkImageType = Image<OutputComponentType, ImageDimension>;
+
+  ScalesType m_Scales;
+
+  typename WorkImageType::Pointer m_Work;
+
+  int            m_CurrentDimension;
+  unsigned int   m_CurrentComponent;
+  unsigned int   m_CurrentPass;
+  bool           m_FromInput;
+  ScalarRealType m_Increment;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkParabolicErodeDilateStackImageFilter.hxx"
+#endif
+
+#endif
@@ -0,0 +1,327 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicErodeDilateStackImageFilter_hxx
+#define itkParabolicErodeDilateStackImageFilter_hxx
+
+#include <algorithm>
+#include <numeric>
+
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+
+#include "itkParabolicLineAccessor.h"
+#include "itkParabolicMorphUtils.h"
+
+namespace itk
+{
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+ParabolicErodeDilateStackImageFilter<TInputImage, doDilate, TOutputImage>::ParabolicErodeDilateStackImageFilter()
+{
+  this->SetNumberOfRequiredOutputs(1);
+  this->SetNumberOfRequiredInputs(1);
+
+  m_UseImageSpacing = false;
+  m_Incremental = true;
+  m_ParabolicAlgorithm = INTERSECTION;
+  m_CurrentDimension = 0;
+  m_CurrentComponent = 0;
+  m_CurrentPass = 0;
+  m_FromInput = true;
+  m_Increment = 0;
+
+  this->DynamicMultiThreadingOff();
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+unsigned int
+ParabolicErodeDilateStackImageFilter<TInputImage, doDilate, TOutputImage>::SplitRequestedRegion(
+  unsigned int            i,
+  unsigned int            num,
+  OutputImageRegionType & splitRegion)
+{
+  // Get the output pointer
+  OutputImageType * outputPtr = this->GetOutput();
+
+  // Initialize the splitRegion to the output requested region
+  splitRegion = outputPtr->GetRequestedRegion();
+
+  const OutputSizeType & requestedRegionSize = splitRegion.GetSize();
+
+  OutputIndexType splitIndex = splitRegion.GetIndex();
+  OutputSizeType  splitSize = splitRegion.GetSize();
+
+  // split on the outermost dimension available
+  // and avoid the current dimension
+  int splitAxis = static_cast<int>(outputPtr->GetImageDimension()) - 1;
+  while ((requestedRegionSize[splitAxis] == 1) || (splitAxis == static_cast<int>(m_CurrentDimension)))
+  {
+    --splitAxis;
+    if (splitAxis < 0)
+    { // cannot split
+      itkDebugMacro("Cannot Split");
+      return 1;
+    }
+  }
+
+  // determine the actual number of pieces that will be generated
+  auto range = static_cast<double>(requestedRegionSize[splitAxis]);
+
+  auto         valuesPerThread = static_cast<unsigned int>(std::ceil(range / static_cast<double>(num)));
+  unsigned int maxThreadIdUsed = static_cast<unsigned int>(std::ceil(range / static_cast<double>(valuesPerThread))) - 1;
+
+  // Split the region
+  if (i < maxThreadIdUsed)
+  {
+    splitIndex[splitAxis] += i * valuesPerThread;
+    splitSize[splitAxis] = valuesPerThread;
+  }
+  if (i == maxThreadIdUsed)
+  {
+    splitIndex[splitAxis] += i * valuesPerThread;
+    // last thread needs to process the "rest" dimension being split
+    splitSize[splitAxis] = splitSize[splitAxis] - i * valuesPerThread;
+  }
+
+  // set the split region ivars
+  splitRegion.SetIndex(splitIndex);
+  splitRegion.SetSize(splitSize);
+
+  itkDebugMacro("Split Piece: " << splitRegion);
+
+  return maxThreadIdUsed + 1;
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateStackImageFilter<TInputImage, doDilate, TOutputImage>::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+  this->GetOutput()->SetNumberOfComponentsPerPixel(std::max<unsigned int>(1, m_Scales.size()));
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateStackImageFilter<TInputImage, doDilate, TOutputImage>::GenerateInputRequestedRegion()
+{
+  // call the superclass' implementation of this method. this should
+  // copy the output requested region to the input requested region
+  Superclass::GenerateInputRequestedRegion();
+
+  // This filter needs all of the input
+  auto * image = const_cast<InputImageType *>(this->GetInput());
+  if (image)
+  {
+    image->SetRequestedRegion(this->GetInput()->GetLargestPossibleRegion());
+  }
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateStackImageFilter<TInputImage, doDilate, TOutputImage>::EnlargeOutputRequestedRegion(
+  DataObject * output)
+{
+  auto * out = dynamic_cast<TOutputImage *>(output);
+
+  if (out)
+  {
+    out->SetRequestedRegion(out->GetLargestPossibleRegion());
+  }
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateStackImageFilter<TInputImage, doDilate, TOutputImage>::GenerateData()
+{
+  if (m_Scales.empty())
+  {
+    itkExceptionMacro("No scales set");
+  }
+  for (const auto & s : m_Scales)
+  {
+    if (s < 0)
+    {
+      itkExceptionMacro("Scales must not be negative: " << s);
+    }
+  }
+
+  ThreadIdType nbthreads = this->GetNumberOfWorkUnits();
+
+  typename TOutputImage::Pointer outputImage(this->GetOutput());
+
+  outputImage->SetBufferedRegion(outputImage->GetRequestedRegion());
+  outputImage->Allocate();
+
+  // one working image is shared by all the scales
+  m_Work = WorkImageType::New();
+  m_Work->SetRegions(outputImage->GetRequestedRegion());
+  m_Work->Allocate();
+
+  // Set up the multithreaded processing
+  typename ImageSource<OutputImageType>::ThreadStruct str;
+  str.Filter = this;
+
+  ProcessObject::MultiThreaderType * multithreader = this->GetMultiThreader();
+  multithreader->SetNumberOfWorkUnits(nbthreads);
+  multithreader->SetSingleMethod(this->ThreaderCallback, &str);
+
+  // process the scales in increasing order
+  std::vector<unsigned int> order(m_Scales.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(
+    order.begin(), order.end(), [this](unsigned int a, unsigned int b) { return m_Scales[a] < m_Scales[b]; });
+
+  ScalarRealType previous = 0;
+  m_CurrentPass = 0;
+  for (unsigned int k = 0; k < order.size(); k++)
+  {
+    m_CurrentComponent = order[k];
+    const ScalarRealType scale = m_Scales[m_CurrentComponent];
+    m_FromInput = (k == 0) || !m_Incremental;
+    m_Increment = m_FromInput ? scale : (scale - previous);
+    previous = scale;
+
+    // multithread the execution
+    for (unsigned int d = 0; d < ImageDimension; d++)
+    {
+      m_CurrentDimension = d;
+      multithreader->SingleMethodExecute();
+      ++m_CurrentPass;
+    }
+  }
+
+  m_Work = nullptr;
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateStackImageFilter<TInputImage, doDilate, TOutputImage>::ThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType                  threadId)
+{
+  // compute the number of rows first, so we can setup a progress reporter
+  typename std::vector<unsigned int> NumberOfRows;
+  InputSizeType                      size = outputRegionForThread.GetSize();
+
+  for (unsigned int i = 0; i < InputImageDimension; i++)
+  {
+    NumberOfRows.push_back(1);
+    for (unsigned int d = 0; d < InputImageDimension; d++)
+    {
+      if (d != i)
+      {
+        NumberOfRows[i] *= size[d];
+      }
+    }
+  }
+  float progressPerPass = 1.0 / (ImageDimension * m_Scales.size());
+
+  ProgressReporter progress(
+    this, threadId, NumberOfRows[m_CurrentDimension], 30, m_CurrentPass * progressPerPass, progressPerPass);
+
+  using InputConstIteratorType = ParabolicLineAccessor<const TInputImage>;
+  using WorkIteratorType = ParabolicLineAccessor<WorkImageType>;
+  using WorkConstIteratorType = ParabolicLineAccessor<const WorkImageType>;
+
+  using RegionType = ImageRegion<TInputImage::ImageDimension>;
+
+  typename TInputImage::ConstPointer inputImage(this->GetInput());
+  typename TOutputImage::Pointer     outputImage(this->GetOutput());
+
+  RegionType region = outputRegionForThread;
+
+  InputConstIteratorType inputIterator(inputImage.GetPointer(), region);
+  WorkIteratorType       workIterator(m_Work.GetPointer(), region);
+  WorkConstIteratorType  workIteratorStage2(m_Work.GetPointer(), region);
+
+  const bool fromInput = m_FromInput && (m_CurrentDimension == 0);
+  if (m_Increment > 0)
+  {
+    unsigned long LineLength = region.GetSize()[m_CurrentDimension];
+    RealType      image_scale = this->GetInput()->GetSpacing()[m_CurrentDimension];
+
+    if (fromInput)
+    {
+      doOneDimension<InputConstIteratorType, WorkIteratorType, RealType, PixelType, OutputComponentType, doDilate>(
+        inputIterator,
+        workIterator,
+        progress,
+        LineLength,
+        m_CurrentDimension,
+        this->m_UseImageSpacing,
+        image_scale,
+        m_Increment,
+        m_ParabolicAlgorithm);
+    }
+    else
+    {
+      doOneDimension<WorkConstIteratorType, WorkIteratorType, RealType, PixelType, OutputComponentType, doDilate>(
+        workIteratorStage2,
+        workIterator,
+        progress,
+        LineLength,
+        m_CurrentDimension,
+        this->m_UseImageSpacing,
+        image_scale,
+        m_Increment,
+        m_ParabolicAlgorithm);
+    }
+  }
+  else if (fromInput)
+  {
+    // scale 0 - copy the input
+    ImageRegionConstIterator<TInputImage> InIt(inputImage, region);
+    ImageRegionIterator<WorkImageType>    WorkIt(m_Work, region);
+    for (; !InIt.IsAtEnd(); ++InIt, ++WorkIt)
+    {
+      WorkIt.Set(static_cast<OutputComponentType>(InIt.Get()));
+    }
+  }
+
+  if (m_CurrentDimension == static_cast<int>(ImageDimension) - 1)
+  {
+    // this thread's part of the scale is complete, copy it to the
+    // output component. The working image and the output share the
+    // same buffered region.
+    const unsigned int          components = outputImage->GetNumberOfComponentsPerPixel();
+    OutputComponentType *       out = outputImage->GetBufferPointer();
+    const OutputComponentType * work = m_Work->GetBufferPointer();
+    for (ImageRegionConstIterator<WorkImageType> WorkIt(m_Work, region); !WorkIt.IsAtEnd(); ++WorkIt)
+    {
+      out[(&WorkIt.Value() - work) * components + m_CurrentComponent] = WorkIt.Get();
+    }
+  }
+}
+
+template <typename TInputImage, bool doDilate, typename TOutputImage>
+void
+ParabolicErodeDilateStackImageFilter<TInputImage, doDilate, TOutputImage>::PrintSelf(std::ostream & os,
+                                                                                     Indent         indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Scales:";
+  for (const auto & s : m_Scales)
+  {
+    os << " " << s;
+  }
+  os << std::endl;
+  os << indent << "UseImageSpacing: " << m_UseImageSpacing << std::endl;
+  os << indent << "Incremental: " << m_Incremental << std::endl;
+  os << indent << "ParabolicAlgorithm: " << m_ParabolicAlgorithm << std::endl;
+}
+} // namespace itk
+#endif
@@ -45,16 +45,16 @@ namespace itk
  * \author Richard Beare, Department of Medicine, Monash University,
  * Australia.  <Richard.Beare@monash.edu>
  **/
-template <typename TInputImage, typename TOutputImage = TInputImage>
+template <typename TInputImage, typename TOutputImage = TInputImage, typename TWorkImage = TOutputImage>
 class ITK_TEMPLATE_EXPORT ParabolicErodeImageFilter
-  : public ParabolicErodeDilateImageFilter<TInputImage, false, TOutputImage>
+  : public ParabolicErodeDilateImageFilter<TInputImage, false, TOutputImage, TWorkImage>
 {
 public:
   ITK_DISALLOW_COPY_AND_MOVE(ParabolicErodeImageFilter);
 
   /** Standard class type alias. */
   using Self = ParabolicErodeImageFilter;
-  using Superclass = ParabolicErodeDilateImageFilter<TInputImage, false, TOutputImage>;
+  using Superclass = ParabolicErodeDilateImageFilter<TInputImage, false, TOutputImage, TWorkImage>;
   using Pointer = SmartPointer<Self>;
   using ConstPointer = SmartPointer<const Self>;
 
@@ -0,0 +1,79 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicErodeStackImageFilter_h
+#define itkParabolicErodeStackImageFilter_h
+
+#include "itkParabolicErodeDilateStackImageFilter.h"
+#include "itkNumericTraits.h"
+
+namespace itk
+{
+/**
+ * \class ParabolicErodeStackImageFilter
+ * \brief Morphological erosion with parabolic structuring elements at a
+ * list of scales.
+ *
+ * Each component of the output VectorImage holds the erosion at one
+ * of the scales.
+ *
+ * \sa ParabolicErodeDilateStackImageFilter
+ * \sa ParabolicErodeImageFilter
+ *
+ * \ingroup ParabolicMorphology
+ *
+ * \author Richard Beare, Department of Medicine, Monash University,
+ * Australia.  <Richard.Beare@monash.edu>
+ *
+ **/
+
+template <typename TInputImage, typename TOutputImage = VectorImage<float, TInputImage::ImageDimension>>
+class ITK_TEMPLATE_EXPORT ParabolicErodeStackImageFilter
+  : public ParabolicErodeDilateStackImageFilter<TInputImage, false, TOutputImage>
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(ParabolicErodeStackImageFilter);
+
+  /** Standard class type alias. */
+  using Self = ParabolicErodeStackImageFilter;
+  using Superclass = ParabolicErodeDilateStackImageFilter<TInputImage, false, TOutputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(ParabolicErodeStackImageFilter, ParabolicErodeDilateStackImageFilter);
+
+  /** Pixel Type of the input image */
+  using InputImageType = TInputImage;
+  using OutputImageType = TOutputImage;
+  using PixelType = typename TInputImage::PixelType;
+  using ScalarRealType = typename NumericTraits<PixelType>::ScalarRealType;
+  using ScalesType = typename Superclass::ScalesType;
+
+  /** Image dimension. */
+  static constexpr unsigned int ImageDimension = TInputImage::ImageDimension;
+
+protected:
+  ParabolicErodeStackImageFilter() = default;
+  ~ParabolicErodeStackImageFilter() override = default;
+};
+} // end namespace itk
+
+#endif
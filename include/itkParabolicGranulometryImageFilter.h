@@ -0,0 +1,389 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicGranulometryImageFilter_h
+#define itkParabolicGranulometryImageFilter_h
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "itkImageToImageFilter.h"
+#include "itkNumericTraits.h"
+#include "itkProgressReporter.h"
+#include "itkParabolicMorphologyEnums.h"
+#include "itkParabolicLineAccessor.h"
+
+namespace itk
+{
+/**
+ * \class ParabolicLineSum
+ * \brief Output "iterator" for doOneDimension that sums the lines
+ * instead of writing them.
+ *
+ * Lines are visited in the same order as ParabolicLineAccessor. With
+ * a label image the line values are summed per label, Labels holds
+ * the sorted labels and Sums has one entry per label. Without one
+ * everything is summed to Sums[0].
+ *
+ * \ingroup ParabolicMorphology
+ */
+template <typename TLabelImage>
+class ParabolicLineSum
+{
+public:
+  using LabelPixelType = typename TLabelImage::PixelType;
+  using LabelAccessorType = ParabolicLineAccessor<const TLabelImage>;
+  using RegionType = typename LabelAccessorType::RegionType;
+  using SizeValueType = typename LabelAccessorType::SizeValueType;
+
+  ParabolicLineSum(const TLabelImage *                 labelImage,
+                   const RegionType &                  region,
+                   const std::vector<LabelPixelType> * labels,
+                   double *                            sums)
+    : m_Region(region)
+    , m_Labels(labels)
+    , m_Sums(sums)
+  {
+    if (labelImage != nullptr)
+    {
+      m_LabelAccessor.reset(new LabelAccessorType(labelImage, region));
+    }
+    this->SetDirection(0);
+  }
+
+  void
+  SetDirection(unsigned int direction)
+  {
+    m_LineLength = m_Region.GetSize()[direction];
+    m_NumberOfLines = (m_LineLength > 0) ? (m_Region.GetNumberOfPixels() / m_LineLength) : 0;
+    m_LineLabels.resize(m_LineLength);
+    if (m_LabelAccessor)
+    {
+      m_LabelAccessor->SetDirection(direction);
+    }
+    this->GoToBegin();
+  }
+
+  void
+  GoToBegin()
+  {
+    m_Line = 0;
+    if (m_LabelAccessor)
+    {
+      m_LabelAccessor->GoToBegin();
+    }
+  }
+
+  bool
+  IsAtEnd() const
+  {
+    return m_Line >= m_NumberOfLines;
+  }
+
+  void
+  NextLine()
+  {
+    ++m_Line;
+    if (m_LabelAccessor)
+    {
+      m_LabelAccessor->NextLine();
+    }
+  }
+
+  // lines are summed one at a time
+  unsigned int
+  GetTileWidth(unsigned int) const
+  {
+    return 1;
+  }
+
+  template <typename TReal>
+  void
+  SetTile(const TReal * buf, unsigned int, size_t, size_t elemStride)
+  {
+    this->SetLine(buf, elemStride);
+  }
+
+  template <typename TReal>
+  void
+  SetLine(const TReal * buf, unsigned int bufStride = 1)
+  {
+    if (!m_LabelAccessor)
+    {
+      double sum = 0;
+      for (SizeValueType i = 0; i < m_LineLength; i++)
+      {
+        sum += buf[i * bufStride];
+      }
+      m_Sums[0] += sum;
+      return;
+    }
+    // labels usually come in runs, so remember the last one
+    m_LabelAccessor->GetLine(m_LineLabels.data());
+    LabelPixelType last = m_LineLabels[0];
+    size_t         bin = this->FindLabel(last);
+    for (SizeValueType i = 0; i < m_LineLength; i++)
+    {
+      if (m_LineLabels[i] != last)
+      {
+        last = m_LineLabels[i];
+        bin = this->FindLabel(last);
+      }
+      m_Sums[bin] += buf[i * bufStride];
+    }
+  }
+
+private:
+  size_t
+  FindLabel(const LabelPixelType & label) const
+  {
+    return std::lower_bound(m_Labels->begin(), m_Labels->end(), label) - m_Labels->begin();
+  }
+
+  RegionType                          m_Region;
+  const std::vector<LabelPixelType> * m_Labels;
+  double *                            m_Sums;
+  std::unique_ptr<LabelAccessorType>  m_LabelAccessor;
+  std::vector<LabelPixelType>         m_LineLabels;
+  SizeValueType                       m_LineLength{ 0 };
+  SizeValueType                       m_NumberOfLines{ 0 };
+  SizeValueType                       m_Line{ 0 };
+};
+
+/**
+ * \class ParabolicGranulometryImageFilter
+ * \brief Sums of parabolic openings at a list of scales, for
+ * granulometries and pattern spectra.
+ *
+ * For each scale the opening of the input is computed and summed,
+ * optionally per label of a label image. The opened images are never
+ * stored - the final pass of each opening sums its lines instead of
+ * writing them. Scales are processed in increasing order, the
+ * erosions incrementally as in ParabolicErodeDilateStackImageFilter,
+ * and the lines of each pass are processed in parallel. Two working
+ * images are shared by all the scales. Borders are treated as in
+ * ParabolicOpenCloseImageFilter, i.e. without the padding of
+ * ParabolicOpenImageFilter's SafeBorder option.
+ *
+ * The output image is the input, passed through. The results are
+ * available, in the order of the scales given, from GetSums,
+ * GetPatternSpectrum and, with a label image, GetRegionSums.
+ *
+ * \sa ParabolicOpenImageFilter
+ * \sa ParabolicErodeDilateStackImageFilter
+ *
+ * \ingroup ParabolicMorphology
+ *
+ * \author Richard Beare, Department of Medicine, Monash University,
+ * Australia.  <Richard.Beare@monash.edu>
+ *
+ **/
+template <typename TInputImage, typename TLabelImage = Image<unsigned char, TInputImage::ImageDimension>>
+class ITK_TEMPLATE_EXPORT ParabolicGranulometryImageFilter
+  : public ImageToImageFilter<TInputImage, TInputImage>
+  , public ParabolicMorphologyEnums
+{
+public:
+  ITK_DISALLOW_COPY_AND_MOVE(ParabolicGranulometryImageFilter);
+
+  /** Standard class type alias. */
+  using Self = ParabolicGranulometryImageFilter;
+  using Superclass = ImageToImageFilter<TInputImage, TInputImage>;
+  using Pointer = SmartPointer<Self>;
+  using ConstPointer = SmartPointer<const Self>;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(ParabolicGranulometryImageFilter, ImageToImageFilter);
+
+  /** Pixel Type of the input image */
+  using InputImageType = TInputImage;
+  using OutputImageType = TInputImage;
+  using LabelImageType = TLabelImage;
+  using PixelType = typename TInputImage::PixelType;
+  using LabelPixelType = typename TLabelImage::PixelType;
+  using RealType = typename NumericTraits<PixelType>::RealType;
+  using ScalarRealType = typename NumericTraits<PixelType>::ScalarRealType;
+
+  using InputSizeType = typename TInputImage::SizeType;
+  using OutputSizeType = typename OutputImageType::SizeType;
+  using OutputIndexType = typename OutputImageType::IndexType;
+
+  using ScalesType = std::vector<ScalarRealType>;
+  using SumsType = std::vector<double>;
+  using LabelsType = std::vector<LabelPixelType>;
+
+  /** Image dimension. */
+  static constexpr unsigned int ImageDimension = TInputImage::ImageDimension;
+
+  using OutputImageRegionType = typename OutputImageType::RegionType;
+
+  /** Set/Get the scales of the openings */
+  void
+  SetScales(const ScalesType & scales)
+  {
+    if (scales != m_Scales)
+    {
+      m_Scales = scales;
+      this->Modified();
+    }
+  }
+  itkGetConstReferenceMacro(Scales, ScalesType);
+
+  /** Set/Get an optional label image. Sums are then also computed
+   * for each label. */
+  void
+  SetLabelImage(const LabelImageType * labelImage)
+  {
+    this->SetNthInput(1, const_cast<LabelImageType *>(labelImage));
+  }
+
+  const LabelImageType *
+  GetLabelImage() const
+  {
+    return itkDynamicCastInDebugMode<const LabelImageType *>(this->ProcessObject::GetInput(1));
+  }
+
+  /**
+   * Set/Get whether the erosion for each scale is computed from the
+   * previous one - default is true. See
+   * ParabolicErodeDilateStackImageFilter.
+   */
+  itkSetMacro(Incremental, bool);
+  itkGetConstReferenceMacro(Incremental, bool);
+  itkBooleanMacro(Incremental);
+
+  /**
+   * Set/Get the method used. See ParabolicErodeDilateImageFilter.
+   */
+  itkSetMacro(ParabolicAlgorithm, int);
+  itkGetConstReferenceMacro(ParabolicAlgorithm, int);
+
+  /**
+   * Set/Get whether the scale refers to pixels or world units -
+   * default is false
+   */
+  itkSetMacro(UseImageSpacing, bool);
+  itkGetConstReferenceMacro(UseImageSpacing, bool);
+  itkBooleanMacro(UseImageSpacing);
+
+  /** Sum of the input */
+  itkGetConstReferenceMacro(InputSum, double);
+
+  /** Sum of the opening at each scale */
+  itkGetConstReferenceMacro(Sums, SumsType);
+
+  /** Pattern spectrum - for each scale, the sum of the opening at the
+   * next smaller scale (or the input for the smallest) minus the sum
+   * at this scale */
+  SumsType
+  GetPatternSpectrum() const;
+
+  /** The labels found in the label image, in increasing order */
+  itkGetConstReferenceMacro(Labels, LabelsType);
+
+  /** Sums of the input for each label */
+  itkGetConstReferenceMacro(InputRegionSums, SumsType);
+
+  /** Sums of the opening at scale k for each label */
+  const SumsType &
+  GetRegionSums(unsigned int k) const
+  {
+    return m_RegionSums[k];
+  }
+
+#ifdef ITK_USE_CONCEPT_CHECKING
+  /** Begin concept checking */
+  itkConceptMacro(Comparable, (Concept::Comparable<PixelType>));
+
+  /** End concept checking */
+#endif
+protected:
+  ParabolicGranulometryImageFilter();
+  ~ParabolicGranulometryImageFilter() override = default;
+  void
+  PrintSelf(std::ostream & os, Indent indent) const override;
+
+  /** Generate Data */
+  void
+  GenerateData() override;
+
+  unsigned int
+  SplitRequestedRegion(unsigned int i, unsigned int num, OutputImageRegionType & splitRegion) override;
+
+  void
+  ThreadedGenerateData(const OutputImageRegionType & outputRegionForThread, ThreadIdType threadId) override;
+
+  void
+  GenerateInputRequestedRegion() override;
+
+  // Override since the filter produces the entire dataset.
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
+  bool m_UseImageSpacing;
+  bool m_Incremental;
+  int  m_ParabolicAlgorithm;
+
+private:
+  using WorkPixelType = typename NumericTraits<PixelType>::FloatType;
+  using WorkImageType = Image<WorkPixelType, ImageDimension>;
+
+  // doOneDimension for the current dimension
+  template <bool doDilate, typename TInIter, typename TOutIter>
+  void
+  ProcessDimension(TInIter &                     inputIterator,
+                   TOutIter &                    outputIterator,
+                   ProgressReporter &            progress,
+                   const OutputImageRegionType & region,
+                   ScalarRealType                scale);
+
+  // copy the lines of the current dimension
+  template <typename TInIter, typename TOutIter>
+  void
+  CopyLines(TInIter & inputIterator, TOutIter & outputIterator, const OutputImageRegionType & region);
+
+  ScalesType m_Scales;
+  double     m_InputSum;
+  SumsType   m_Sums;
+  LabelsType m_Labels;
+  SumsType   m_InputRegionSums;
+
+  std::vector<SumsType> m_RegionSums;
+  std::vector<SumsType> m_ThreadSums;
+
+  // eroded image, and the dilation of it
+  typename WorkImageType::Pointer m_Eroded;
+  typename WorkImageType::Pointer m_Opened;
+
+  int            m_CurrentDimension;
+  bool           m_Dilating;
+  bool           m_FromInput;
+  ScalarRealType m_Increment;
+  ScalarRealType m_CurrentScale;
+  unsigned int   m_CurrentPass;
+};
+} // end namespace itk
+
+#ifndef ITK_MANUAL_INSTANTIATION
+#  include "itkParabolicGranulometryImageFilter.hxx"
+#endif
+
+#endif
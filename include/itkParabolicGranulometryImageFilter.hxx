@@ -0,0 +1,452 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicGranulometryImageFilter_hxx
+#define itkParabolicGranulometryImageFilter_hxx
+
+#include <numeric>
+#include <set>
+
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionIterator.h"
+
+#include "itkParabolicMorphUtils.h"
+
+namespace itk
+{
+template <typename TInputImage, typename TLabelImage>
+ParabolicGranulometryImageFilter<TInputImage, TLabelImage>::ParabolicGranulometryImageFilter()
+{
+  this->SetNumberOfRequiredOutputs(1);
+  this->SetNumberOfRequiredInputs(1);
+
+  m_UseImageSpacing = false;
+  m_Incremental = true;
+  m_ParabolicAlgorithm = INTERSECTION;
+  m_InputSum = 0;
+  m_CurrentDimension = 0;
+  m_Dilating = false;
+  m_FromInput = true;
+  m_Increment = 0;
+  m_CurrentScale = 0;
+  m_CurrentPass = 0;
+
+  this->DynamicMultiThreadingOff();
+}
+
+template <typename TInputImage, typename TLabelImage>
+unsigned int
+ParabolicGranulometryImageFilter<TInputImage, TLabelImage>::SplitRequestedRegion(unsigned int            i,
+                                                                                 unsigned int            num,
+                                                                                 OutputImageRegionType & splitRegion)
+{
+  // Get the output pointer
+  OutputImageType * outputPtr = this->GetOutput();
+
+  // Initialize the splitRegion to the output requested region
+  splitRegion = outputPtr->GetRequestedRegion();
+
+  const OutputSizeType & requestedRegionSize = splitRegion.GetSize();
+
+  OutputIndexType splitIndex = splitRegion.GetIndex();
+  OutputSizeType  splitSize = splitRegion.GetSize();
+
+  // split on the outermost dimension available
+  // and avoid the current dimension
+  int splitAxis = static_cast<int>(outputPtr->GetImageDimension()) - 1;
+  while ((requestedRegionSize[splitAxis] == 1) || (splitAxis == static_cast<int>(m_CurrentDimension)))
+  {
+    --splitAxis;
+    if (splitAxis < 0)
+    { // cannot split
+      itkDebugMacro("Cannot Split");
+      return 1;
+    }
+  }
+
+  // determine the actual number of pieces that will be generated
+  auto range = static_cast<double>(requestedRegionSize[splitAxis]);
+
+  auto         valuesPerThread = static_cast<unsigned int>(std::ceil(range / static_cast<double>(num)));
+  unsigned int maxThreadIdUsed = static_cast<unsigned int>(std::ceil(range / static_cast<double>(valuesPerThread))) - 1;
+
+  // Split the region
+  if (i < maxThreadIdUsed)
+  {
+    splitIndex[splitAxis] += i * valuesPerThread;
+    splitSize[splitAxis] = valuesPerThread;
+  }
+  if (i == maxThreadIdUsed)
+  {
+    splitIndex[splitAxis] += i * valuesPerThread;
+    // last thread needs to process the "rest" dimension being split
+    splitSize[splitAxis] = splitSize[splitAxis] - i * valuesPerThread;
+  }
+
+  // set the split region ivars
+  splitRegion.SetIndex(splitIndex);
+  splitRegion.SetSize(splitSize);
+
+  itkDebugMacro("Split Piece: " << splitRegion);
+
+  return maxThreadIdUsed + 1;
+}
+
+template <typename TInputImage, typename TLabelImage>
+void
+ParabolicGranulometryImageFilter<TInputImage, TLabelImage>::GenerateInputRequestedRegion()
+{
+  // call the superclass' implementation of this method. this should
+  // copy the output requested region to the input requested region
+  Superclass::GenerateInputRequestedRegion();
+
+  // This filter needs all of the inputs
+  auto * image = const_cast<InputImageType *>(this->GetInput());
+  if (image)
+  {
+    image->SetRequestedRegion(image->GetLargestPossibleRegion());
+  }
+  auto * labels = const_cast<LabelImageType *>(this->GetLabelImage());
+  if (labels)
+  {
+    labels->SetRequestedRegion(labels->GetLargestPossibleRegion());
+  }
+}
+
+template <typename TInputImage, typename TLabelImage>
+void
+ParabolicGranulometryImageFilter<TInputImage, TLabelImage>::EnlargeOutputRequestedRegion(DataObject * output)
+{
+  auto * out = dynamic_cast<OutputImageType *>(output);
+
+  if (out)
+  {
+    out->SetRequestedRegion(out->GetLargestPossibleRegion());
+  }
+}
+
+template <typename TInputImage, typename TLabelImage>
+void
+ParabolicGranulometryImageFilter<TInputImage, TLabelImage>::GenerateData()
+{
+  if (m_Scales.empty())
+  {
+    itkExceptionMacro("No scales set");
+  }
+  for (const auto & s : m_Scales)
+  {
+    if (s < 0)
+    {
+      itkExceptionMacro("Scales must not be negative: " << s);
+    }
+  }
+
+  const InputImageType * inputImage = this->GetInput();
+  const LabelImageType * labelImage = this->GetLabelImage();
+
+  // the output is the input
+  this->GraftOutput(const_cast<InputImageType *>(inputImage));
+
+  const OutputImageRegionType region = inputImage->GetRequestedRegion();
+
+  // labels present, and the sums of the input
+  m_Labels.clear();
+  if (labelImage)
+  {
+    std::set<LabelPixelType> found;
+    for (ImageRegionConstIterator<LabelImageType> it(labelImage, region); !it.IsAtEnd(); ++it)
+    {
+      found.insert(it.Get());
+    }
+    m_Labels.assign(found.begin(), found.end());
+  }
+  const size_t bins = std::max<size_t>(1, m_Labels.size());
+
+  m_InputSum = 0;
+  m_InputRegionSums.assign(m_Labels.size(), 0.0);
+  if (labelImage)
+  {
+    ImageRegionConstIterator<LabelImageType> lit(labelImage, region);
+    for (ImageRegionConstIterator<InputImageType> it(inputImage, region); !it.IsAtEnd(); ++it, ++lit)
+    {
+      const size_t bin = std::lower_bound(m_Labels.begin(), m_Labels.end(), lit.Get()) - m_Labels.begin();
+      m_InputRegionSums[bin] += static_cast<double>(it.Get());
+    }
+    m_InputSum = std::accumulate(m_InputRegionSums.begin(), m_InputRegionSums.end(), 0.0);
+  }
+  else
+  {
+    for (ImageRegionConstIterator<InputImageType> it(inputImage, region); !it.IsAtEnd(); ++it)
+    {
+      m_InputSum += static_cast<double>(it.Get());
+    }
+  }
+
+  // two working images are shared by all the scales
+  m_Eroded = WorkImageType::New();
+  m_Eroded->SetRegions(region);
+  m_Eroded->Allocate();
+  m_Opened = WorkImageType::New();
+  m_Opened->SetRegions(region);
+  m_Opened->Allocate();
+
+  ThreadIdType nbthreads = this->GetNumberOfWorkUnits();
+
+  // Set up the multithreaded processing
+  typename ImageSource<OutputImageType>::ThreadStruct str;
+  str.Filter = this;
+
+  ProcessObject::MultiThreaderType * multithreader = this->GetMultiThreader();
+  multithreader->SetNumberOfWorkUnits(nbthreads);
+  multithreader->SetSingleMethod(this->ThreaderCallback, &str);
+
+  m_ThreadSums.assign(nbthreads, SumsType(bins, 0.0));
+  m_Sums.assign(m_Scales.size(), 0.0);
+  m_RegionSums.assign(m_Scales.size(), SumsType(m_Labels.size(), 0.0));
+
+  // process the scales in increasing order
+  std::vector<unsigned int> order(m_Scales.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(
+    order.begin(), order.end(), [this](unsigned int a, unsigned int b) { return m_Scales[a] < m_Scales[b]; });
+
+  ScalarRealType previous = 0;
+  m_CurrentPass = 0;
+  for (unsigned int k = 0; k < order.size(); k++)
+  {
+    const unsigned int component = order[k];
+    m_CurrentScale = m_Scales[component];
+    m_FromInput = (k == 0) || !m_Incremental;
+    m_Increment = m_FromInput ? m_CurrentScale : (m_CurrentScale - previous);
+    previous = m_CurrentScale;
+
+    // erosion
+    m_Dilating = false;
+    for (unsigned int d = 0; d < ImageDimension; d++)
+    {
+      m_CurrentDimension = d;
+      multithreader->SingleMethodExecute();
+      ++m_CurrentPass;
+    }
+
+    // dilation, the last pass sums the lines
+    for (auto & threadSums : m_ThreadSums)
+    {
+      std::fill(threadSums.begin(), threadSums.end(), 0.0);
+    }
+    m_Dilating = true;
+    for (unsigned int d = 0; d < ImageDimension; d++)
+    {
+      m_CurrentDimension = d;
+      multithreader->SingleMethodExecute();
+      ++m_CurrentPass;
+    }
+
+    SumsType totals(bins, 0.0);
+    for (const auto & threadSums : m_ThreadSums)
+    {
+      for (size_t b = 0; b < bins; b++)
+      {
+        totals[b] += threadSums[b];
+      }
+    }
+    m_Sums[component] = std::accumulate(totals.begin(), totals.end(), 0.0);
+    if (labelImage)
+    {
+      m_RegionSums[component] = totals;
+    }
+  }
+
+  m_Eroded = nullptr;
+  m_Opened = nullptr;
+}
+
+template <typename TInputImage, typename TLabelImage>
+template <bool doDilate, typename TInIter, typename TOutIter>
+void
+ParabolicGranulometryImageFilter<TInputImage, TLabelImage>::ProcessDimension(TInIter &          inputIterator,
+                                                                             TOutIter &         outputIterator,
+                                                                             ProgressReporter & progress,
+                                                                             const OutputImageRegionType & region,
+                                                                             ScalarRealType                scale)
+{
+  const unsigned long LineLength = region.GetSize()[m_CurrentDimension];
+  const RealType      image_scale = this->GetInput()->GetSpacing()[m_CurrentDimension];
+
+  doOneDimension<TInIter, TOutIter, RealType, PixelType, WorkPixelType, doDilate>(inputIterator,
+                                                                                 outputIterator,
+                                                                                 progress,
+                                                                                 LineLength,
+                                                                                 m_CurrentDimension,
+                                                                                 this->m_UseImageSpacing,
+                                                                                 image_scale,
+                                                                                 scale,
+                                                                                 m_ParabolicAlgorithm);
+}
+
+template <typename TInputImage, typename TLabelImage>
+template <typename TInIter, typename TOutIter>
+void
+ParabolicGranulometryImageFilter<TInputImage, TLabelImage>::CopyLines(TInIter &                     inputIterator,
+                                                                      TOutIter &                    outputIterator,
+                                                                      const OutputImageRegionType & region)
+{
+  std::vector<RealType> line(region.GetSize()[m_CurrentDimension]);
+  inputIterator.SetDirection(m_CurrentDimension);
+  outputIterator.SetDirection(m_CurrentDimension);
+  while (!inputIterator.IsAtEnd())
+  {
+    inputIterator.GetLine(line.data());
+    outputIterator.SetLine(line.data());
+    inputIterator.NextLine();
+    outputIterator.NextLine();
+  }
+}
+
+template <typename TInputImage, typename TLabelImage>
+void
+ParabolicGranulometryImageFilter<TInputImage, TLabelImage>::ThreadedGenerateData(
+  const OutputImageRegionType & outputRegionForThread,
+  ThreadIdType                  threadId)
+{
+  // compute the number of rows first, so we can setup a progress reporter
+  typename std::vector<unsigned int> NumberOfRows;
+  InputSizeType                      size = outputRegionForThread.GetSize();
+
+  for (unsigned int i = 0; i < ImageDimension; i++)
+  {
+    NumberOfRows.push_back(1);
+    for (unsigned int d = 0; d < ImageDimension; d++)
+    {
+      if (d != i)
+      {
+        NumberOfRows[i] *= size[d];
+      }
+    }
+  }
+  float progressPerPass = 1.0 / (2 * ImageDimension * m_Scales.size());
+
+  ProgressReporter progress(
+    this, threadId, NumberOfRows[m_CurrentDimension], 30, m_CurrentPass * progressPerPass, progressPerPass);
+
+  using InputConstIteratorType = ParabolicLineAccessor<const TInputImage>;
+  using WorkIteratorType = ParabolicLineAccessor<WorkImageType>;
+  using WorkConstIteratorType = ParabolicLineAccessor<const WorkImageType>;
+  using SumType = ParabolicLineSum<TLabelImage>;
+
+  const OutputImageRegionType & region = outputRegionForThread;
+
+  InputConstIteratorType inputIterator(this->GetInput(), region);
+  WorkIteratorType       erodedIterator(m_Eroded.GetPointer(), region);
+  WorkConstIteratorType  erodedConstIterator(m_Eroded.GetPointer(), region);
+  WorkIteratorType       openedIterator(m_Opened.GetPointer(), region);
+  WorkConstIteratorType  openedConstIterator(m_Opened.GetPointer(), region);
+
+  if (!m_Dilating)
+  {
+    const bool fromInput = m_FromInput && (m_CurrentDimension == 0);
+    if (m_Increment > 0)
+    {
+      if (fromInput)
+      {
+        this->template ProcessDimension<false>(inputIterator, erodedIterator, progress, region, m_Increment);
+      }
+      else
+      {
+        this->template ProcessDimension<false>(erodedConstIterator, erodedIterator, progress, region, m_Increment);
+      }
+    }
+    else if (fromInput)
+    {
+      // scale 0 - copy the input
+      this->CopyLines(inputIterator, erodedIterator, region);
+    }
+    return;
+  }
+
+  // the last dilation pass sums the opening rather than storing it
+  const bool last = (m_CurrentDimension == static_cast<int>(ImageDimension) - 1);
+  SumType    sum(this->GetLabelImage(), region, &m_Labels, m_ThreadSums[threadId].data());
+  if (m_CurrentScale > 0)
+  {
+    if (m_CurrentDimension == 0)
+    {
+      if (last)
+      {
+        this->template ProcessDimension<true>(erodedConstIterator, sum, progress, region, m_CurrentScale);
+      }
+      else
+      {
+        this->template ProcessDimension<true>(erodedConstIterator, openedIterator, progress, region, m_CurrentScale);
+      }
+    }
+    else
+    {
+      if (last)
+      {
+        this->template ProcessDimension<true>(openedConstIterator, sum, progress, region, m_CurrentScale);
+      }
+      else
+      {
+        this->template ProcessDimension<true>(openedConstIterator, openedIterator, progress, region, m_CurrentScale);
+      }
+    }
+  }
+  else if (last)
+  {
+    // scale 0 - the opening is the input
+    this->CopyLines(erodedConstIterator, sum, region);
+  }
+}
+
+template <typename TInputImage, typename TLabelImage>
+typename ParabolicGranulometryImageFilter<TInputImage, TLabelImage>::SumsType
+ParabolicGranulometryImageFilter<TInputImage, TLabelImage>::GetPatternSpectrum() const
+{
+  std::vector<unsigned int> order(m_Sums.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(
+    order.begin(), order.end(), [this](unsigned int a, unsigned int b) { return m_Scales[a] < m_Scales[b]; });
+
+  SumsType spectrum(m_Sums.size(), 0.0);
+  double   previous = m_InputSum;
+  for (const unsigned int k : order)
+  {
+    spectrum[k] = previous - m_Sums[k];
+    previous = m_Sums[k];
+  }
+  return spectrum;
+}
+
+template <typename TInputImage, typename TLabelImage>
+void
+ParabolicGranulometryImageFilter<TInputImage, TLabelImage>::PrintSelf(std::ostream & os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Scales:";
+  for (const auto & s : m_Scales)
+  {
+    os << " " << s;
+  }
+  os << std::endl;
+  os << indent << "UseImageSpacing: " << m_UseImageSpacing << std::endl;
+  os << indent << "Incremental: " << m_Incremental << std::endl;
+  os << indent << "ParabolicAlgorithm: " << m_ParabolicAlgorithm << std::endl;
+  os << indent << "InputSum: " << m_InputSum << std::endl;
+}
+} // namespace itk
+#endif
@@ -0,0 +1,412 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicLineAccessor_h
+#define itkParabolicLineAccessor_h
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <type_traits>
+
+#include "itkImageRegion.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#  define ITK_PARABOLIC_PREFETCH(p) __builtin_prefetch(p)
+#else
+#  define ITK_PARABOLIC_PREFETCH(p)
+#endif
+
+namespace itk
+{
+/** Plain casts between pixels and line buffer values. The default
+ * codec of ParabolicLineAccessor. */
+struct ParabolicPixelCast
+{
+  template <typename TReal, typename TPixel>
+  TReal
+  Decode(const TPixel & pixel) const
+  {
+    return static_cast<TReal>(pixel);
+  }
+
+  template <typename TPixel, typename TReal>
+  TPixel
+  Encode(const TReal & value) const
+  {
+    return static_cast<TPixel>(value);
+  }
+};
+
+/** Thresholds pixels as they are read and line buffer values as they
+ * are written, after casting them to TStored, the type they would
+ * otherwise be stored in. Values in [lower, upper] become the inside
+ * value, the others the outside value. */
+template <typename TStored>
+struct ParabolicThresholdCodec
+{
+  ParabolicThresholdCodec(const TStored & lower, const TStored & upper, double inside, double outside)
+    : m_Lower(lower)
+    , m_Upper(upper)
+    , m_Inside(inside)
+    , m_Outside(outside)
+  {}
+
+  template <typename TReal, typename TPixel>
+  TReal
+  Decode(const TPixel & pixel) const
+  {
+    const auto stored = static_cast<TStored>(pixel);
+    return static_cast<TReal>((m_Lower <= stored && stored <= m_Upper) ? m_Inside : m_Outside);
+  }
+
+  template <typename TPixel, typename TReal>
+  TPixel
+  Encode(const TReal & value) const
+  {
+    const auto stored = static_cast<TStored>(value);
+    return static_cast<TPixel>((m_Lower <= stored && stored <= m_Upper) ? m_Inside : m_Outside);
+  }
+
+  TStored m_Lower;
+  TStored m_Upper;
+  double  m_Inside;
+  double  m_Outside;
+};
+
+/** Writes the square root of line buffer values, after casting them
+ * to TStored, the type they would otherwise be stored in. Turns
+ * squared distances into distances as they are written. Negative
+ * values keep their sign, so signed squared distances become signed
+ * distances. */
+template <typename TStored>
+struct ParabolicSqrtCodec
+{
+  template <typename TReal, typename TPixel>
+  TReal
+  Decode(const TPixel & pixel) const
+  {
+    return static_cast<TReal>(pixel);
+  }
+
+  template <typename TPixel, typename TReal>
+  TPixel
+  Encode(const TReal & value) const
+  {
+    const auto stored = static_cast<double>(static_cast<TStored>(value));
+    return static_cast<TPixel>((stored < 0) ? -std::sqrt(-stored) : std::sqrt(stored));
+  }
+};
+
+/**
+ * \class ParabolicLineAccessor
+ * \brief Copies whole image lines to and from line buffers.
+ *
+ * A lightweight replacement for ImageLinearIteratorWithIndex in the
+ * separable filters. Lines are addressed by a pointer to their first
+ * pixel and the offset stride of the line direction, so no N-D index
+ * is maintained per pixel. Lines are visited in the same order as
+ * the linear iterators. When the line direction is not the fastest
+ * moving one, the pixels of the following line are prefetched while
+ * the current one is read.
+ *
+ * TImage may be const qualified for read only access. TCodec converts
+ * between pixels and line buffer values, see ParabolicPixelCast,
+ * ParabolicCompactCodec, ParabolicThresholdCodec and
+ * ParabolicSqrtCodec.
+ *
+ * \ingroup ParabolicMorphology
+ *
+ * \author Richard Beare, Department of Medicine, Monash University,
+ * Australia.  <Richard.Beare@monash.edu>
+ *
+ **/
+template <typename TImage, typename TCodec = ParabolicPixelCast>
+class ParabolicLineAccessor
+{
+public:
+  using ImageType = TImage;
+  using PixelType = typename std::remove_const<TImage>::type::PixelType;
+  using PixelPointer = typename std::conditional<std::is_const<TImage>::value, const PixelType *, PixelType *>::type;
+  static constexpr unsigned int ImageDimension = std::remove_const<TImage>::type::ImageDimension;
+  using RegionType = ImageRegion<ImageDimension>;
+  using OffsetValueType = typename RegionType::OffsetValueType;
+  using SizeValueType = typename RegionType::SizeValueType;
+
+  ParabolicLineAccessor(ImageType * image, const RegionType & region, const TCodec & codec = TCodec())
+    : m_Codec(codec)
+  {
+    m_Region = region;
+    m_Origin = image->GetBufferPointer() + image->ComputeOffset(region.GetIndex());
+    const OffsetValueType * offsetTable = image->GetOffsetTable();
+    for (unsigned int d = 0; d < ImageDimension; d++)
+    {
+      m_Strides[d] = offsetTable[d];
+    }
+    this->SetDirection(0);
+  }
+
+  void
+  SetDirection(unsigned int direction)
+  {
+    m_Direction = direction;
+    m_Stride = m_Strides[direction];
+    m_LineLength = m_Region.GetSize()[direction];
+    m_NumberOfLines = (m_LineLength > 0) ? (m_Region.GetNumberOfPixels() / m_LineLength) : 0;
+    this->GoToBegin();
+  }
+
+  void
+  GoToBegin()
+  {
+    m_Position.fill(0);
+    m_LineStart = m_Origin;
+    m_Line = 0;
+    std::array<SizeValueType, ImageDimension> position = m_Position;
+    m_NextLineStart = this->AdvanceLine(position, m_LineStart);
+  }
+
+  bool
+  IsAtEnd() const
+  {
+    return m_Line >= m_NumberOfLines;
+  }
+
+  void
+  NextLine()
+  {
+    m_LineStart = this->AdvanceLine(m_Position, m_LineStart);
+    ++m_Line;
+    if (m_Line + 1 < m_NumberOfLines)
+    {
+      std::array<SizeValueType, ImageDimension> position = m_Position;
+      m_NextLineStart = this->AdvanceLine(position, m_LineStart);
+    }
+  }
+
+  SizeValueType
+  GetLineLength() const
+  {
+    return m_LineLength;
+  }
+
+  /** Copy the current line into buf. Consecutive pixels are placed
+   * bufStride elements apart, so lines can be interleaved. */
+  template <typename TReal>
+  void
+  GetLine(TReal * buf, unsigned int bufStride = 1) const
+  {
+    const PixelType * in = m_LineStart;
+    if (m_Stride == 1)
+    {
+      for (SizeValueType i = 0; i < m_LineLength; i++)
+      {
+        buf[i * bufStride] = m_Codec.template Decode<TReal>(in[i]);
+      }
+    }
+    else
+    {
+      const bool        prefetch = (m_Line + 1 < m_NumberOfLines);
+      const PixelType * next = m_NextLineStart;
+      for (SizeValueType i = 0; i < m_LineLength; i++)
+      {
+        if (prefetch)
+        {
+          ITK_PARABOLIC_PREFETCH(next);
+          next += m_Stride;
+        }
+        buf[i * bufStride] = m_Codec.template Decode<TReal>(*in);
+        in += m_Stride;
+      }
+    }
+  }
+
+  /** Number of lines, up to maxLines, starting at the current one
+   * that are neighbours along dimension 0. These lines can be
+   * transferred as a tile, reading contiguous runs of memory. */
+  unsigned int
+  GetTileWidth(unsigned int maxLines) const
+  {
+    if (m_Direction == 0 || m_Strides[0] != 1)
+    {
+      return 1;
+    }
+    const SizeValueType run = m_Region.GetSize()[0] - m_Position[0];
+    return static_cast<unsigned int>(std::min<SizeValueType>(run, maxLines));
+  }
+
+  /** Copy width lines, starting at the current one, into buf. Element
+   * i of line t goes to buf[t * lineStride + i * elemStride]. width
+   * must not exceed GetTileWidth(). The accessor is not advanced. */
+  template <typename TReal>
+  void
+  GetTile(TReal * buf, unsigned int width, size_t lineStride, size_t elemStride) const
+  {
+    const PixelType * in = m_LineStart;
+    for (SizeValueType i = 0; i < m_LineLength; i++)
+    {
+      // forming a pointer past the end of the buffer is undefined
+      if (i + 4 < m_LineLength)
+      {
+        ITK_PARABOLIC_PREFETCH(in + 4 * m_Stride);
+      }
+      for (unsigned int t = 0; t < width; t++)
+      {
+        buf[t * lineStride + i * elemStride] = m_Codec.template Decode<TReal>(in[t]);
+      }
+      in += m_Stride;
+    }
+  }
+
+  /** Inverse of GetTile */
+  template <typename TReal>
+  void
+  SetTile(const TReal * buf, unsigned int width, size_t lineStride, size_t elemStride) const
+  {
+    static_assert(!std::is_const<TImage>::value, "SetTile requires a non const image");
+    PixelType * out = const_cast<PixelType *>(m_LineStart);
+    for (SizeValueType i = 0; i < m_LineLength; i++)
+    {
+      for (unsigned int t = 0; t < width; t++)
+      {
+        out[t] = m_Codec.template Encode<PixelType>(buf[t * lineStride + i * elemStride]);
+      }
+      out += m_Stride;
+    }
+  }
+
+  /** Copy buf into the current line */
+  template <typename TReal>
+  void
+  SetLine(const TReal * buf, unsigned int bufStride = 1) const
+  {
+    static_assert(!std::is_const<TImage>::value, "SetLine requires a non const image");
+    PixelType * out = const_cast<PixelType *>(m_LineStart);
+    for (SizeValueType i = 0; i < m_LineLength; i++)
+    {
+      *out = m_Codec.template Encode<PixelType>(buf[i * bufStride]);
+      out += m_Stride;
+    }
+  }
+
+private:
+  // odometer over the dimensions other than the line direction
+  PixelPointer
+  AdvanceLine(std::array<SizeValueType, ImageDimension> & position, PixelPointer start) const
+  {
+    for (unsigned int d = 0; d < ImageDimension; d++)
+    {
+      if (d == m_Direction)
+      {
+        continue;
+      }
+      ++position[d];
+      start += m_Strides[d];
+      if (position[d] < m_Region.GetSize()[d])
+      {
+        return start;
+      }
+      start -= static_cast<OffsetValueType>(position[d]) * m_Strides[d];
+      position[d] = 0;
+    }
+    return start;
+  }
+
+  TCodec                                      m_Codec;
+  RegionType                                  m_Region;
+  PixelPointer                                m_Origin;
+  PixelPointer                                m_LineStart;
+  PixelPointer                                m_NextLineStart;
+  std::array<OffsetValueType, ImageDimension> m_Strides;
+  std::array<SizeValueType, ImageDimension>   m_Position;
+  OffsetValueType                             m_Stride{ 1 };
+  SizeValueType                               m_LineLength{ 0 };
+  SizeValueType                               m_NumberOfLines{ 0 };
+  SizeValueType                               m_Line{ 0 };
+  unsigned int                                m_Direction{ 0 };
+};
+
+/**
+ * \class ParabolicCroppedLineAccessor
+ * \brief Writes the part of longer lines that lies in a region.
+ *
+ * Lines are visited as by ParabolicLineAccessor over region, but the
+ * buffers passed to SetLine and SetTile hold the lines of lineRegion,
+ * which contains region and matches it apart from the line
+ * direction. Only the elements inside region are written, so a pass
+ * over a large region can write its result straight into an image
+ * that only holds part of it. For writing only.
+ *
+ * \ingroup ParabolicMorphology
+ **/
+template <typename TImage, typename TCodec = ParabolicPixelCast>
+class ParabolicCroppedLineAccessor : public ParabolicLineAccessor<TImage, TCodec>
+{
+public:
+  using Superclass = ParabolicLineAccessor<TImage, TCodec>;
+  using RegionType = typename Superclass::RegionType;
+  using SizeValueType = typename Superclass::SizeValueType;
+
+  ParabolicCroppedLineAccessor(TImage *           image,
+                               const RegionType & region,
+                               const RegionType & lineRegion,
+                               const TCodec &     codec = TCodec())
+    : Superclass(image, region, codec)
+    , m_Region(region)
+    , m_LineRegion(lineRegion)
+  {
+    this->SetDirection(0);
+  }
+
+  void
+  SetDirection(unsigned int direction)
+  {
+    Superclass::SetDirection(direction);
+    m_LineOffset = static_cast<SizeValueType>(m_Region.GetIndex()[direction] - m_LineRegion.GetIndex()[direction]);
+    m_LineLength = m_LineRegion.GetSize()[direction];
+  }
+
+  /** Length of the lines of lineRegion */
+  SizeValueType
+  GetLineLength() const
+  {
+    return m_LineLength;
+  }
+
+  template <typename TReal>
+  void
+  SetLine(const TReal * buf, unsigned int bufStride = 1) const
+  {
+    Superclass::SetLine(buf + m_LineOffset * bufStride, bufStride);
+  }
+
+  template <typename TReal>
+  void
+  SetTile(const TReal * buf, unsigned int width, size_t lineStride, size_t elemStride) const
+  {
+    Superclass::SetTile(buf + m_LineOffset * elemStride, width, lineStride, elemStride);
+  }
+
+private:
+  RegionType    m_Region;
+  RegionType    m_LineRegion;
+  SizeValueType m_LineOffset{ 0 };
+  SizeValueType m_LineLength{ 0 };
+};
+} // namespace itk
+
+#endif
@@ -0,0 +1,649 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicMorphSIMDUtils_h
+#define itkParabolicMorphSIMDUtils_h
+
+#include <algorithm>
+#include <type_traits>
+
+#include "itkNumericTraits.h"
+
+// Runtime instruction set selection is only available with gcc/clang
+// on x86. Other platforms always use the scalar line kernels.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#  define ITK_PARABOLIC_X86_DISPATCH
+#  define ITK_PARABOLIC_TARGET(isa) __attribute__((target(isa)))
+#  define ITK_PARABOLIC_ALWAYS_INLINE inline __attribute__((always_inline))
+#  include <immintrin.h>
+#endif
+
+namespace itk
+{
+enum ParabolicSIMDLevel
+{
+  SIMDNONE = 0,
+  SIMDAVX2 = 1,
+  SIMDAVX512 = 2
+};
+
+// The instruction set available on the machine we are running on,
+// rather than the one we were compiled for, so that one build can be
+// used on all nodes.
+inline int
+GetParabolicSIMDLevel()
+{
+#ifdef ITK_PARABOLIC_X86_DISPATCH
+  static const int level = []() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+    {
+      return static_cast<int>(SIMDAVX512);
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+      return static_cast<int>(SIMDAVX2);
+    }
+    return static_cast<int>(SIMDNONE);
+  }();
+  return level;
+#else
+  return SIMDNONE;
+#endif
+}
+
+// number of lines processed in lockstep by the bundle kernels - one
+// register worth of RealType. Zero means use the scalar kernels.
+// Lines in a bundle don't have envelopes of the same length, so the
+// lockstep kernel does extra work. With only 4 or 8 double lanes
+// that costs more than it saves, so bundles are restricted to float.
+// The filters only run float lines when KernelPrecision is
+// FLOATPRECISION, which is off by default, so the bundles are opt in.
+template <typename RealType>
+unsigned int
+GetParabolicBundleLanes()
+{
+  if (!std::is_same<RealType, float>::value)
+  {
+    return 0;
+  }
+  switch (GetParabolicSIMDLevel())
+  {
+    case SIMDAVX512:
+      return 64 / sizeof(RealType);
+    case SIMDAVX2:
+      return 32 / sizeof(RealType);
+    default:
+      return 0;
+  }
+}
+
+#ifdef ITK_PARABOLIC_X86_DISPATCH
+// Thin wrappers around the intrinsics so that the bundle kernels can
+// be written once for float and double. Index vectors have the same
+// lane width as the real vectors, so comparison masks can be applied
+// to either.
+template <typename RealType>
+struct ParabolicAVX2Traits;
+
+template <>
+struct ParabolicAVX2Traits<double>
+{
+  using RealType = double;
+  static constexpr unsigned int Lanes = 4;
+  static constexpr int          LaneShift = 2;
+  using Real = __m256d;
+  using Idx = __m256i;
+  using Mask = __m256d;
+
+  static ITK_PARABOLIC_TARGET("avx2") Real Set(double a) { return _mm256_set1_pd(a); }
+  static ITK_PARABOLIC_TARGET("avx2") Real Load(const double * p) { return _mm256_loadu_pd(p); }
+  static ITK_PARABOLIC_TARGET("avx2") void Store(double * p, Real a) { _mm256_storeu_pd(p, a); }
+  static ITK_PARABOLIC_TARGET("avx2") Real Add(Real a, Real b) { return _mm256_add_pd(a, b); }
+  static ITK_PARABOLIC_TARGET("avx2") Real Sub(Real a, Real b) { return _mm256_sub_pd(a, b); }
+  static ITK_PARABOLIC_TARGET("avx2") Real Mul(Real a, Real b) { return _mm256_mul_pd(a, b); }
+  static ITK_PARABOLIC_TARGET("avx2") Real Div(Real a, Real b) { return _mm256_div_pd(a, b); }
+  static ITK_PARABOLIC_TARGET("avx2") Mask LessEqual(Real a, Real b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+  static ITK_PARABOLIC_TARGET("avx2") Mask Less(Real a, Real b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+  static ITK_PARABOLIC_TARGET("avx2") Mask AllTrue() { return _mm256_castsi256_pd(_mm256_set1_epi64x(-1)); }
+  // lane numbers as reals
+  static ITK_PARABOLIC_TARGET("avx2") Real Ramp() { return _mm256_set_pd(3, 2, 1, 0); }
+  static ITK_PARABOLIC_TARGET("avx2") Mask And(Mask a, Mask b) { return _mm256_and_pd(a, b); }
+  static ITK_PARABOLIC_TARGET("avx2") Mask Or(Mask a, Mask b) { return _mm256_or_pd(a, b); }
+  static ITK_PARABOLIC_TARGET("avx2") bool Any(Mask a) { return _mm256_movemask_pd(a) != 0; }
+  // b where m is set, a elsewhere
+  static ITK_PARABOLIC_TARGET("avx2") Real Select(Mask m, Real a, Real b) { return _mm256_blendv_pd(a, b, m); }
+  static ITK_PARABOLIC_TARGET("avx2") Idx IdxSet(int a) { return _mm256_set1_epi64x(a); }
+  static ITK_PARABOLIC_TARGET("avx2") Idx IdxAdd(Idx a, Idx b) { return _mm256_add_epi64(a, b); }
+  static ITK_PARABOLIC_TARGET("avx2") Idx DecrementWhere(Idx a, Mask m)
+  {
+    return _mm256_add_epi64(a, _mm256_castpd_si256(m));
+  }
+  static ITK_PARABOLIC_TARGET("avx2") Idx IncrementWhere(Idx a, Mask m)
+  {
+    return _mm256_sub_epi64(a, _mm256_castpd_si256(m));
+  }
+  // position of element k of each lane in an interleaved buffer
+  static ITK_PARABOLIC_TARGET("avx2") Idx LaneIndex(Idx k)
+  {
+    return _mm256_add_epi64(_mm256_slli_epi64(k, LaneShift), _mm256_set_epi64x(3, 2, 1, 0));
+  }
+  static ITK_PARABOLIC_TARGET("avx2") Real Gather(const double * p, Idx i) { return _mm256_i64gather_pd(p, i, 8); }
+  static ITK_PARABOLIC_TARGET("avx2") void StoreIdx(long long * p, Idx a)
+  {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), a);
+  }
+  using IdxStorageType = long long;
+};
+
+template <>
+struct ParabolicAVX2Traits<float>
+{
+  using RealType = float;
+  static constexpr unsigned int Lanes = 8;
+  static constexpr int          LaneShift = 3;
+  using Real = __m256;
+  using Idx = __m256i;
+  using Mask = __m256;
+
+  static ITK_PARABOLIC_TARGET("avx2") Real Set(float a) { return _mm256_set1_ps(a); }
+  static ITK_PARABOLIC_TARGET("avx2") Real Load(const float * p) { return _mm256_loadu_ps(p); }
+  static ITK_PARABOLIC_TARGET("avx2") void Store(float * p, Real a) { _mm256_storeu_ps(p, a); }
+  static ITK_PARABOLIC_TARGET("avx2") Real Add(Real a, Real b) { return _mm256_add_ps(a, b); }
+  static ITK_PARABOLIC_TARGET("avx2") Real Sub(Real a, Real b) { return _mm256_sub_ps(a, b); }
+  static ITK_PARABOLIC_TARGET("avx2") Real Mul(Real a, Real b) { return _mm256_mul_ps(a, b); }
+  static ITK_PARABOLIC_TARGET("avx2") Real Div(Real a, Real b) { return _mm256_div_ps(a, b); }
+  static ITK_PARABOLIC_TARGET("avx2") Mask LessEqual(Real a, Real b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+  static ITK_PARABOLIC_TARGET("avx2") Mask Less(Real a, Real b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+  static ITK_PARABOLIC_TARGET("avx2") Mask AllTrue() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+  static ITK_PARABOLIC_TARGET("avx2") Real Ramp() { return _mm256_set_ps(7, 6, 5, 4, 3, 2, 1, 0); }
+  static ITK_PARABOLIC_TARGET("avx2") Mask And(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+  static ITK_PARABOLIC_TARGET("avx2") Mask Or(Mask a, Mask b) { return _mm256_or_ps(a, b); }
+  static ITK_PARABOLIC_TARGET("avx2") bool Any(Mask a) { return _mm256_movemask_ps(a) != 0; }
+  static ITK_PARABOLIC_TARGET("avx2") Real Select(Mask m, Real a, Real b) { return _mm256_blendv_ps(a, b, m); }
+  static ITK_PARABOLIC_TARGET("avx2") Idx IdxSet(int a) { return _mm256_set1_epi32(a); }
+  static ITK_PARABOLIC_TARGET("avx2") Idx IdxAdd(Idx a, Idx b) { return _mm256_add_epi32(a, b); }
+  static ITK_PARABOLIC_TARGET("avx2") Idx DecrementWhere(Idx a, Mask m)
+  {
+    return _mm256_add_epi32(a, _mm256_castps_si256(m));
+  }
+  static ITK_PARABOLIC_TARGET("avx2") Idx IncrementWhere(Idx a, Mask m)
+  {
+    return _mm256_sub_epi32(a, _mm256_castps_si256(m));
+  }
+  static ITK_PARABOLIC_TARGET("avx2") Idx LaneIndex(Idx k)
+  {
+    return _mm256_add_epi32(_mm256_slli_epi32(k, LaneShift), _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+  }
+  static ITK_PARABOLIC_TARGET("avx2") Real Gather(const float * p, Idx i) { return _mm256_i32gather_ps(p, i, 4); }
+  static ITK_PARABOLIC_TARGET("avx2") void StoreIdx(int * p, Idx a)
+  {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), a);
+  }
+  using IdxStorageType = int;
+};
+
+template <typename RealType>
+struct ParabolicAVX512Traits;
+
+template <>
+struct ParabolicAVX512Traits<double>
+{
+  using RealType = double;
+  static constexpr unsigned int Lanes = 8;
+  static constexpr int          LaneShift = 3;
+  using Real = __m512d;
+  using Idx = __m512i;
+  using Mask = __mmask8;
+
+  static ITK_PARABOLIC_TARGET("avx512f") Real Set(double a) { return _mm512_set1_pd(a); }
+  static ITK_PARABOLIC_TARGET("avx512f") Real Load(const double * p) { return _mm512_loadu_pd(p); }
+  static ITK_PARABOLIC_TARGET("avx512f") void Store(double * p, Real a) { _mm512_storeu_pd(p, a); }
+  static ITK_PARABOLIC_TARGET("avx512f") Real Add(Real a, Real b) { return _mm512_add_pd(a, b); }
+  static ITK_PARABOLIC_TARGET("avx512f") Real Sub(Real a, Real b) { return _mm512_sub_pd(a, b); }
+  static ITK_PARABOLIC_TARGET("avx512f") Real Mul(Real a, Real b) { return _mm512_mul_pd(a, b); }
+  static ITK_PARABOLIC_TARGET("avx512f") Real Div(Real a, Real b) { return _mm512_div_pd(a, b); }
+  static ITK_PARABOLIC_TARGET("avx512f") Mask LessEqual(Real a, Real b) { return _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ); }
+  static ITK_PARABOLIC_TARGET("avx512f") Mask Less(Real a, Real b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+  static ITK_PARABOLIC_TARGET("avx512f") Mask AllTrue() { return static_cast<Mask>(0xFF); }
+  static ITK_PARABOLIC_TARGET("avx512f") Mask And(Mask a, Mask b) { return static_cast<Mask>(a & b); }
+  static ITK_PARABOLIC_TARGET("avx512f") bool Any(Mask a) { return a != 0; }
+  static ITK_PARABOLIC_TARGET("avx512f") Real Select(Mask m, Real a, Real b) { return _mm512_mask_blend_pd(m, a, b); }
+  static ITK_PARABOLIC_TARGET("avx512f") Idx  IdxSet(int a) { return _mm512_set1_epi64(a); }
+  static ITK_PARABOLIC_TARGET("avx512f") Idx  IdxAdd(Idx a, Idx b) { return _mm512_add_epi64(a, b); }
+  static ITK_PARABOLIC_TARGET("avx512f") Idx  DecrementWhere(Idx a, Mask m)
+  {
+    return _mm512_mask_sub_epi64(a, m, a, _mm512_set1_epi64(1));
+  }
+  static ITK_PARABOLIC_TARGET("avx512f") Idx IncrementWhere(Idx a, Mask m)
+  {
+    return _mm512_mask_add_epi64(a, m, a, _mm512_set1_epi64(1));
+  }
+  static ITK_PARABOLIC_TARGET("avx512f") Idx LaneIndex(Idx k)
+  {
+    return _mm512_add_epi64(_mm512_slli_epi64(k, LaneShift), _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0));
+  }
+  static ITK_PARABOLIC_TARGET("avx512f") Real Gather(const double * p, Idx i) { return _mm512_i64gather_pd(i, p, 8); }
+  static ITK_PARABOLIC_TARGET("avx512f") void StoreIdx(long long * p, Idx a) { _mm512_storeu_si512(p, a); }
+  using IdxStorageType = long long;
+};
+
+template <>
+struct ParabolicAVX512Traits<float>
+{
+  using RealType = float;
+  static constexpr unsigned int Lanes = 16;
+  static constexpr int          LaneShift = 4;
+  using Real = __m512;
+  using Idx = __m512i;
+  using Mask = __mmask16;
+
+  static ITK_PARABOLIC_TARGET("avx512f") Real Set(float a) { return _mm512_set1_ps(a); }
+  static ITK_PARABOLIC_TARGET("avx512f") Real Load(const float * p) { return _mm512_loadu_ps(p); }
+  static ITK_PARABOLIC_TARGET("avx512f") void Store(float * p, Real a) { _mm512_storeu_ps(p, a); }
+  static ITK_PARABOLIC_TARGET("avx512f") Real Add(Real a, Real b) { return _mm512_add_ps(a, b); }
+  static ITK_PARABOLIC_TARGET("avx512f") Real Sub(Real a, Real b) { return _mm512_sub_ps(a, b); }
+  static ITK_PARABOLIC_TARGET("avx512f") Real Mul(Real a, Real b) { return _mm512_mul_ps(a, b); }
+  static ITK_PARABOLIC_TARGET("avx512f") Real Div(Real a, Real b) { return _mm512_div_ps(a, b); }
+  static ITK_PARABOLIC_TARGET("avx512f") Mask LessEqual(Real a, Real b) { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+  static ITK_PARABOLIC_TARGET("avx512f") Mask Less(Real a, Real b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+  static ITK_PARABOLIC_TARGET("avx512f") Mask AllTrue() { return static_cast<Mask>(0xFFFF); }
+  static ITK_PARABOLIC_TARGET("avx512f") Mask And(Mask a, Mask b) { return static_cast<Mask>(a & b); }
+  static ITK_PARABOLIC_TARGET("avx512f") bool Any(Mask a) { return a != 0; }
+  static ITK_PARABOLIC_TARGET("avx512f") Real Select(Mask m, Real a, Real b) { return _mm512_mask_blend_ps(m, a, b); }
+  static ITK_PARABOLIC_TARGET("avx512f") Idx  IdxSet(int a) { return _mm512_set1_epi32(a); }
+  static ITK_PARABOLIC_TARGET("avx512f") Idx  IdxAdd(Idx a, Idx b) { return _mm512_add_epi32(a, b); }
+  static ITK_PARABOLIC_TARGET("avx512f") Idx  DecrementWhere(Idx a, Mask m)
+  {
+    return _mm512_mask_sub_epi32(a, m, a, _mm512_set1_epi32(1));
+  }
+  static ITK_PARABOLIC_TARGET("avx512f") Idx IncrementWhere(Idx a, Mask m)
+  {
+    return _mm512_mask_add_epi32(a, m, a, _mm512_set1_epi32(1));
+  }
+  static ITK_PARABOLIC_TARGET("avx512f") Idx LaneIndex(Idx k)
+  {
+    return _mm512_add_epi32(_mm512_slli_epi32(k, LaneShift),
+                            _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+  }
+  static ITK_PARABOLIC_TARGET("avx512f") Real Gather(const float * p, Idx i) { return _mm512_i32gather_ps(i, p, 4); }
+  static ITK_PARABOLIC_TARGET("avx512f") void StoreIdx(int * p, Idx a) { _mm512_storeu_si512(p, a); }
+  using IdxStorageType = int;
+};
+
+// Intersection algorithm applied to a bundle of lines at once. The
+// buffers are lane interleaved - entry q of lane l is stored at
+// q * Lanes + l. Each lane keeps its own envelope in a vector
+// register and lanes that have finished removing parabolas are
+// masked, so the results match DoLineIntAlg on each line. Unlike
+// DoLineIntAlg, the value and position of each parabola are stored by
+// envelope position k, so that the loads in the inner loop are
+// independent gathers. The body is shared by the AVX2 and AVX512
+// versions below, which inline it and all of the traits functions it
+// calls, so it is only ever compiled for their targets. gcc warns
+// about the vector ABI of the body on its own, which is never used,
+// and, once the AVX512 gathers and shifts are inlined, about the
+// deliberately undefined pass through operands of their intrinsics.
+#if defined(__GNUC__) && !defined(__clang__)
+#  pragma GCC diagnostic push
+#  pragma GCC diagnostic ignored "-Wpsabi"
+#  pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+template <typename TTraits, bool doDilate>
+ITK_PARABOLIC_ALWAYS_INLINE void
+DoLineIntAlgBundleBody(typename TTraits::RealType *     LineBuf,
+                       typename TTraits::RealType *     Fenv,
+                       typename TTraits::RealType *     v,
+                       typename TTraits::RealType *     z,
+                       const size_t                     N,
+                       const typename TTraits::RealType magnitude)
+{
+  using T = TTraits;
+  using RealType = typename T::RealType;
+  using Real = typename T::Real;
+  using Idx = typename T::Idx;
+  using Mask = typename T::Mask;
+  constexpr unsigned int Lanes = T::Lanes;
+
+  const Real mag = T::Set(magnitude);
+  const Real two = T::Set(2.0);
+  const Idx  one = T::IdxSet(1);
+
+  for (unsigned int l = 0; l < Lanes; l++)
+  {
+    v[l] = 0;
+    z[l] = NumericTraits<int>::NonpositiveMin();
+    z[Lanes + l] = NumericTraits<int>::max();
+  }
+  T::Store(Fenv, T::Div(T::Load(LineBuf), mag));
+
+  Idx                             k = T::IdxSet(0);
+  typename T::IdxStorageType      kStore[Lanes];
+  alignas(64) RealType            sStore[Lanes];
+  alignas(64) RealType            FqStore[Lanes];
+  for (size_t q = 1; q < N; q++)
+  {
+    const Real rq = T::Set(static_cast<RealType>(q));
+    const Real qq = T::Mul(rq, rq);
+    const Real lb = T::Div(T::Load(LineBuf + q * Lanes), mag);
+    const Real Fq = doDilate ? T::Sub(lb, qq) : T::Add(lb, qq);
+
+    // remove parabolas from the surface until the new one intersects
+    // beyond the last boundary - lanes drop out as they finish
+    Mask pending = T::AllTrue();
+    Real s = T::Set(0);
+    do
+    {
+      const Idx  kidx = T::LaneIndex(k);
+      const Real vk = T::Gather(v, kidx);
+      const Real Fv = T::Gather(Fenv, kidx);
+      const Real zk = T::Gather(z, kidx);
+      const Real sl = T::Div(T::Sub(Fq, Fv), T::Mul(two, doDilate ? T::Sub(vk, rq) : T::Sub(rq, vk)));
+      const Mask pop = T::And(pending, T::LessEqual(sl, zk));
+      s = T::Select(pending, s, sl);
+      k = T::DecrementWhere(k, pop);
+      pending = pop;
+    } while (T::Any(pending));
+
+    // bump k to add the new parabola
+    k = T::IdxAdd(k, one);
+    T::StoreIdx(kStore, k);
+    T::Store(sStore, s);
+    T::Store(FqStore, Fq);
+    for (unsigned int l = 0; l < Lanes; l++)
+    {
+      const size_t kk = static_cast<size_t>(kStore[l]);
+      v[kk * Lanes + l] = static_cast<RealType>(q);
+      Fenv[kk * Lanes + l] = FqStore[l];
+      z[kk * Lanes + l] = sStore[l];
+      z[(kk + 1) * Lanes + l] = NumericTraits<int>::max();
+    }
+  }
+
+  // now reconstruct output
+  k = T::IdxSet(0);
+  for (size_t q = 0; q < N; q++)
+  {
+    const Real rq = T::Set(static_cast<RealType>(q));
+    Mask       advance;
+    do
+    {
+      advance = T::Less(T::Gather(z, T::LaneIndex(T::IdxAdd(k, one))), rq);
+      k = T::IncrementWhere(k, advance);
+    } while (T::Any(advance));
+
+    const Idx  kidx = T::LaneIndex(k);
+    const Real vk = T::Gather(v, kidx);
+    const Real Fv = T::Gather(Fenv, kidx);
+    const Real para = T::Mul(rq, T::Sub(rq, T::Add(vk, vk)));
+    T::Store(LineBuf + q * Lanes, T::Mul(doDilate ? T::Sub(Fv, para) : T::Add(para, Fv), mag));
+  }
+}
+
+template <typename TTraits, bool doDilate>
+ITK_PARABOLIC_TARGET("avx2") __attribute__((flatten))
+void DoLineIntAlgBundleAVX2(typename TTraits::RealType *     LineBuf,
+                            typename TTraits::RealType *     Fenv,
+                            typename TTraits::RealType *     v,
+                            typename TTraits::RealType *     z,
+                            const size_t                     N,
+                            const typename TTraits::RealType magnitude)
+{
+  DoLineIntAlgBundleBody<TTraits, doDilate>(LineBuf, Fenv, v, z, N, magnitude);
+}
+
+template <typename TTraits, bool doDilate>
+ITK_PARABOLIC_TARGET("avx512f") __attribute__((flatten))
+void DoLineIntAlgBundleAVX512(typename TTraits::RealType *     LineBuf,
+                              typename TTraits::RealType *     Fenv,
+                              typename TTraits::RealType *     v,
+                              typename TTraits::RealType *     z,
+                              const size_t                     N,
+                              const typename TTraits::RealType magnitude)
+{
+  DoLineIntAlgBundleBody<TTraits, doDilate>(LineBuf, Fenv, v, z, N, magnitude);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#  pragma GCC diagnostic pop
+#endif
+
+// Contact point algorithm with the search window evaluated one vector
+// of offsets at a time. Each lane keeps its own best value and contact
+// offset and the lanes are combined at the end of the window, using
+// the same tie breaking as DoLineCP. The window is limited to kmax,
+// beyond which no offset can beat the centre pixel. Both buffers need
+// Lanes elements of readable padding after the end of the line.
+template <typename TTraits, bool doDilate>
+ITK_PARABOLIC_TARGET("avx2")
+void DoLineCPAVX2(typename TTraits::RealType *     LineBuf,
+                  typename TTraits::RealType *     tmpLineBuf,
+                  const long                       N,
+                  const typename TTraits::RealType magnitude,
+                  const typename TTraits::RealType extreme,
+                  const long                       kmax)
+{
+  using T = TTraits;
+  using RealType = typename T::RealType;
+  using Real = typename T::Real;
+  using Mask = typename T::Mask;
+  constexpr long Lanes = T::Lanes;
+  // windows shorter than this are searched with scalar code, as the
+  // lane reduction costs more than it saves
+  constexpr long ShortWindow = 2 * Lanes;
+
+  const Real mag = T::Set(magnitude);
+  const Real ext = T::Set(extreme);
+  const Real ramp = T::Ramp();
+  // offsets that were never selected are marked with this
+  const Real none = T::Set(static_cast<RealType>(N + 1));
+
+  RealType bestStore[Lanes];
+  RealType kStore[Lanes];
+
+  // negative half of the parabola - ties go to the larger offset
+  long koffset = 0, newcontact = 0;
+  for (long pos = 0; pos < N; pos++)
+  {
+    const long start = std::max(koffset, -kmax);
+    if (1 - start < ShortWindow)
+    {
+      RealType BaseVal = extreme;
+      for (long krange = start; krange <= 0; krange++)
+      {
+        const RealType val = LineBuf[pos + krange] - magnitude * krange * krange;
+        if (doDilate ? (val >= BaseVal) : (val <= BaseVal))
+        {
+          BaseVal = val;
+          newcontact = krange;
+        }
+      }
+      tmpLineBuf[pos] = BaseVal;
+      koffset = newcontact - 1;
+      continue;
+    }
+    Real       best = ext;
+    Real       bestk = none;
+    const Real last = T::Set(0);
+    for (long base = start; base <= 0; base += Lanes)
+    {
+      const Real k = T::Add(T::Set(static_cast<RealType>(base)), ramp);
+      const Real val = T::Sub(T::Load(LineBuf + pos + base), T::Mul(T::Mul(mag, k), k));
+      const Mask better = T::And(T::LessEqual(k, last), doDilate ? T::LessEqual(best, val) : T::LessEqual(val, best));
+      best = T::Select(better, best, val);
+      bestk = T::Select(better, bestk, k);
+    }
+    T::Store(bestStore, best);
+    T::Store(kStore, bestk);
+    RealType BaseVal = extreme;
+    long     contact = 1;
+    for (long l = 0; l < Lanes; l++)
+    {
+      if (kStore[l] > 0)
+      {
+        continue;
+      }
+      if ((doDilate ? (bestStore[l] > BaseVal) : (bestStore[l] < BaseVal)) ||
+          (bestStore[l] == BaseVal && (contact > 0 || kStore[l] > contact)))
+      {
+        BaseVal = bestStore[l];
+        contact = static_cast<long>(kStore[l]);
+      }
+    }
+    if (contact <= 0)
+    {
+      newcontact = contact;
+    }
+    tmpLineBuf[pos] = BaseVal;
+    koffset = newcontact - 1;
+  }
+
+  // positive half of parabola - ties go to the smaller offset
+  koffset = newcontact = 0;
+  for (long pos = N - 1; pos >= 0; pos--)
+  {
+    const long end = std::min(koffset, kmax);
+    if (end + 1 < ShortWindow)
+    {
+      RealType BaseVal = extreme;
+      for (long krange = end; krange >= 0; krange--)
+      {
+        const RealType val = tmpLineBuf[pos + krange] - magnitude * krange * krange;
+        if (doDilate ? (val >= BaseVal) : (val <= BaseVal))
+        {
+          BaseVal = val;
+          newcontact = krange;
+        }
+      }
+      LineBuf[pos] = BaseVal;
+      koffset = newcontact + 1;
+      continue;
+    }
+    Real       best = ext;
+    Real       bestk = none;
+    const Real last = T::Set(static_cast<RealType>(end));
+    for (long base = 0; base <= end; base += Lanes)
+    {
+      const Real k = T::Add(T::Set(static_cast<RealType>(base)), ramp);
+      const Real val = T::Sub(T::Load(tmpLineBuf + pos + base), T::Mul(T::Mul(mag, k), k));
+      // the first offset in a lane is always taken, as in DoLineCP
+      const Mask unset = T::LessEqual(none, bestk);
+      const Mask better =
+        T::And(T::LessEqual(k, last), T::Or(unset, doDilate ? T::Less(best, val) : T::Less(val, best)));
+      best = T::Select(better, best, val);
+      bestk = T::Select(better, bestk, k);
+    }
+    T::Store(bestStore, best);
+    T::Store(kStore, bestk);
+    RealType BaseVal = extreme;
+    long     contact = -1;
+    for (long l = 0; l < Lanes; l++)
+    {
+      if (kStore[l] > end)
+      {
+        continue;
+      }
+      if ((doDilate ? (bestStore[l] > BaseVal) : (bestStore[l] < BaseVal)) ||
+          (bestStore[l] == BaseVal && (contact < 0 || kStore[l] < contact)))
+      {
+        BaseVal = bestStore[l];
+        contact = static_cast<long>(kStore[l]);
+      }
+    }
+    if (contact >= 0)
+    {
+      newcontact = contact;
+    }
+    LineBuf[pos] = BaseVal;
+    koffset = newcontact + 1;
+  }
+}
+#endif
+
+// Entry point for the bundle kernel. The number of lanes in the
+// buffers must be GetParabolicBundleLanes<RealType>(), and z needs
+// (N + 1) entries per lane.
+template <typename RealType, bool doDilate>
+void
+DoLineIntAlgBundle(RealType *     LineBuf,
+                   RealType *     F,
+                   RealType *     v,
+                   RealType *     z,
+                   const size_t   N,
+                   const RealType magnitude)
+{
+#ifdef ITK_PARABOLIC_X86_DISPATCH
+  switch (GetParabolicSIMDLevel())
+  {
+    case SIMDAVX512:
+      DoLineIntAlgBundleAVX512<ParabolicAVX512Traits<RealType>, doDilate>(LineBuf, F, v, z, N, magnitude);
+      break;
+    case SIMDAVX2:
+      DoLineIntAlgBundleAVX2<ParabolicAVX2Traits<RealType>, doDilate>(LineBuf, F, v, z, N, magnitude);
+      break;
+    default:
+      itkAssertInDebugAndIgnoreInReleaseMacro(false);
+      break;
+  }
+#else
+  (void)LineBuf;
+  (void)F;
+  (void)v;
+  (void)z;
+  (void)N;
+  (void)magnitude;
+  itkAssertInDebugAndIgnoreInReleaseMacro(false);
+#endif
+}
+
+// number of lanes used by the vector contact point kernel, or zero if
+// it isn't available. Buffers passed to DoLineCPVector need this many
+// elements of padding.
+template <typename RealType>
+unsigned int
+GetParabolicCPLanes()
+{
+  if (!(std::is_same<RealType, float>::value || std::is_same<RealType, double>::value))
+  {
+    return 0;
+  }
+  return (GetParabolicSIMDLevel() >= SIMDAVX2) ? static_cast<unsigned int>(32 / sizeof(RealType)) : 0;
+}
+
+template <typename RealType, bool doDilate>
+void
+DoLineCPVector(RealType *     LineBuf,
+               RealType *     tmpLineBuf,
+               const long     N,
+               const RealType magnitude,
+               const RealType extreme,
+               const long     kmax)
+{
+#ifdef ITK_PARABOLIC_X86_DISPATCH
+  DoLineCPAVX2<ParabolicAVX2Traits<RealType>, doDilate>(LineBuf, tmpLineBuf, N, magnitude, extreme, kmax);
+#else
+  (void)LineBuf;
+  (void)tmpLineBuf;
+  (void)N;
+  (void)magnitude;
+  (void)extreme;
+  (void)kmax;
+  itkAssertInDebugAndIgnoreInReleaseMacro(false);
+#endif
+}
+} // namespace itk
+#endif
@@ -18,16 +18,119 @@
 #ifndef itkParabolicMorphUtils_h
 #define itkParabolicMorphUtils_h
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <type_traits>
+#include <typeinfo>
+
 #include <itkArray.h>
 
+#include "itkMath.h"
 #include "itkProgressReporter.h"
+#include "itkParabolicMorphSIMDUtils.h"
+#include "itkParabolicMorphologyEnums.h"
+#include "itkParabolicAutoTuneCache.h"
+#include "itkParabolicScratchArena.h"
 
 namespace itk
 {
-// contact point algorithm
+// bound on the contact point search. A pixel k away can only be the
+// contact point if |magnitude| k^2 doesn't exceed the range of the
+// line, so searches never need to go further than this.
+template <typename LineBufferType, typename RealType>
+long
+ParabolicContactWindow(const LineBufferType & LineBuf, const long LineLength, const RealType magnitude)
+{
+  RealType lo = LineBuf[0];
+  RealType hi = LineBuf[0];
+  for (long i = 1; i < LineLength; i++)
+  {
+    lo = std::min(lo, static_cast<RealType>(LineBuf[i]));
+    hi = std::max(hi, static_cast<RealType>(LineBuf[i]));
+  }
+  const double ratio = (static_cast<double>(hi) - static_cast<double>(lo)) / std::abs(static_cast<double>(magnitude));
+  if (!(ratio < static_cast<double>(LineLength) * static_cast<double>(LineLength)))
+  {
+    return LineLength;
+  }
+  return static_cast<long>(std::floor(std::sqrt(ratio)));
+}
+
+// the same bound for a whole erosion or dilation. An input pixel
+// further than the radius from an output pixel, along any dimension,
+// can't produce the output value when the input values span range,
+// as the output pixel's own input value is always better. The scales
+// are in world units when useSpacing is set.
+template <typename TSize, typename TScale, typename TSpacing>
+TSize
+ParabolicSupportRadius(const TScale & scale, const TSpacing & spacing, const bool useSpacing, const double range)
+{
+  TSize radius;
+  for (unsigned int d = 0; d < TSize::Dimension; d++)
+  {
+    double sigma = scale[d];
+    if (useSpacing)
+    {
+      sigma /= (spacing[d] * spacing[d]);
+    }
+    radius[d] = static_cast<typename TSize::SizeValueType>(std::ceil(std::sqrt(2 * sigma * range)));
+  }
+  return radius;
+}
+
+// region grown by border, or shrunk by crop, on both sides of the
+// dimensions from begin up to, but not including, end
+template <typename TRegion, typename TSize>
+TRegion
+ParabolicBorderRegion(TRegion region, const TSize & border, const TSize & crop, unsigned int begin, unsigned int end)
+{
+  for (unsigned int d = begin; d < end; d++)
+  {
+    const auto grow = static_cast<typename TRegion::IndexValueType>(border[d]) -
+                      static_cast<typename TRegion::IndexValueType>(crop[d]);
+    region.SetIndex(d, region.GetIndex(d) - grow);
+    region.SetSize(d, static_cast<typename TRegion::SizeValueType>(region.GetSize(d) + 2 * grow));
+  }
+  return region;
+}
+
+// restricts region to the lines along direction that cross
+// outputRegion, and crops outputRegion to those lines. The line
+// direction of region is kept whole, for a last pass that reads whole
+// lines and writes the part of them inside outputRegion, see
+// ParabolicCroppedLineAccessor. Returns false when no line crosses
+// it.
+template <typename TRegion>
+bool
+ParabolicCropLines(TRegion & region, TRegion & outputRegion, const unsigned int direction)
+{
+  for (unsigned int d = 0; d < TRegion::ImageDimension; d++)
+  {
+    if (d == direction)
+    {
+      continue;
+    }
+    const auto start = std::max(region.GetIndex(d), outputRegion.GetIndex(d));
+    const auto end = std::min(region.GetUpperIndex()[d], outputRegion.GetUpperIndex()[d]);
+    if (end < start)
+    {
+      return false;
+    }
+    region.SetIndex(d, start);
+    region.SetSize(d, static_cast<typename TRegion::SizeValueType>(end - start + 1));
+    outputRegion.SetIndex(d, start);
+    outputRegion.SetSize(d, region.GetSize(d));
+  }
+  return true;
+}
+
+// contact point algorithm. The search for the contact point is
+// limited to kmax pixels - see ParabolicContactWindow.
 template <typename LineBufferType, typename RealType, typename TInputPixel, bool doDilate>
 void
-DoLineCP(LineBufferType & LineBuf, LineBufferType & tmpLineBuf, const RealType magnitude)
+DoLineCP(LineBufferType & LineBuf, LineBufferType & tmpLineBuf, const RealType magnitude, const long kmax)
 {
   static constexpr RealType extreme =
     doDilate ? NumericTraits<TInputPixel>::NonpositiveMin() : NumericTraits<TInputPixel>::max();
@@ -41,7 +144,7 @@ DoLineCP(LineBufferType & LineBuf, LineBufferType & tmpLineBuf, const RealType m
   for (long pos = 0; pos < LineLength; pos++)
   {
     auto BaseVal = extreme; // the base value for comparison
-    for (long krange = koffset; krange <= 0; krange++)
+    for (long krange = std::max(koffset, -kmax); krange <= 0; krange++)
     {
       // difference needs to be paramaterised
       RealType T = LineBuf[pos + krange] - magnitude * krange * krange;
@@ -60,7 +163,7 @@ DoLineCP(LineBufferType & LineBuf, LineBufferType & tmpLineBuf, const RealType m
   for (long pos = LineLength - 1; pos >= 0; pos--)
   {
     auto BaseVal = extreme; // the base value for comparison
-    for (long krange = koffset; krange >= 0; krange--)
+    for (long krange = std::min(koffset, kmax); krange >= 0; krange--)
     {
       RealType T = tmpLineBuf[pos + krange] - magnitude * krange * krange;
       if (doDilate ? (T >= BaseVal) : (T <= BaseVal))
@@ -74,17 +177,85 @@ DoLineCP(LineBufferType & LineBuf, LineBufferType & tmpLineBuf, const RealType m
   }
 }
 
+// whether a value lies within the band of a clamped erosion (below
+// clampValue) or dilation (above clampValue)
+template <bool doDilate, typename RealType>
+inline bool
+ParabolicWithinBand(const RealType value, const RealType clampValue)
+{
+  return doDilate ? (value > clampValue) : (value < clampValue);
+}
+
+// the clampValue that leaves the output unclamped
+template <bool doDilate, typename RealType>
+inline RealType
+ParabolicNoClamp()
+{
+  return doDilate ? NumericTraits<RealType>::NonpositiveMin() : NumericTraits<RealType>::max();
+}
+
+template <bool doDilate, typename RealType>
+inline RealType
+ParabolicClamp(const RealType value, const RealType clampValue)
+{
+  return doDilate ? std::max(value, clampValue) : std::min(value, clampValue);
+}
+
+// erosions and dilations leave constant lines unchanged, apart from
+// the clamp, so there is no need to build an envelope for them.
+// Returns whether the line, with elements stride apart, is constant,
+// in which case it has been fully processed.
+template <bool doDilate, typename RealType>
+inline bool
+ParabolicConstantLine(RealType *     line,
+                      const long     LineLength,
+                      const size_t   stride,
+                      const bool     banded,
+                      const RealType clampValue)
+{
+  const RealType first = line[0];
+  for (long i = 1; i < LineLength; i++)
+  {
+    if (line[i * stride] != first)
+    {
+      return false;
+    }
+  }
+  if (banded)
+  {
+    const RealType clamped = ParabolicClamp<doDilate, RealType>(first, clampValue);
+    for (long i = 0; i < LineLength; i++)
+    {
+      line[i * stride] = clamped;
+    }
+  }
+  return true;
+}
+
 // intersection algorithm
 // This algorithm has been described a couple of times. First by van
 // den Boomgaard and more recently by Felzenszwalb and Huttenlocher,
 // in the context of generalized distance transform
-template <typename LineBufferType, typename IndexBufferType, typename EnvBufferType, typename RealType, bool doDilate>
+// If argmin is given, the position of the parabola that produced
+// each output value is stored in it.
+// With banded set, the output is clamped to clampValue and the
+// parabolas of values beyond it, which can't produce anything within
+// the band, are left out of the envelope. Lines entirely beyond it
+// are just filled with clampValue.
+template <typename LineBufferType,
+          typename IndexBufferType,
+          typename EnvBufferType,
+          typename RealType,
+          bool doDilate,
+          bool banded = false>
 void
-DoLineIntAlg(LineBufferType &  LineBuf,
-             EnvBufferType &   F,
-             IndexBufferType & v,
-             EnvBufferType &   z,
-             const RealType    magnitude)
+DoLineIntAlg(LineBufferType &                      LineBuf,
+             EnvBufferType &                       F,
+             IndexBufferType &                     v,
+             EnvBufferType &                       z,
+             const RealType                        magnitude,
+             typename IndexBufferType::ValueType * argmin = nullptr,
+             const RealType                        clampValue = RealType())
 {
   int k; /* Index of rightmost parabola in lower envelope */
   /* Locations of parabolas in lower envelope */
@@ -102,16 +273,42 @@ DoLineIntAlg(LineBufferType &  LineBuf,
   /* holds precomputed scale*f(q) + q^2 for speedup */
   //  LineBufferType F(LineBuf.size());
 
+  const size_t N(LineBuf.size());
+  size_t       first = 0;
+  if (banded)
+  {
+    while (first < N && !ParabolicWithinBand<doDilate, RealType>(LineBuf[first], clampValue))
+    {
+      ++first;
+    }
+    if (first == N)
+    {
+      for (size_t q = 0; q < N; q++)
+      {
+        LineBuf[q] = clampValue;
+        if (argmin)
+        {
+          argmin[q] = q;
+        }
+      }
+      return;
+    }
+  }
+
   // initialize
   k = 0;
-  v[0] = 0;
+  v[0] = first;
   z[0] = NumericTraits<int>::NonpositiveMin();
   z[1] = NumericTraits<int>::max();
-  F[0] = LineBuf[0] / magnitude;
-  const size_t N(LineBuf.size());
+  const RealType firstSqr = static_cast<RealType>(first) * static_cast<RealType>(first);
+  F[first] = (LineBuf[first] / magnitude) + (doDilate ? -firstSqr : firstSqr);
 
-  for (size_t q = 1; q < N; q++) /* main loop */
+  for (size_t q = first + 1; q < N; q++) /* main loop */
   {
+    if (banded && !ParabolicWithinBand<doDilate, RealType>(LineBuf[q], clampValue))
+    {
+      continue;
+    }
     if (doDilate)
     {
       /* precompute f(q) + q^2 for speedup */
@@ -161,6 +358,14 @@ DoLineIntAlg(LineBufferType &  LineBuf,
       itkAssertInDebugAndIgnoreInReleaseMacro(static_cast<size_t>(v[k]) >= 0);
       LineBuf[q] = static_cast<RealType>(
         (F[v[k]] - (static_cast<RealType>(q) * (static_cast<RealType>(q) - 2 * v[k]))) * magnitude);
+      if (banded)
+      {
+        LineBuf[q] = ParabolicClamp<doDilate, RealType>(LineBuf[q], clampValue);
+      }
+      if (argmin)
+      {
+        argmin[q] = v[k];
+      }
     }
   }
   else
@@ -175,17 +380,433 @@ DoLineIntAlg(LineBufferType &  LineBuf,
       itkAssertInDebugAndIgnoreInReleaseMacro(static_cast<size_t>(v[k]) < N);
       itkAssertInDebugAndIgnoreInReleaseMacro(static_cast<size_t>(v[k]) >= 0);
       LineBuf[q] = ((static_cast<RealType>(q) * (static_cast<RealType>(q) - 2 * v[k]) + F[v[k]]) * magnitude);
+      if (banded)
+      {
+        LineBuf[q] = ParabolicClamp<doDilate, RealType>(LineBuf[q], clampValue);
+      }
+      if (argmin)
+      {
+        argmin[q] = v[k];
+      }
     }
   }
 }
 
+// integer version of the intersection algorithm. Line values and the
+// parabola weight must be whole numbers. The lower envelope is built
+// on G[q] = f(q) + weight * q^2 (the float version divides by the
+// weight instead), and intersections are kept as fractions
+// zNum/zDen, which are compared by cross multiplication. There is no
+// division and the result is exact as long as IntType doesn't
+// overflow - see ParabolicIntegerKernelFits.
+// Dilation is computed as the negated erosion of the negated line.
+// argmin, banded and clampValue are as for DoLineIntAlg. clampValue
+// must be a whole number.
+template <typename LineBufferType,
+          typename IndexBufferType,
+          typename IntBufferType,
+          typename IntType,
+          bool doDilate,
+          bool banded = false>
+void
+DoLineIntAlgInteger(LineBufferType &                        LineBuf,
+                    IntBufferType &                         G,
+                    IndexBufferType &                       v,
+                    IntBufferType &                         zNum,
+                    IntBufferType &                         zDen,
+                    const IntType                           weight,
+                    typename IndexBufferType::ValueType *   argmin = nullptr,
+                    const typename LineBufferType::ValueType clampValue = 0)
+{
+  using RealType = typename LineBufferType::ValueType;
+  const IntType sign = doDilate ? -1 : 1;
+  const long    N = static_cast<long>(LineBuf.size());
+
+  long first = 0;
+  if (banded)
+  {
+    while (first < N && !ParabolicWithinBand<doDilate, RealType>(LineBuf[first], clampValue))
+    {
+      ++first;
+    }
+    if (first == N)
+    {
+      for (long q = 0; q < N; q++)
+      {
+        LineBuf[q] = clampValue;
+        if (argmin)
+        {
+          argmin[q] = q;
+        }
+      }
+      return;
+    }
+  }
+
+  long k = 0;
+  v[0] = first;
+  G[first] = sign * static_cast<IntType>(Math::Round<long long>(LineBuf[first])) +
+             weight * static_cast<IntType>(first) * static_cast<IntType>(first);
+  for (long q = first + 1; q < N; q++)
+  {
+    if (banded && !ParabolicWithinBand<doDilate, RealType>(LineBuf[q], clampValue))
+    {
+      continue;
+    }
+    const IntType iq = static_cast<IntType>(q);
+    G[q] = sign * static_cast<IntType>(Math::Round<long long>(LineBuf[q])) + weight * iq * iq;
+    IntType num, den;
+    while (true)
+    {
+      /* intersection with the last parabola is num/den */
+      num = G[q] - G[v[k]];
+      den = 2 * weight * (iq - v[k]);
+      if (k > 0 && num * zDen[k] <= zNum[k] * den)
+      {
+        /* remove last parabola from surface */
+        k--;
+      }
+      else
+      {
+        break;
+      }
+    }
+    k++;
+    v[k] = q;
+    zNum[k] = num;
+    zDen[k] = den;
+  }
+  /* now reconstruct output. Parabola k is used from the first
+     integer position after its left boundary, so each span can be
+     filled without comparisons */
+  const long last = k;
+  long       start = 0;
+  for (k = 0; k <= last; k++)
+  {
+    long end = N;
+    if (k < last)
+    {
+      /* floor of the right boundary */
+      IntType b = zNum[k + 1] / zDen[k + 1];
+      if ((zNum[k + 1] % zDen[k + 1] != 0) && (zNum[k + 1] < 0))
+      {
+        --b;
+      }
+      end = std::min(N, std::max(start, static_cast<long>(b) + 1));
+    }
+    const IntType vk = v[k];
+    const IntType Gv = G[vk];
+    for (long q = start; q < end; q++)
+    {
+      const IntType iq = static_cast<IntType>(q);
+      LineBuf[q] = static_cast<RealType>(sign * (Gv + weight * iq * (iq - 2 * vk)));
+      if (banded)
+      {
+        LineBuf[q] = ParabolicClamp<doDilate, RealType>(LineBuf[q], clampValue);
+      }
+    }
+    if (argmin)
+    {
+      std::fill(argmin + start, argmin + end, v[k]);
+    }
+    start = end;
+  }
+}
+
+// whether a line of length N with values no larger than maxAbs in
+// magnitude can be processed by DoLineIntAlgInteger using IntType.
+// The largest intermediate is the cross multiplication in the pop
+// test, bounded by 2(maxAbs + w N^2) * 2 w N.
+template <typename IntType>
+bool
+ParabolicIntegerKernelFits(const double maxAbs, const double weight, const long N)
+{
+  const double n = static_cast<double>(N);
+  const double bound = 4.0 * weight * n * (maxAbs + weight * n * n);
+  return bound < static_cast<double>(NumericTraits<IntType>::max()) / 2;
+}
+
+// number of lines transposed together by the tiled line access
+constexpr unsigned int ParabolicTileLines = 16;
+
+// fetch up to maxLines lines into buf. Element i of line t is stored
+// at buf[t * lineStride + i * elemStride]. When tiled is set, lines
+// that are neighbours in memory are gathered as tiles, so that each
+// image row is read contiguously. Returns the number of lines read.
+template <typename TIter, typename RealType>
+unsigned int
+ReadLineGroup(TIter &      iterator,
+              RealType *   buf,
+              unsigned int maxLines,
+              size_t       lineStride,
+              size_t       elemStride,
+              const bool   tiled)
+{
+  unsigned int count = 0;
+  while (count < maxLines && !iterator.IsAtEnd())
+  {
+    const unsigned int width = tiled ? iterator.GetTileWidth(maxLines - count) : 1;
+    if (width > 1)
+    {
+      iterator.GetTile(buf + count * lineStride, width, lineStride, elemStride);
+    }
+    else
+    {
+      iterator.GetLine(buf + count * lineStride, elemStride);
+    }
+    for (unsigned int t = 0; t < width; t++)
+    {
+      iterator.NextLine();
+    }
+    count += width;
+  }
+  return count;
+}
+
+// inverse of ReadLineGroup
+template <typename TIter, typename RealType>
+void
+WriteLineGroup(TIter &          iterator,
+               const RealType * buf,
+               unsigned int     numberOfLines,
+               size_t           lineStride,
+               size_t           elemStride,
+               const bool       tiled)
+{
+  unsigned int count = 0;
+  while (count < numberOfLines && !iterator.IsAtEnd())
+  {
+    const unsigned int width = tiled ? iterator.GetTileWidth(numberOfLines - count) : 1;
+    if (width > 1)
+    {
+      iterator.SetTile(buf + count * lineStride, width, lineStride, elemStride);
+    }
+    else
+    {
+      iterator.SetLine(buf + count * lineStride, elemStride);
+    }
+    for (unsigned int t = 0; t < width; t++)
+    {
+      iterator.NextLine();
+    }
+    count += width;
+  }
+}
+
+// time the contact point and intersection kernels on a sample of the
+// lines and return the faster one. The winner is cached by
+// ParabolicAutoTuneCache for this pixel type, scale, line length and
+// direction, so later calls, and later runs, don't repeat the timing.
+template <typename TIter, typename RealType, typename TInputPixel, bool doDilate>
+int
+ParabolicAutoTune(TIter &        iterator,
+                  const long     LineLength,
+                  const unsigned direction,
+                  const RealType magnitudeCP,
+                  const RealType magnitudeInt)
+{
+  // number of lines timed and number of repeats
+  constexpr unsigned int SampleLines = 16;
+  constexpr int          Repeats = 3;
+
+  using LineBufferType = typename itk::Array<RealType>;
+  using IndexBufferType = typename itk::Array<int>;
+
+  // scales are bucketed in half octaves
+  std::ostringstream key;
+  key << typeid(TInputPixel).name() << ":" << typeid(RealType).name() << ":" << (doDilate ? "dilate" : "erode")
+      << ":s" << Math::Round<long>(2.0 * std::log2(static_cast<double>(magnitudeInt))) << ":n" << LineLength
+      << ":d" << direction << ":simd" << GetParabolicSIMDLevel();
+  const int cached = ParabolicAutoTuneCache::Find(key.str());
+  if (cached >= 0)
+  {
+    return cached;
+  }
+
+  LineBufferType samples(LineLength * SampleLines);
+  iterator.SetDirection(direction);
+  iterator.GoToBegin();
+  const unsigned int lines = ReadLineGroup(iterator, samples.data_block(), SampleLines, LineLength, 1, false);
+  iterator.GoToBegin();
+  if (lines == 0)
+  {
+    return ParabolicMorphologyEnums::INTERSECTION;
+  }
+
+  static constexpr RealType extreme =
+    doDilate ? NumericTraits<TInputPixel>::NonpositiveMin() : NumericTraits<TInputPixel>::max();
+  const unsigned int lanes = GetParabolicBundleLanes<RealType>();
+  const unsigned int cpLanes = GetParabolicCPLanes<RealType>();
+
+  LineBufferType  work(LineLength * SampleLines + cpLanes);
+  LineBufferType  tmpLineBuf(LineLength + cpLanes);
+  LineBufferType  Fbuf(LineLength);
+  IndexBufferType Vbuf(LineLength);
+  LineBufferType  Zbuf(LineLength + 1);
+  LineBufferType  BundleBuf(LineLength * lanes);
+  LineBufferType  BundleF(LineLength * lanes);
+  LineBufferType  BundleV(LineLength * lanes);
+  LineBufferType  BundleZ((LineLength + 1) * lanes);
+  work.Fill(0);
+  tmpLineBuf.Fill(0);
+
+  // the same kernel choices as doOneDimension makes
+  auto runCP = [&]() {
+    for (unsigned int l = 0; l < lines; l++)
+    {
+      LineBufferType LineBuf(work.data_block() + l * LineLength, LineLength, false);
+      const long     kmax = ParabolicContactWindow(LineBuf, LineLength, magnitudeCP);
+      if (cpLanes > 0 && kmax >= 4 * static_cast<long>(cpLanes))
+      {
+        DoLineCPVector<RealType, doDilate>(
+          LineBuf.data_block(), tmpLineBuf.data_block(), LineLength, magnitudeCP, extreme, kmax);
+      }
+      else
+      {
+        DoLineCP<LineBufferType, RealType, TInputPixel, doDilate>(LineBuf, tmpLineBuf, magnitudeCP, kmax);
+      }
+    }
+  };
+  auto runIntersection = [&]() {
+    if (lanes > 0)
+    {
+      for (unsigned int first = 0; first < lines; first += lanes)
+      {
+        for (unsigned int l = 0; l < lanes; l++)
+        {
+          const RealType * line = work.data_block() + std::min(first + l, lines - 1) * LineLength;
+          for (long i = 0; i < LineLength; i++)
+          {
+            BundleBuf[i * lanes + l] = line[i];
+          }
+        }
+        DoLineIntAlgBundle<RealType, doDilate>(BundleBuf.data_block(),
+                                               BundleF.data_block(),
+                                               BundleV.data_block(),
+                                               BundleZ.data_block(),
+                                               static_cast<size_t>(LineLength),
+                                               magnitudeInt);
+      }
+    }
+    else
+    {
+      for (unsigned int l = 0; l < lines; l++)
+      {
+        LineBufferType LineBuf(work.data_block() + l * LineLength, LineLength, false);
+        DoLineIntAlg<LineBufferType, IndexBufferType, LineBufferType, RealType, doDilate>(
+          LineBuf, Fbuf, Vbuf, Zbuf, magnitudeInt);
+      }
+    }
+  };
+
+  double bestCP = NumericTraits<double>::max();
+  double bestIntersection = NumericTraits<double>::max();
+  for (int r = 0; r < Repeats; r++)
+  {
+    std::copy(samples.data_block(), samples.data_block() + lines * LineLength, work.data_block());
+    auto start = std::chrono::steady_clock::now();
+    runCP();
+    auto stop = std::chrono::steady_clock::now();
+    bestCP = std::min(bestCP, std::chrono::duration<double>(stop - start).count());
+
+    std::copy(samples.data_block(), samples.data_block() + lines * LineLength, work.data_block());
+    start = std::chrono::steady_clock::now();
+    runIntersection();
+    stop = std::chrono::steady_clock::now();
+    bestIntersection = std::min(bestIntersection, std::chrono::duration<double>(stop - start).count());
+  }
+
+  const int choice =
+    (bestCP < bestIntersection) ? ParabolicMorphologyEnums::CONTACTPOINT : ParabolicMorphologyEnums::INTERSECTION;
+  ParabolicAutoTuneCache::Insert(key.str(), choice);
+  return choice;
+}
+
+// scratch space taken by the passes other than doOneDimension, for
+// lines of length L read in groups of groupSize
+template <typename RealType, typename FeatureType>
+size_t
+ParabolicFeatureScratchBytes(const size_t L, const size_t groupSize)
+{
+  using Arena = ParabolicScratchArena;
+  const size_t G = L * groupSize;
+  return Arena::Bytes<RealType>(G) + Arena::Bytes<FeatureType>(G) + Arena::Bytes<FeatureType>(L) +
+         2 * Arena::Bytes<RealType>(L + 1) + 2 * Arena::Bytes<int>(L) + 3 * Arena::Bytes<long long>(L + 1);
+}
+
+template <typename RealType>
+size_t
+ParabolicSignedScratchBytes(const size_t L, const size_t groupSize)
+{
+  using Arena = ParabolicScratchArena;
+  const size_t G = L * groupSize;
+  return Arena::Bytes<RealType>(G) + 2 * Arena::Bytes<RealType>(L) + 2 * Arena::Bytes<RealType>(L + 1) +
+         Arena::Bytes<int>(L) + 3 * Arena::Bytes<long long>(L + 1);
+}
+
+template <typename RealType>
+size_t
+ParabolicSharpenScratchBytes(const size_t L, const size_t groupSize)
+{
+  using Arena = ParabolicScratchArena;
+  const size_t G = L * groupSize;
+  return 3 * Arena::Bytes<RealType>(G) + 2 * Arena::Bytes<RealType>(L + 1) + Arena::Bytes<int>(L);
+}
+
+// L includes the virtual border, and cpLanes is the padding of the
+// vector contact point kernel, if it is used
+template <typename RealType>
+size_t
+ParabolicBorderScratchBytes(const size_t L, const size_t groupSize, const size_t cpLanes)
+{
+  using Arena = ParabolicScratchArena;
+  const size_t G = L * groupSize + cpLanes;
+  return Arena::Bytes<RealType>(G) + Arena::Bytes<RealType>(L + cpLanes) + 2 * Arena::Bytes<RealType>(L + 1) +
+         Arena::Bytes<int>(L) + 3 * Arena::Bytes<int>(L + 1) + 3 * Arena::Bytes<long long>(L + 1);
+}
+
+// scratch space any of the passes needs for lines of the given
+// length, whatever the algorithm and execution mode. For the border
+// passes of openings and closings the length includes the virtual
+// border. For pre-reserving with ParabolicScratchArena::Reserve.
+template <typename RealType, typename FeatureType = OffsetValueType>
+size_t
+ParabolicScratchBytes(const size_t LineLength)
+{
+  using Arena = ParabolicScratchArena;
+  const size_t L = LineLength;
+  const size_t G = L * ParabolicTileLines;
+  const size_t lanes = GetParabolicBundleLanes<RealType>();
+  const size_t cpLanes = GetParabolicCPLanes<RealType>();
+
+  const size_t integer =
+    Arena::Bytes<RealType>(G) + 4 * Arena::Bytes<int>(L + 1) + 3 * Arena::Bytes<long long>(L + 1);
+  const size_t contact = Arena::Bytes<RealType>(G + cpLanes) + Arena::Bytes<RealType>(L + cpLanes);
+  const size_t intersection = Arena::Bytes<RealType>(G) + 2 * Arena::Bytes<RealType>(L + 1) + Arena::Bytes<int>(L);
+  const size_t bundle = 3 * Arena::Bytes<RealType>(L * lanes) + Arena::Bytes<RealType>((L + 1) * lanes);
+  const size_t others = std::max(std::max(ParabolicFeatureScratchBytes<RealType, FeatureType>(L, ParabolicTileLines),
+                                          ParabolicSignedScratchBytes<RealType>(L, ParabolicTileLines)),
+                                 std::max(ParabolicSharpenScratchBytes<RealType>(L, ParabolicTileLines),
+                                          ParabolicBorderScratchBytes<RealType>(L, ParabolicTileLines, cpLanes)));
+  return std::max(std::max(std::max(integer, contact), std::max(intersection, bundle)), others);
+}
+
+// process all lines of one dimension. The iterators are
+// ParabolicLineAccessor objects (or anything with the same
+// GetLine/SetLine/NextLine interface), which also cast to the
+// output pixel type. With tiled set, groups of neighbouring lines
+// are transposed into a contiguous scratch block before processing.
+// A clampValue other than the default limits the output to the band
+// below it (erosion) or above it (dilation), see DoLineIntAlg. The
+// intersection algorithms are then used.
+// Returns the number of lines that were constant, and so skipped.
 template <typename TInIter,
           typename TOutIter,
           typename RealType,
           typename TInputPixel,
           typename OutputPixelType,
           bool doDilate>
-void
+size_t
 doOneDimension(TInIter &          inputIterator,
                TOutIter &         outputIterator,
                ProgressReporter & progress,
@@ -194,14 +815,16 @@ doOneDimension(TInIter &          inputIterator,
                const bool         m_UseImageSpacing,
                const RealType     image_scale,
                const RealType     Sigma,
-               int                ParabolicAlgorithmChoice)
+               int                ParabolicAlgorithmChoice,
+               const bool         tiled = false,
+               const RealType     clampValue = ParabolicNoClamp<doDilate, RealType>())
 {
-  enum ParabolicAlgorithm
+  const bool banded = clampValue != ParabolicNoClamp<doDilate, RealType>();
+  size_t     skipped = 0;
+  if (banded && ParabolicAlgorithmChoice != ParabolicMorphologyEnums::INTEGERINTERSECTION)
   {
-    NOCHOICE = 0,     // decices based on scale - experimental
-    CONTACTPOINT = 1, // sometimes faster at low scale
-    INTERSECTION = 2  // default
-  };
+    ParabolicAlgorithmChoice = ParabolicMorphologyEnums::INTERSECTION;
+  }
 
   //  using LineBufferType = typename std::vector<RealType>;
 
@@ -213,20 +836,119 @@ doOneDimension(TInIter &          inputIterator,
   {
     iscale = image_scale;
   }
-  if (ParabolicAlgorithmChoice == NOCHOICE)
+  if (ParabolicAlgorithmChoice == ParabolicMorphologyEnums::NOCHOICE)
   {
     // both set to true or false - use scale to figure it out
     if ((2.0 * Sigma) < 0.2)
     {
-      ParabolicAlgorithmChoice = CONTACTPOINT;
+      ParabolicAlgorithmChoice = ParabolicMorphologyEnums::CONTACTPOINT;
     }
     else
     {
-      ParabolicAlgorithmChoice = INTERSECTION;
+      ParabolicAlgorithmChoice = ParabolicMorphologyEnums::INTERSECTION;
+    }
+  }
+
+  if (ParabolicAlgorithmChoice == ParabolicMorphologyEnums::AUTOTUNE)
+  {
+    constexpr int  magnitudeSign = doDilate ? 1 : -1;
+    const RealType magnitudeCP = (magnitudeSign * iscale * iscale) / (2.0 * Sigma);
+    const RealType magnitudeInt = (iscale * iscale) / (2.0 * Sigma);
+    ParabolicAlgorithmChoice = ParabolicAutoTune<TInIter, RealType, TInputPixel, doDilate>(
+      inputIterator, LineLength, direction, magnitudeCP, magnitudeInt);
+  }
+
+  if (ParabolicAlgorithmChoice == ParabolicMorphologyEnums::INTEGERINTERSECTION)
+  {
+    // the integer kernel needs a whole number parabola weight,
+    // otherwise use the floating point version
+    const double weight = static_cast<double>(iscale * iscale) / (2.0 * static_cast<double>(Sigma));
+    if (weight != std::floor(weight))
+    {
+      ParabolicAlgorithmChoice = ParabolicMorphologyEnums::INTERSECTION;
     }
   }
 
-  if (ParabolicAlgorithmChoice == CONTACTPOINT)
+  if (ParabolicAlgorithmChoice == ParabolicMorphologyEnums::INTEGERINTERSECTION)
+  {
+    // exact integer intersection algorithm. Lines that could overflow
+    // 32 bit arithmetic use 64 bits.
+    using Int32BufferType = typename itk::Array<int>;
+    using Int64BufferType = typename itk::Array<long long>;
+    using IndexBufferType = typename itk::Array<int>;
+
+    const long long weight =
+      Math::Round<long long>(static_cast<double>(iscale * iscale) / (2.0 * static_cast<double>(Sigma)));
+    const unsigned int groupSize = tiled ? ParabolicTileLines : 1;
+    const size_t       L = LineLength;
+    const size_t       G = L * groupSize;
+
+    ParabolicScratchArena::Scratch scratch(ParabolicScratchArena::Bytes<RealType>(G) +
+                                           4 * ParabolicScratchArena::Bytes<int>(L + 1) +
+                                           3 * ParabolicScratchArena::Bytes<long long>(L + 1));
+    LineBufferType                 GroupBuf(scratch.Take<RealType>(G), G, false);
+    IndexBufferType                Vbuf(scratch.Take<int>(L), L, false);
+    Int32BufferType                G32(scratch.Take<int>(L), L, false);
+    Int32BufferType                zNum32(scratch.Take<int>(L + 1), L + 1, false);
+    Int32BufferType                zDen32(scratch.Take<int>(L + 1), L + 1, false);
+    Int64BufferType                G64(scratch.Take<long long>(L), L, false);
+    Int64BufferType                zNum64(scratch.Take<long long>(L + 1), L + 1, false);
+    Int64BufferType                zDen64(scratch.Take<long long>(L + 1), L + 1, false);
+
+    inputIterator.SetDirection(direction);
+    outputIterator.SetDirection(direction);
+    inputIterator.GoToBegin();
+    outputIterator.GoToBegin();
+
+    while (!inputIterator.IsAtEnd() && !outputIterator.IsAtEnd())
+    {
+      const unsigned int lines =
+        ReadLineGroup(inputIterator, GroupBuf.data_block(), groupSize, LineLength, 1, tiled);
+      for (unsigned int l = 0; l < lines; l++)
+      {
+        LineBufferType LineBuf(GroupBuf.data_block() + l * LineLength, LineLength, false);
+        if (ParabolicConstantLine<doDilate>(LineBuf.data_block(), LineLength, 1, banded, clampValue))
+        {
+          ++skipped;
+          continue;
+        }
+        double maxAbs = 0;
+        for (long i = 0; i < LineLength; i++)
+        {
+          maxAbs = std::max(maxAbs, std::abs(static_cast<double>(LineBuf[i])));
+        }
+        if (banded)
+        {
+          if (ParabolicIntegerKernelFits<int>(maxAbs, weight, LineLength))
+          {
+            DoLineIntAlgInteger<LineBufferType, IndexBufferType, Int32BufferType, int, doDilate, true>(
+              LineBuf, G32, Vbuf, zNum32, zDen32, static_cast<int>(weight), nullptr, clampValue);
+          }
+          else
+          {
+            DoLineIntAlgInteger<LineBufferType, IndexBufferType, Int64BufferType, long long, doDilate, true>(
+              LineBuf, G64, Vbuf, zNum64, zDen64, weight, nullptr, clampValue);
+          }
+        }
+        else if (ParabolicIntegerKernelFits<int>(maxAbs, weight, LineLength))
+        {
+          DoLineIntAlgInteger<LineBufferType, IndexBufferType, Int32BufferType, int, doDilate>(
+            LineBuf, G32, Vbuf, zNum32, zDen32, static_cast<int>(weight));
+        }
+        else
+        {
+          DoLineIntAlgInteger<LineBufferType, IndexBufferType, Int64BufferType, long long, doDilate>(
+            LineBuf, G64, Vbuf, zNum64, zDen64, weight);
+        }
+      }
+      WriteLineGroup(outputIterator, GroupBuf.data_block(), lines, LineLength, 1, tiled);
+      for (unsigned int l = 0; l < lines; l++)
+      {
+        progress.CompletedPixel();
+      }
+    }
+  }
+  else if (ParabolicAlgorithmChoice == ParabolicMorphologyEnums::CONTACTPOINT)
   {
     // using the contact point algorithm
 
@@ -236,41 +958,59 @@ doOneDimension(TInIter &          inputIterator,
     constexpr int  magnitudeSign = doDilate ? 1 : -1;
     const RealType magnitudeCP = (magnitudeSign * iscale * iscale) / (2.0 * Sigma);
 
-    LineBufferType LineBuf(LineLength);
-    LineBufferType tmpLineBuf(LineLength);
+    // the vector kernel reads up to a vector beyond the end of a line
+    const unsigned int cpLanes = GetParabolicCPLanes<RealType>();
+    const unsigned int groupSize = tiled ? ParabolicTileLines : 1;
+    const size_t       G = LineLength * groupSize + cpLanes;
+    const size_t       T = LineLength + cpLanes;
+
+    ParabolicScratchArena::Scratch scratch(ParabolicScratchArena::Bytes<RealType>(G) +
+                                           ParabolicScratchArena::Bytes<RealType>(T));
+    LineBufferType                 GroupBuf(scratch.Take<RealType>(G), G, false);
+    LineBufferType                 tmpLineBuf(scratch.Take<RealType>(T), T, false);
+    GroupBuf.Fill(0);
+    tmpLineBuf.Fill(0);
     inputIterator.SetDirection(direction);
     outputIterator.SetDirection(direction);
     inputIterator.GoToBegin();
     outputIterator.GoToBegin();
 
-    unsigned count = 0;
+    static constexpr RealType extreme =
+      doDilate ? NumericTraits<TInputPixel>::NonpositiveMin() : NumericTraits<TInputPixel>::max();
+
     while (!inputIterator.IsAtEnd() && !outputIterator.IsAtEnd())
     {
       // process this direction
-      // fetch the line into the buffer - this methodology is like
+      // fetch the lines into the buffer - this methodology is like
       // the gaussian filters
-
-      unsigned int i = 0;
-      while (!inputIterator.IsAtEndOfLine())
+      const unsigned int lines =
+        ReadLineGroup(inputIterator, GroupBuf.data_block(), groupSize, LineLength, 1, tiled);
+      for (unsigned int l = 0; l < lines; l++)
       {
-        LineBuf[i++] = static_cast<RealType>(inputIterator.Get());
-        ++inputIterator;
+        LineBufferType LineBuf(GroupBuf.data_block() + l * LineLength, LineLength, false);
+        if (ParabolicConstantLine<doDilate>(LineBuf.data_block(), LineLength, 1, false, clampValue))
+        {
+          ++skipped;
+          continue;
+        }
+        const long kmax = ParabolicContactWindow(LineBuf, LineLength, magnitudeCP);
+        // the vector search only pays off when the window can be long
+        if (cpLanes > 0 && kmax >= 4 * static_cast<long>(cpLanes))
+        {
+          DoLineCPVector<RealType, doDilate>(
+            LineBuf.data_block(), tmpLineBuf.data_block(), LineLength, magnitudeCP, extreme, kmax);
+        }
+        else
+        {
+          DoLineCP<LineBufferType, RealType, TInputPixel, doDilate>(LineBuf, tmpLineBuf, magnitudeCP, kmax);
+        }
       }
-
-      DoLineCP<LineBufferType, RealType, TInputPixel, doDilate>(LineBuf, tmpLineBuf, magnitudeCP);
-      // copy the line back
-      unsigned int j = 0;
-      while (!outputIterator.IsAtEndOfLine())
+      // copy the lines back
+      WriteLineGroup(outputIterator, GroupBuf.data_block(), lines, LineLength, 1, tiled);
+      for (unsigned int l = 0; l < lines; l++)
       {
-        outputIterator.Set(static_cast<OutputPixelType>(LineBuf[j++]));
-        ++outputIterator;
+        progress.CompletedPixel();
       }
-
-      ++count;
-      // now onto the next line
-      inputIterator.NextLine();
-      outputIterator.NextLine();
-      progress.CompletedPixel();
     }
   }
   else
@@ -278,47 +1018,715 @@ doOneDimension(TInIter &          inputIterator,
     // using the Intersection algorithm
     using IndexBufferType = typename itk::Array<int>;
 
-    const RealType  magnitudeInt = (iscale * iscale) / (2.0 * Sigma);
-    LineBufferType  LineBuf(LineLength);
-    LineBufferType  Fbuf(LineLength);
-    IndexBufferType Vbuf(LineLength);
-    LineBufferType  Zbuf(LineLength + 1);
+    const RealType magnitudeInt = (iscale * iscale) / (2.0 * Sigma);
 
     inputIterator.SetDirection(direction);
     outputIterator.SetDirection(direction);
     inputIterator.GoToBegin();
     outputIterator.GoToBegin();
 
-    unsigned count = 0;
+    // the bundled kernel doesn't clamp
+    const unsigned int lanes = banded ? 0 : GetParabolicBundleLanes<RealType>();
+    if (lanes > 0)
+    {
+      // process several lines in lockstep, one per vector lane. The
+      // buffers are interleaved, with element i of lane l at
+      // i * lanes + l.
+      const size_t B = LineLength * lanes;
+      const size_t BZ = (LineLength + 1) * lanes;
+
+      ParabolicScratchArena::Scratch scratch(3 * ParabolicScratchArena::Bytes<RealType>(B) +
+                                             ParabolicScratchArena::Bytes<RealType>(BZ));
+      LineBufferType                 BundleBuf(scratch.Take<RealType>(B), B, false);
+      LineBufferType                 BundleF(scratch.Take<RealType>(B), B, false);
+      LineBufferType                 BundleV(scratch.Take<RealType>(B), B, false);
+      LineBufferType                 BundleZ(scratch.Take<RealType>(BZ), BZ, false);
+
+      while (!inputIterator.IsAtEnd() && !outputIterator.IsAtEnd())
+      {
+        const unsigned int filled = ReadLineGroup(inputIterator, BundleBuf.data_block(), lanes, 1, lanes, tiled);
+        // the lanes are processed together, so the bundle is only
+        // skipped when all of its lines are constant
+        unsigned int constant = 0;
+        while (constant < filled &&
+               ParabolicConstantLine<doDilate>(BundleBuf.data_block() + constant, LineLength, lanes, false, clampValue))
+        {
+          ++constant;
+        }
+        if (constant == filled)
+        {
+          skipped += filled;
+        }
+        else
+        {
+          // a partial bundle at the end - duplicate the first line into
+          // the unused lanes
+          for (unsigned int l = filled; l < lanes; l++)
+          {
+            for (long i = 0; i < LineLength; i++)
+            {
+              BundleBuf[i * lanes + l] = BundleBuf[i * lanes];
+            }
+          }
+          DoLineIntAlgBundle<RealType, doDilate>(BundleBuf.data_block(),
+                                                 BundleF.data_block(),
+                                                 BundleV.data_block(),
+                                                 BundleZ.data_block(),
+                                                 static_cast<size_t>(LineLength),
+                                                 magnitudeInt);
+        }
+        WriteLineGroup(outputIterator, BundleBuf.data_block(), filled, 1, lanes, tiled);
+        for (unsigned int l = 0; l < filled; l++)
+        {
+          progress.CompletedPixel();
+        }
+      }
+      return skipped;
+    }
+
+    const unsigned int groupSize = tiled ? ParabolicTileLines : 1;
+    const size_t       L = LineLength;
+    const size_t       G = L * groupSize;
+
+    ParabolicScratchArena::Scratch scratch(ParabolicScratchArena::Bytes<RealType>(G) +
+                                           2 * ParabolicScratchArena::Bytes<RealType>(L + 1) +
+                                           ParabolicScratchArena::Bytes<int>(L));
+    LineBufferType                 GroupBuf(scratch.Take<RealType>(G), G, false);
+    LineBufferType                 Fbuf(scratch.Take<RealType>(L), L, false);
+    IndexBufferType                Vbuf(scratch.Take<int>(L), L, false);
+    LineBufferType                 Zbuf(scratch.Take<RealType>(L + 1), L + 1, false);
     while (!inputIterator.IsAtEnd() && !outputIterator.IsAtEnd())
     {
       // process this direction
-      // fetch the line into the buffer - this methodology is like
+      // fetch the lines into the buffer - this methodology is like
       // the gaussian filters
+      const unsigned int lines =
+        ReadLineGroup(inputIterator, GroupBuf.data_block(), groupSize, LineLength, 1, tiled);
+      for (unsigned int l = 0; l < lines; l++)
+      {
+        LineBufferType LineBuf(GroupBuf.data_block() + l * LineLength, LineLength, false);
+        if (ParabolicConstantLine<doDilate>(LineBuf.data_block(), LineLength, 1, banded, clampValue))
+        {
+          ++skipped;
+        }
+        else if (banded)
+        {
+          DoLineIntAlg<LineBufferType, IndexBufferType, LineBufferType, RealType, doDilate, true>(
+            LineBuf, Fbuf, Vbuf, Zbuf, magnitudeInt, nullptr, clampValue);
+        }
+        else
+        {
+          DoLineIntAlg<LineBufferType, IndexBufferType, LineBufferType, RealType, doDilate>(
+            LineBuf, Fbuf, Vbuf, Zbuf, magnitudeInt);
+        }
+      }
+      // copy the lines back
+      WriteLineGroup(outputIterator, GroupBuf.data_block(), lines, LineLength, 1, tiled);
+      for (unsigned int l = 0; l < lines; l++)
+      {
+        progress.CompletedPixel();
+      }
+    }
+  }
+  return skipped;
+}
+
+// as doOneDimension, also carrying a feature image through the
+// pass. Each output value comes from the parabola of one position on
+// the line, and the feature (e.g. a pixel offset) held at that
+// position is propagated to the output position. The feature
+// iterators read and write the same image, like the input and
+// output iterators of the passes after the first. Only the
+// intersection algorithms know the source positions, so other
+// choices use INTERSECTION. Constant lines keep their features, and
+// their number is returned.
+template <typename TInIter,
+          typename TOutIter,
+          typename TFeatureInIter,
+          typename TFeatureOutIter,
+          typename RealType,
+          bool doDilate>
+size_t
+doOneDimensionFeature(TInIter &          inputIterator,
+                      TOutIter &         outputIterator,
+                      TFeatureInIter &   featureInputIterator,
+                      TFeatureOutIter &  featureOutputIterator,
+                      ProgressReporter & progress,
+                      const long         LineLength,
+                      const unsigned     direction,
+                      const bool         m_UseImageSpacing,
+                      const RealType     image_scale,
+                      const RealType     Sigma,
+                      int                ParabolicAlgorithmChoice,
+                      const bool         tiled = false)
+{
+  using LineBufferType = typename itk::Array<RealType>;
+  using IndexBufferType = typename itk::Array<int>;
+  using Int64BufferType = typename itk::Array<long long>;
+  using FeatureType = typename TFeatureOutIter::PixelType;
 
-      unsigned int i = 0;
-      while (!inputIterator.IsAtEndOfLine())
+  RealType iscale = 1.0;
+  if (m_UseImageSpacing)
+  {
+    iscale = image_scale;
+  }
+  const RealType magnitudeInt = (iscale * iscale) / (2.0 * Sigma);
+  const double   weight = static_cast<double>(iscale * iscale) / (2.0 * static_cast<double>(Sigma));
+  const bool     integer =
+    (ParabolicAlgorithmChoice == ParabolicMorphologyEnums::INTEGERINTERSECTION) && (weight == std::floor(weight));
+
+  using Arena = ParabolicScratchArena;
+  const unsigned int groupSize = tiled ? ParabolicTileLines : 1;
+  const size_t       L = LineLength;
+  const size_t       G = L * groupSize;
+
+  Arena::Scratch  scratch(ParabolicFeatureScratchBytes<RealType, FeatureType>(L, groupSize));
+  LineBufferType  GroupBuf(scratch.Take<RealType>(G), G, false);
+  FeatureType *   FeatureBuf = scratch.Take<FeatureType>(G);
+  FeatureType *   LineFeatures = scratch.Take<FeatureType>(L);
+  LineBufferType  Fbuf(scratch.Take<RealType>(L), L, false);
+  LineBufferType  Zbuf(scratch.Take<RealType>(L + 1), L + 1, false);
+  IndexBufferType Vbuf(scratch.Take<int>(L), L, false);
+  int *           Argmin = scratch.Take<int>(L);
+  Int64BufferType G64(scratch.Take<long long>(L), L, false);
+  Int64BufferType zNum64(scratch.Take<long long>(L + 1), L + 1, false);
+  Int64BufferType zDen64(scratch.Take<long long>(L + 1), L + 1, false);
+
+  inputIterator.SetDirection(direction);
+  outputIterator.SetDirection(direction);
+  featureInputIterator.SetDirection(direction);
+  featureOutputIterator.SetDirection(direction);
+  inputIterator.GoToBegin();
+  outputIterator.GoToBegin();
+  featureInputIterator.GoToBegin();
+  featureOutputIterator.GoToBegin();
+
+  size_t skipped = 0;
+  while (!inputIterator.IsAtEnd() && !outputIterator.IsAtEnd())
+  {
+    const unsigned int lines = ReadLineGroup(inputIterator, GroupBuf.data_block(), groupSize, LineLength, 1, tiled);
+    ReadLineGroup(featureInputIterator, FeatureBuf, lines, LineLength, 1, tiled);
+    for (unsigned int l = 0; l < lines; l++)
+    {
+      LineBufferType LineBuf(GroupBuf.data_block() + l * LineLength, LineLength, false);
+      if (ParabolicConstantLine<doDilate>(LineBuf.data_block(), LineLength, 1, false, RealType()))
       {
-        LineBuf[i++] = static_cast<RealType>(inputIterator.Get());
-        ++inputIterator;
+        ++skipped;
+        continue;
       }
-      DoLineIntAlg<LineBufferType, IndexBufferType, LineBufferType, RealType, doDilate>(
-        LineBuf, Fbuf, Vbuf, Zbuf, magnitudeInt);
-      // copy the line back
-      unsigned int j = 0;
-      while (!outputIterator.IsAtEndOfLine())
+      double maxAbs = 0;
+      if (integer)
+      {
+        for (long i = 0; i < LineLength; i++)
+        {
+          maxAbs = std::max(maxAbs, std::abs(static_cast<double>(LineBuf[i])));
+        }
+      }
+      if (integer && ParabolicIntegerKernelFits<long long>(maxAbs, weight, LineLength))
+      {
+        DoLineIntAlgInteger<LineBufferType, IndexBufferType, Int64BufferType, long long, doDilate>(
+          LineBuf, G64, Vbuf, zNum64, zDen64, static_cast<long long>(weight), Argmin);
+      }
+      else
+      {
+        DoLineIntAlg<LineBufferType, IndexBufferType, LineBufferType, RealType, doDilate>(
+          LineBuf, Fbuf, Vbuf, Zbuf, magnitudeInt, Argmin);
+      }
+      // propagate the features of the winning positions
+      FeatureType * features = FeatureBuf + l * LineLength;
+      std::copy(features, features + LineLength, LineFeatures);
+      for (long i = 0; i < LineLength; i++)
+      {
+        features[i] = LineFeatures[Argmin[i]];
+      }
+    }
+    WriteLineGroup(outputIterator, GroupBuf.data_block(), lines, LineLength, 1, tiled);
+    WriteLineGroup(featureOutputIterator, FeatureBuf, lines, LineLength, 1, tiled);
+    for (unsigned int l = 0; l < lines; l++)
+    {
+      progress.CompletedPixel();
+    }
+  }
+  return skipped;
+}
+
+// erosion of a line of signed squared distances. Positive values
+// belong to one phase and are squared distances to the other phase,
+// negative values belong to the other phase and are negated squared
+// distances to the first. Each line is eroded as two envelopes, the
+// positive values with the negative ones as zero and the negated
+// negative values with the positive ones as zero, and every position
+// keeps the envelope of its own sign. This computes the distances of
+// both phases in one buffer, for signed distance transforms. Other
+// algorithm choices than INTEGERINTERSECTION use INTERSECTION.
+// Constant lines are skipped, and their number is returned.
+template <typename TInIter, typename TOutIter, typename RealType>
+size_t
+doOneDimensionSigned(TInIter &          inputIterator,
+                     TOutIter &         outputIterator,
+                     ProgressReporter & progress,
+                     const long         LineLength,
+                     const unsigned     direction,
+                     const bool         m_UseImageSpacing,
+                     const RealType     image_scale,
+                     const RealType     Sigma,
+                     int                ParabolicAlgorithmChoice,
+                     const bool         tiled = false)
+{
+  using LineBufferType = typename itk::Array<RealType>;
+  using IndexBufferType = typename itk::Array<int>;
+  using Int64BufferType = typename itk::Array<long long>;
+
+  RealType iscale = 1.0;
+  if (m_UseImageSpacing)
+  {
+    iscale = image_scale;
+  }
+  const RealType magnitudeInt = (iscale * iscale) / (2.0 * Sigma);
+  const double   weight = static_cast<double>(iscale * iscale) / (2.0 * static_cast<double>(Sigma));
+  const bool     integer =
+    (ParabolicAlgorithmChoice == ParabolicMorphologyEnums::INTEGERINTERSECTION) && (weight == std::floor(weight));
+
+  using Arena = ParabolicScratchArena;
+  const unsigned int groupSize = tiled ? ParabolicTileLines : 1;
+  const size_t       L = LineLength;
+  const size_t       G = L * groupSize;
+
+  Arena::Scratch  scratch(ParabolicSignedScratchBytes<RealType>(L, groupSize));
+  LineBufferType  GroupBuf(scratch.Take<RealType>(G), G, false);
+  LineBufferType  PositiveBuf(scratch.Take<RealType>(L), L, false);
+  LineBufferType  NegativeBuf(scratch.Take<RealType>(L), L, false);
+  LineBufferType  Fbuf(scratch.Take<RealType>(L), L, false);
+  LineBufferType  Zbuf(scratch.Take<RealType>(L + 1), L + 1, false);
+  IndexBufferType Vbuf(scratch.Take<int>(L), L, false);
+  Int64BufferType G64(scratch.Take<long long>(L), L, false);
+  Int64BufferType zNum64(scratch.Take<long long>(L + 1), L + 1, false);
+  Int64BufferType zDen64(scratch.Take<long long>(L + 1), L + 1, false);
+
+  auto erode = [&](LineBufferType & envelope, const double maxAbs) {
+    if (integer && ParabolicIntegerKernelFits<long long>(maxAbs, weight, LineLength))
+    {
+      DoLineIntAlgInteger<LineBufferType, IndexBufferType, Int64BufferType, long long, false>(
+        envelope, G64, Vbuf, zNum64, zDen64, static_cast<long long>(weight));
+    }
+    else
+    {
+      DoLineIntAlg<LineBufferType, IndexBufferType, LineBufferType, RealType, false>(
+        envelope, Fbuf, Vbuf, Zbuf, magnitudeInt);
+    }
+  };
+
+  inputIterator.SetDirection(direction);
+  outputIterator.SetDirection(direction);
+  inputIterator.GoToBegin();
+  outputIterator.GoToBegin();
+
+  size_t skipped = 0;
+  while (!inputIterator.IsAtEnd() && !outputIterator.IsAtEnd())
+  {
+    const unsigned int lines = ReadLineGroup(inputIterator, GroupBuf.data_block(), groupSize, LineLength, 1, tiled);
+    for (unsigned int l = 0; l < lines; l++)
+    {
+      RealType * line = GroupBuf.data_block() + l * LineLength;
+      if (ParabolicConstantLine<false>(line, LineLength, 1, false, RealType()))
+      {
+        ++skipped;
+        continue;
+      }
+      // split the phases, an envelope is only needed for a phase
+      // present on the line
+      double positiveMax = 0;
+      double negativeMax = 0;
+      for (long i = 0; i < LineLength; i++)
+      {
+        PositiveBuf[i] = std::max(line[i], RealType(0));
+        NegativeBuf[i] = std::max(-line[i], RealType(0));
+        positiveMax = std::max(positiveMax, static_cast<double>(PositiveBuf[i]));
+        negativeMax = std::max(negativeMax, static_cast<double>(NegativeBuf[i]));
+      }
+      if (positiveMax > 0)
+      {
+        erode(PositiveBuf, positiveMax);
+      }
+      if (negativeMax > 0)
+      {
+        erode(NegativeBuf, negativeMax);
+      }
+      for (long i = 0; i < LineLength; i++)
+      {
+        line[i] = (line[i] > 0) ? PositiveBuf[i] : -NegativeBuf[i];
+      }
+    }
+    WriteLineGroup(outputIterator, GroupBuf.data_block(), lines, LineLength, 1, tiled);
+    for (unsigned int l = 0; l < lines; l++)
+    {
+      progress.CompletedPixel();
+    }
+  }
+  return skipped;
+}
+
+// erosion and dilation of the same lines in one pass, for
+// morphological sharpening. Erosion lines are read from
+// erodeInputIterator and dilation lines from dilateInputIterator,
+// which can be the same accessor, in which case each line is read
+// once. The same goes for sourceIterator. Unless last is set, the
+// results go to erodeOutputIterator and dilateOutputIterator. On the
+// last pass the lines of sourceIterator, the image being sharpened,
+// are read as well and select(dilation, source, erosion), with all
+// three cast to the output pixel type, is written to
+// outputIterator. A Sigma of zero leaves the lines unchanged. Returns
+// the number of pixels the last pass changed, as output pixels.
+template <typename TErodeInIter,
+          typename TDilateInIter,
+          typename TErodeOutIter,
+          typename TDilateOutIter,
+          typename TSourceIter,
+          typename TOutIter,
+          typename RealType,
+          typename TSelect>
+size_t
+doOneDimensionSharpen(TErodeInIter &     erodeInputIterator,
+                      TDilateInIter &    dilateInputIterator,
+                      TErodeOutIter &    erodeOutputIterator,
+                      TDilateOutIter &   dilateOutputIterator,
+                      TSourceIter &      sourceIterator,
+                      TOutIter &         outputIterator,
+                      TSelect &          select,
+                      ProgressReporter & progress,
+                      const long         LineLength,
+                      const unsigned     direction,
+                      const bool         m_UseImageSpacing,
+                      const RealType     image_scale,
+                      const RealType     Sigma,
+                      const bool         last,
+                      const bool         tiled = false)
+{
+  using LineBufferType = typename itk::Array<RealType>;
+  using IndexBufferType = typename itk::Array<int>;
+  using OutputPixelType = typename TOutIter::PixelType;
+
+  RealType iscale = 1.0;
+  if (m_UseImageSpacing)
+  {
+    iscale = image_scale;
+  }
+  const bool     process = Sigma > 0;
+  const RealType magnitudeInt = process ? (iscale * iscale) / (2.0 * Sigma) : RealType(1);
+  const void *   erodeInput = &erodeInputIterator;
+  const bool     shared = (erodeInput == static_cast<const void *>(&dilateInputIterator));
+  const bool     sourceShared = (erodeInput == static_cast<const void *>(&sourceIterator));
+
+  using Arena = ParabolicScratchArena;
+  const unsigned int groupSize = tiled ? ParabolicTileLines : 1;
+  const size_t       L = LineLength;
+  const size_t       G = L * groupSize;
+
+  Arena::Scratch  scratch(ParabolicSharpenScratchBytes<RealType>(L, groupSize));
+  RealType *      ErodeBuf = scratch.Take<RealType>(G);
+  RealType *      DilateBuf = scratch.Take<RealType>(G);
+  RealType *      SourceBuf = scratch.Take<RealType>(G);
+  LineBufferType  Fbuf(scratch.Take<RealType>(L), L, false);
+  LineBufferType  Zbuf(scratch.Take<RealType>(L + 1), L + 1, false);
+  IndexBufferType Vbuf(scratch.Take<int>(L), L, false);
+
+  erodeInputIterator.SetDirection(direction);
+  dilateInputIterator.SetDirection(direction);
+  size_t changed = 0;
+  if (last)
+  {
+    sourceIterator.SetDirection(direction);
+    outputIterator.SetDirection(direction);
+  }
+  else
+  {
+    erodeOutputIterator.SetDirection(direction);
+    dilateOutputIterator.SetDirection(direction);
+  }
+
+  while (!erodeInputIterator.IsAtEnd())
+  {
+    const unsigned int lines = ReadLineGroup(erodeInputIterator, ErodeBuf, groupSize, LineLength, 1, tiled);
+    if (shared)
+    {
+      std::copy(ErodeBuf, ErodeBuf + lines * L, DilateBuf);
+    }
+    else
+    {
+      ReadLineGroup(dilateInputIterator, DilateBuf, lines, LineLength, 1, tiled);
+    }
+    if (last && sourceShared)
+    {
+      std::copy(ErodeBuf, ErodeBuf + lines * L, SourceBuf);
+    }
+    else if (last)
+    {
+      ReadLineGroup(sourceIterator, SourceBuf, lines, LineLength, 1, tiled);
+    }
+    for (unsigned int l = 0; l < lines && process; l++)
+    {
+      LineBufferType ErodeLine(ErodeBuf + l * L, L, false);
+      LineBufferType DilateLine(DilateBuf + l * L, L, false);
+      if (!ParabolicConstantLine<false>(ErodeLine.data_block(), LineLength, 1, false, RealType()))
+      {
+        DoLineIntAlg<LineBufferType, IndexBufferType, LineBufferType, RealType, false>(
+          ErodeLine, Fbuf, Vbuf, Zbuf, magnitudeInt);
+      }
+      if (!ParabolicConstantLine<true>(DilateLine.data_block(), LineLength, 1, false, RealType()))
       {
-        outputIterator.Set(static_cast<OutputPixelType>(LineBuf[j++]));
-        ++outputIterator;
+        DoLineIntAlg<LineBufferType, IndexBufferType, LineBufferType, RealType, true>(
+          DilateLine, Fbuf, Vbuf, Zbuf, magnitudeInt);
       }
+    }
+    if (last)
+    {
+      for (size_t i = 0; i < lines * L; i++)
+      {
+        const auto source = static_cast<OutputPixelType>(SourceBuf[i]);
+        const auto sharp = static_cast<OutputPixelType>(
+          select(static_cast<OutputPixelType>(DilateBuf[i]), source, static_cast<OutputPixelType>(ErodeBuf[i])));
+        changed += (sharp != source);
+        SourceBuf[i] = static_cast<RealType>(sharp);
+      }
+      WriteLineGroup(outputIterator, SourceBuf, lines, LineLength, 1, tiled);
+    }
+    else
+    {
+      WriteLineGroup(erodeOutputIterator, ErodeBuf, lines, LineLength, 1, tiled);
+      WriteLineGroup(dilateOutputIterator, DilateBuf, lines, LineLength, 1, tiled);
+    }
+    for (unsigned int l = 0; l < lines; l++)
+    {
+      progress.CompletedPixel();
+    }
+  }
+  return changed;
+}
 
-      ++count;
-      // now onto the next line
-      inputIterator.NextLine();
-      outputIterator.NextLine();
+// one pass along a direction on lines with virtual voxels at their
+// ends, optionally followed by the opposite operation, as in the
+// stage transition of openings and closings. Each line of LineLength
+// voxels is read into a buffer between borderLower and borderUpper
+// voxels of borderValue, processed and written from outputStart, for
+// the line length of the output iterator. So lines can grow into a
+// border or shrink out of it without the border being stored. When
+// fused is set the doDilate operation is followed by the opposite
+// one, with the values cast to OutputPixelType between them, as they
+// would be when stored. A zero Sigma only moves the lines. Algorithm
+// choices are as for doOneDimension, except that INTERSECTION uses
+// the scalar kernel and AUTOTUNE is decided by the first operation.
+// A clampValue other than the default limits the result of a single
+// operation, as for doOneDimension, but no lines are skipped for it.
+template <typename TInIter,
+          typename TOutIter,
+          typename RealType,
+          typename TInputPixel,
+          typename OutputPixelType,
+          bool doDilate,
+          bool fused>
+void
+doOneDimensionBorder(TInIter &          inputIterator,
+                     TOutIter &         outputIterator,
+                     ProgressReporter & progress,
+                     const long         LineLength,
+                     const unsigned     direction,
+                     const bool         m_UseImageSpacing,
+                     const RealType     image_scale,
+                     const RealType     Sigma,
+                     int                ParabolicAlgorithmChoice,
+                     const long         borderLower,
+                     const long         borderUpper,
+                     const RealType     borderValue,
+                     const long         outputStart,
+                     const bool         tiled = false,
+                     const RealType     clampValue = ParabolicNoClamp<doDilate, RealType>())
+{
+  using LineBufferType = typename itk::Array<RealType>;
+  using IndexBufferType = typename itk::Array<int>;
+  using Int32BufferType = typename itk::Array<int>;
+  using Int64BufferType = typename itk::Array<long long>;
+
+  const bool process = Sigma > 0;
+  const bool banded = clampValue != ParabolicNoClamp<doDilate, RealType>();
+  RealType   iscale = 1.0;
+  if (m_UseImageSpacing)
+  {
+    iscale = image_scale;
+  }
+  const RealType magnitudeInt = process ? (iscale * iscale) / (2.0 * Sigma) : RealType(0);
+  const RealType magnitudeCP = magnitudeInt;
+  const double   weight = process ? static_cast<double>(iscale * iscale) / (2.0 * static_cast<double>(Sigma)) : 0.0;
+
+  if (ParabolicAlgorithmChoice == ParabolicMorphologyEnums::NOCHOICE)
+  {
+    ParabolicAlgorithmChoice =
+      ((2.0 * Sigma) < 0.2) ? ParabolicMorphologyEnums::CONTACTPOINT : ParabolicMorphologyEnums::INTERSECTION;
+  }
+  if (process && ParabolicAlgorithmChoice == ParabolicMorphologyEnums::AUTOTUNE)
+  {
+    constexpr int magnitudeSign = doDilate ? 1 : -1;
+    ParabolicAlgorithmChoice = ParabolicAutoTune<TInIter, RealType, TInputPixel, doDilate>(
+      inputIterator, LineLength, direction, magnitudeSign * magnitudeCP, magnitudeInt);
+  }
+  if (ParabolicAlgorithmChoice == ParabolicMorphologyEnums::INTEGERINTERSECTION && weight != std::floor(weight))
+  {
+    ParabolicAlgorithmChoice = ParabolicMorphologyEnums::INTERSECTION;
+  }
+
+  // the vector contact point kernel reads up to a vector beyond the
+  // end of a line
+  const unsigned int cpLanes =
+    (ParabolicAlgorithmChoice == ParabolicMorphologyEnums::CONTACTPOINT) ? GetParabolicCPLanes<RealType>() : 0;
+  const unsigned int groupSize = tiled ? ParabolicTileLines : 1;
+  const long         N = borderLower + LineLength + borderUpper;
+  const size_t       L = N;
+  const size_t       G = L * groupSize + cpLanes;
+
+  using Arena = ParabolicScratchArena;
+  Arena::Scratch  scratch(ParabolicBorderScratchBytes<RealType>(L, groupSize, cpLanes));
+  LineBufferType  GroupBuf(scratch.Take<RealType>(G), G, false);
+  LineBufferType  tmpLineBuf(scratch.Take<RealType>(L + cpLanes), L + cpLanes, false);
+  LineBufferType  Fbuf(scratch.Take<RealType>(L), L, false);
+  LineBufferType  Zbuf(scratch.Take<RealType>(L + 1), L + 1, false);
+  IndexBufferType Vbuf(scratch.Take<int>(L), L, false);
+  Int32BufferType G32(scratch.Take<int>(L), L, false);
+  Int32BufferType zNum32(scratch.Take<int>(L + 1), L + 1, false);
+  Int32BufferType zDen32(scratch.Take<int>(L + 1), L + 1, false);
+  Int64BufferType G64(scratch.Take<long long>(L), L, false);
+  Int64BufferType zNum64(scratch.Take<long long>(L + 1), L + 1, false);
+  Int64BufferType zDen64(scratch.Take<long long>(L + 1), L + 1, false);
+  GroupBuf.Fill(0);
+  tmpLineBuf.Fill(0);
+
+  // one operation on one line, dilation when dilate is true
+  auto apply = [&](auto dilate, LineBufferType & LineBuf) {
+    constexpr bool dd = decltype(dilate)::value;
+    if (ParabolicConstantLine<dd>(LineBuf.data_block(), N, 1, false, RealType()))
+    {
+      return;
+    }
+    if (ParabolicAlgorithmChoice == ParabolicMorphologyEnums::INTEGERINTERSECTION)
+    {
+      double maxAbs = 0;
+      for (long i = 0; i < N; i++)
+      {
+        maxAbs = std::max(maxAbs, std::abs(static_cast<double>(LineBuf[i])));
+      }
+      const auto w = static_cast<long long>(weight);
+      if (ParabolicIntegerKernelFits<int>(maxAbs, weight, N))
+      {
+        DoLineIntAlgInteger<LineBufferType, IndexBufferType, Int32BufferType, int, dd>(
+          LineBuf, G32, Vbuf, zNum32, zDen32, static_cast<int>(w));
+      }
+      else
+      {
+        DoLineIntAlgInteger<LineBufferType, IndexBufferType, Int64BufferType, long long, dd>(
+          LineBuf, G64, Vbuf, zNum64, zDen64, w);
+      }
+    }
+    else if (ParabolicAlgorithmChoice == ParabolicMorphologyEnums::CONTACTPOINT)
+    {
+      static constexpr RealType extreme =
+        dd ? NumericTraits<TInputPixel>::NonpositiveMin() : NumericTraits<TInputPixel>::max();
+      const RealType magnitude = dd ? magnitudeCP : -magnitudeCP;
+      const long     kmax = ParabolicContactWindow(LineBuf, N, magnitude);
+      if (cpLanes > 0 && kmax >= 4 * static_cast<long>(cpLanes))
+      {
+        DoLineCPVector<RealType, dd>(LineBuf.data_block(), tmpLineBuf.data_block(), N, magnitude, extreme, kmax);
+      }
+      else
+      {
+        DoLineCP<LineBufferType, RealType, TInputPixel, dd>(LineBuf, tmpLineBuf, magnitude, kmax);
+      }
+    }
+    else
+    {
+      DoLineIntAlg<LineBufferType, IndexBufferType, LineBufferType, RealType, dd>(
+        LineBuf, Fbuf, Vbuf, Zbuf, magnitudeInt);
+    }
+  };
+
+  inputIterator.SetDirection(direction);
+  outputIterator.SetDirection(direction);
+  inputIterator.GoToBegin();
+  outputIterator.GoToBegin();
+
+  while (!inputIterator.IsAtEnd() && !outputIterator.IsAtEnd())
+  {
+    const unsigned int lines =
+      ReadLineGroup(inputIterator, GroupBuf.data_block() + borderLower, groupSize, N, 1, tiled);
+    for (unsigned int l = 0; l < lines; l++)
+    {
+      LineBufferType LineBuf(GroupBuf.data_block() + l * N, N, false);
+      std::fill(LineBuf.data_block(), LineBuf.data_block() + borderLower, borderValue);
+      std::fill(LineBuf.data_block() + borderLower + LineLength, LineBuf.data_block() + N, borderValue);
+      if (!process)
+      {
+        continue;
+      }
+      apply(std::integral_constant<bool, doDilate>(), LineBuf);
+      if (fused)
+      {
+        for (long i = 0; i < N; i++)
+        {
+          LineBuf[i] = static_cast<RealType>(static_cast<OutputPixelType>(LineBuf[i]));
+        }
+        apply(std::integral_constant<bool, !doDilate>(), LineBuf);
+      }
+      else if (banded)
+      {
+        for (long i = 0; i < N; i++)
+        {
+          LineBuf[i] = ParabolicClamp<doDilate, RealType>(LineBuf[i], clampValue);
+        }
+      }
+    }
+    WriteLineGroup(outputIterator, GroupBuf.data_block() + outputStart, lines, N, 1, tiled);
+    for (unsigned int l = 0; l < lines; l++)
+    {
       progress.CompletedPixel();
     }
   }
 }
+
+// two passes along the same direction in one traversal, for the
+// stage transition of openings and closings: the doDilate operation
+// followed by the opposite one. Each line is read once, processed by
+// both and written once, giving the same result as two calls of
+// doOneDimension. See doOneDimensionBorder.
+template <typename TInIter,
+          typename TOutIter,
+          typename RealType,
+          typename TInputPixel,
+          typename OutputPixelType,
+          bool doDilate>
+void
+doOneDimensionOpenClose(TInIter &          inputIterator,
+                        TOutIter &         outputIterator,
+                        ProgressReporter & progress,
+                        const long         LineLength,
+                        const unsigned     direction,
+                        const bool         m_UseImageSpacing,
+                        const RealType     image_scale,
+                        const RealType     Sigma,
+                        int                ParabolicAlgorithmChoice,
+                        const bool         tiled = false)
+{
+  doOneDimensionBorder<TInIter, TOutIter, RealType, TInputPixel, OutputPixelType, doDilate, true>(
+    inputIterator,
+    outputIterator,
+    progress,
+    LineLength,
+    direction,
+    m_UseImageSpacing,
+    image_scale,
+    Sigma,
+    ParabolicAlgorithmChoice,
+    0,
+    0,
+    RealType(0),
+    0,
+    tiled);
+}
 } // namespace itk
 #endif
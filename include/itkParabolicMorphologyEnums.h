@@ -0,0 +1,63 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicMorphologyEnums_h
+#define itkParabolicMorphologyEnums_h
+
+namespace itk
+{
+/**
+ * \class ParabolicMorphologyEnums
+ * \brief Choices shared by the parabolic filters and line kernels.
+ *
+ * The filters derive from this class, so the values can be written
+ * as FilterType::INTERSECTION etc. The settings themselves are ints.
+ *
+ * \ingroup ParabolicMorphology
+ */
+class ParabolicMorphologyEnums
+{
+public:
+  /** Line algorithm, see SetParabolicAlgorithm */
+  enum ParabolicAlgorithm
+  {
+    NOCHOICE = 0,            // decides based on scale - experimental
+    CONTACTPOINT = 1,        // sometimes faster at low scale
+    INTERSECTION = 2,        // default
+    INTEGERINTERSECTION = 3, // exact, for integer values and parabola weights
+    AUTOTUNE = 4             // fastest of contact point and intersection, timed on the image
+  };
+
+  /** Line transfer between the image and the line buffers, see
+   * SetExecutionMode */
+  enum ExecutionMode
+  {
+    STRIDEDLINES = 0, // lines are read in place - default
+    TILEDLINES = 1,   // neighbouring lines are transposed into a contiguous block
+    AUTOLINES = 2     // tiles where there are enough neighbouring lines
+  };
+
+  /** Precision of the line buffers, see SetKernelPrecision */
+  enum KernelPrecision
+  {
+    DOUBLEPRECISION = 0, // line buffers of RealType - default
+    FLOATPRECISION = 1   // line buffers of InternalRealType
+  };
+};
+} // end namespace itk
+
+#endif
@@ -21,6 +21,7 @@
 #include "itkImageToImageFilter.h"
 #include "itkNumericTraits.h"
 #include "itkProgressReporter.h"
+#include "itkParabolicMorphologyEnums.h"
 
 namespace itk
 {
@@ -50,7 +51,9 @@ namespace itk
  *
  **/
 template <typename TInputImage, bool DoOpen, typename TOutputImage = TInputImage>
-class ITK_TEMPLATE_EXPORT ParabolicOpenCloseImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
+class ITK_TEMPLATE_EXPORT ParabolicOpenCloseImageFilter
+  : public ImageToImageFilter<TInputImage, TOutputImage>
+  , public ParabolicMorphologyEnums
 {
 public:
   ITK_DISALLOW_COPY_AND_MOVE(ParabolicOpenCloseImageFilter);
@@ -114,21 +117,82 @@ public:
   itkGetConstReferenceMacro(UseImageSpacing, bool);
   itkBooleanMacro(UseImageSpacing);
 
-  enum ParabolicAlgorithm
-  {
-    NOCHOICE = 0,     // decices based on scale - experimental
-    CONTACTPOINT = 1, // sometimes faster at low scale
-    INTERSECTION = 2  // default
-  };
   /**
    * Set/Get the method used. Choices are contact point or
    * intersection. Intersection is the default. Contact point can be
-   * faster at small scales.
+   * faster at small scales. AUTOTUNE times both on a sample of the
+   * lines and uses the faster, remembering the result (see
+   * ParabolicAutoTuneCache).
    */
 
   itkSetMacro(ParabolicAlgorithm, int);
   itkGetConstReferenceMacro(ParabolicAlgorithm, int);
 
+  /**
+   * Set/Get the way lines are transferred between the image and the
+   * line buffers. See ParabolicErodeDilateImageFilter.
+   */
+  itkSetMacro(ExecutionMode, int);
+  itkGetConstReferenceMacro(ExecutionMode, int);
+
+  using ExecutionStrategyType = FixedArray<int, ImageDimension>;
+  /** The line transfer used for each dimension by the last update */
+  itkGetConstReferenceMacro(ExecutionStrategy, ExecutionStrategyType);
+
+  /**
+   * Set/Get the precision of the line buffers. See
+   * ParabolicErodeDilateImageFilter.
+   */
+  itkSetMacro(KernelPrecision, int);
+  itkGetConstReferenceMacro(KernelPrecision, int);
+
+  /**
+   * Set/Get precision validation. When on, and KernelPrecision is
+   * FLOATPRECISION, the largest absolute difference from the
+   * DOUBLEPRECISION output is reported by GetMaximumPrecisionError.
+   */
+  itkSetMacro(ValidatePrecision, bool);
+  itkGetConstReferenceMacro(ValidatePrecision, bool);
+  itkBooleanMacro(ValidatePrecision);
+  itkGetConstReferenceMacro(MaximumPrecisionError, double);
+
+  /**
+   * Set/Get the size of a virtual border, in pixels, on each side of
+   * each dimension. The result is that of padding the input with
+   * BorderValue, filtering and cropping back to the input size, but
+   * the border is never stored on its own: lines are extended by it
+   * in the line buffers, and only the border pixels that the result
+   * depends on are processed, in a work image. Default is no border.
+   */
+  itkSetMacro(Border, InputSizeType);
+  itkGetConstReferenceMacro(Border, InputSizeType);
+
+  /** Set/Get the value of the virtual border pixels. */
+  itkSetMacro(BorderValue, PixelType);
+  itkGetConstReferenceMacro(BorderValue, PixelType);
+
+  /**
+   * Set/Get a known range of the input values. An output pixel then
+   * only depends on the input within twice ParabolicSupportRadius of
+   * it, once for each stage, so just that part of the input is
+   * requested and the output requested region isn't enlarged, which
+   * allows streaming. The range is widened to include BorderValue
+   * when there is a border, which is only added at the edges of the
+   * largest possible region. The passes run over that part of the
+   * input and the last one writes just the requested region. With
+   * line buffers of float, from float pixels or FLOATPRECISION, the
+   * result only matches that of the whole image to within rounding,
+   * as the lines start elsewhere. Default is off, when the whole input
+   * is requested and the whole output is produced.
+   */
+  itkSetMacro(UseInputRange, bool);
+  itkGetConstReferenceMacro(UseInputRange, bool);
+  itkBooleanMacro(UseInputRange);
+  itkSetMacro(InputMinimum, PixelType);
+  itkGetConstReferenceMacro(InputMinimum, PixelType);
+  itkSetMacro(InputMaximum, PixelType);
+  itkGetConstReferenceMacro(InputMaximum, PixelType);
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro(SameDimension,
@@ -158,18 +222,83 @@ protected:
   void
   GenerateInputRequestedRegion() override;
 
-  // Override since the filter produces the entire dataset.
+  // Override since the filter produces the entire dataset, unless
+  // the input range is known
   void
   EnlargeOutputRequestedRegion(DataObject * output) override;
 
-  int m_ParabolicAlgorithm;
+  // the input region needed for an output region
+  OutputImageRegionType
+  ComputeInputRegion(const OutputImageRegionType & region) const;
+
+  int  m_ParabolicAlgorithm;
+  int  m_ExecutionMode;
+  int  m_KernelPrecision;
+  bool m_ValidatePrecision;
+
+  ExecutionStrategyType m_ExecutionStrategy;
+  double                m_MaximumPrecisionError;
 
 private:
+  // doOneDimension for the current dimension, with line buffers of
+  // the current precision
+  template <bool doDilate, typename TInIter, typename TOutIter>
+  void
+  ProcessDimension(TInIter &                     inputIterator,
+                   TOutIter &                    outputIterator,
+                   ProgressReporter &            progress,
+                   const OutputImageRegionType & region);
+
+  // the last pass of the first stage and the first pass of the
+  // second, which share the last dimension, in one traversal
+  template <typename TInIter, typename TOutIter>
+  void
+  ProcessTransition(TInIter &                     inputIterator,
+                    TOutIter &                    outputIterator,
+                    ProgressReporter &            progress,
+                    const OutputImageRegionType & region);
+
+  // the passes with a virtual border, which grow into the border in
+  // the first stage and shrink back out of it in the second
+  void
+  ThreadedBorderPass(const OutputImageRegionType & region, ProgressReporter & progress);
+
+  // doOneDimensionBorder for the current dimension, with line buffers
+  // of the current precision, for lines of region
+  template <bool doDilate, bool fused, typename TInIter, typename TOutIter>
+  void
+  ProcessBorderDimension(TInIter &                     inputIterator,
+                         TOutIter &                    outputIterator,
+                         ProgressReporter &            progress,
+                         const OutputImageRegionType & region,
+                         long                          borderLower,
+                         long                          borderUpper,
+                         long                          outputStart);
+
   RadiusType m_Scale;
 
+  InputSizeType                     m_Border;
+  PixelType                         m_BorderValue;
+  bool                              m_UseBorder;
+  typename OutputImageType::Pointer m_BorderWork;
+  // the passes before the last, when the output only holds the
+  // requested region and there is no border work image
+  typename OutputImageType::Pointer m_Work;
+  // the border on each side of the region processed, which is only
+  // added at the edges of the largest possible region
+  InputSizeType m_BorderLower;
+  InputSizeType m_BorderUpper;
+  // the lines processed by the current pass
+  OutputImageRegionType m_PassRegion;
+
   int  m_CurrentDimension;
+  int  m_CurrentPrecision;
   int  m_Stage;
   bool m_UseImageSpacing;
+
+  bool      m_UseInputRange;
+  PixelType m_InputMinimum;
+  PixelType m_InputMaximum;
 };
 } // end namespace itk
 
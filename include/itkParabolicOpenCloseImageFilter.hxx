@@ -18,18 +18,11 @@
 #ifndef itkParabolicOpenCloseImageFilter_hxx
 #define itkParabolicOpenCloseImageFilter_hxx
 
+#include "itkImageAlgorithm.h"
 #include "itkImageRegionConstIterator.h"
 #include "itkImageRegionIterator.h"
 
-//#define NOINDEX
-#ifndef NOINDEX
-#  include "itkImageLinearIteratorWithIndex.h"
-#  include "itkImageLinearConstIteratorWithIndex.h"
-#else
-#  include "itkImageLinearIterator.h"
-#  include "itkImageLinearConstIterator.h"
-#endif
-#include "itkStatisticsImageFilter.h"
+#include "itkParabolicLineAccessor.h"
 #include "itkParabolicMorphUtils.h"
 
 namespace itk
@@ -42,8 +35,22 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::ParabolicOpenC
   // needs to be selected according to erosion/dilation
   m_UseImageSpacing = false;
   m_ParabolicAlgorithm = INTERSECTION;
-  m_Stage = 1; // indicate whether we are on the first pass or the
-  // second
+  m_ExecutionMode = STRIDEDLINES;
+  m_KernelPrecision = DOUBLEPRECISION;
+  m_CurrentPrecision = DOUBLEPRECISION;
+  m_ValidatePrecision = false;
+  m_MaximumPrecisionError = 0;
+  m_ExecutionStrategy.Fill(STRIDEDLINES);
+  m_Border.Fill(0);
+  m_BorderValue = NumericTraits<PixelType>::ZeroValue();
+  m_UseBorder = false;
+  m_BorderLower.Fill(0);
+  m_BorderUpper.Fill(0);
+  m_UseInputRange = false;
+  m_InputMinimum = NumericTraits<PixelType>::NonpositiveMin();
+  m_InputMaximum = NumericTraits<PixelType>::max();
+  m_Stage = 1; // indicate whether we are on the first pass, the
+  // second or the transition between them (3)
 
   this->DynamicMultiThreadingOff();
 }
@@ -58,8 +65,9 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::SplitRequested
   // Get the output pointer
   OutputImageType * outputPtr = this->GetOutput();
 
-  // Initialize the splitRegion to the output requested region
-  splitRegion = outputPtr->GetRequestedRegion();
+  // Initialize the splitRegion to the lines of the pass, the region
+  // processed unless there is a border
+  splitRegion = m_PassRegion;
 
   const OutputSizeType & requestedRegionSize = splitRegion.GetSize();
 
@@ -126,11 +134,11 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::GenerateInputR
   // copy the output requested region to the input requested region
   Superclass::GenerateInputRequestedRegion();
 
-  // This filter needs all of the input
+  // This filter needs all of the input, unless its range is known
   InputImagePointer image = const_cast<InputImageType *>(this->GetInput());
   if (image)
   {
-    image->SetRequestedRegion(this->GetInput()->GetLargestPossibleRegion());
+    image->SetRequestedRegion(this->ComputeInputRegion(this->GetOutput()->GetRequestedRegion()));
   }
 }
 
@@ -143,7 +151,7 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::EnlargeOutputR
 {
   auto * out = dynamic_cast<TOutputImage *>(output);
 
-  if (out)
+  if (out && !m_UseInputRange)
   {
     out->SetRequestedRegion(out->GetLargestPossibleRegion());
   }
@@ -151,26 +159,59 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::EnlargeOutputR
 
 #endif
 
+template <typename TInputImage, bool DoOpen, typename TOutputImage>
+typename ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::OutputImageRegionType
+ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::ComputeInputRegion(
+  const OutputImageRegionType & region) const
+{
+  const InputImageType * input = this->GetInput();
+  if (!m_UseInputRange)
+  {
+    return input->GetLargestPossibleRegion();
+  }
+
+  // the output region grown by the support of the parabolas of both
+  // stages. The border pixels are part of the input.
+  double minimum = m_InputMinimum;
+  double maximum = m_InputMaximum;
+  for (unsigned int d = 0; d < ImageDimension; d++)
+  {
+    if (m_Border[d] > 0)
+    {
+      minimum = std::min(minimum, static_cast<double>(m_BorderValue));
+      maximum = std::max(maximum, static_cast<double>(m_BorderValue));
+    }
+  }
+  InputSizeType radius = ParabolicSupportRadius<InputSizeType>(
+    m_Scale, input->GetSpacing(), m_UseImageSpacing, std::max(maximum - minimum, 0.0));
+  for (unsigned int d = 0; d < ImageDimension; d++)
+  {
+    radius[d] *= 2;
+  }
+  OutputImageRegionType inputRegion = region;
+  inputRegion.PadByRadius(radius);
+  inputRegion.Crop(input->GetLargestPossibleRegion());
+  return inputRegion;
+}
+
 template <typename TInputImage, bool DoOpen, typename TOutputImage>
 void
 ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::GenerateData()
 {
   ThreadIdType nbthreads = this->GetNumberOfWorkUnits();
 
-  //  using InputConstIteratorType = ImageLinearConstIteratorWithIndex< TInputImage  > ;
-  //  using OutputIteratorType = ImageLinearIteratorWithIndex< TOutputImage >;
-
-  // for stages after the first
-  // using OutputConstIteratorType = ImageLinearConstIteratorWithIndex< TOutputImage  > ;
-
-  //  using RegionType = ImageRegion< TInputImage::ImageDimension >;
-
   typename TInputImage::ConstPointer inputImage(this->GetInput());
   typename TOutputImage::Pointer     outputImage(this->GetOutput());
 
-  // const unsigned int imageDimension = inputImage->GetImageDimension();
-
-  outputImage->SetBufferedRegion(outputImage->GetRequestedRegion());
+  // with a known input range the passes run over the input region,
+  // which holds the requested region and the input it depends on.
+  // Only the requested region is exact, so the output buffer holds
+  // just that and the last pass writes the part of its lines inside
+  // it.
+  const OutputImageRegionType & requestedRegion = outputImage->GetRequestedRegion();
+  const OutputImageRegionType   processRegion =
+    m_UseInputRange ? this->ComputeInputRegion(requestedRegion) : requestedRegion;
+  outputImage->SetBufferedRegion(requestedRegion);
   outputImage->Allocate();
 
   typename ImageSource<OutputImageType>::ThreadStruct str;
@@ -180,57 +221,359 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::GenerateData()
   multithreader->SetNumberOfWorkUnits(nbthreads);
   multithreader->SetSingleMethod(this->ThreaderCallback, &str);
 
-  // multithread the execution
-
-  // multithread the execution - stage 1
-  m_Stage = 1;
-
+  // choose how lines are transferred for each dimension. Tiles are
+  // made from neighbouring lines along dimension 0, so passes along
+  // dimension 0 always read lines in place.
+  const OutputSizeType & regionSize = processRegion.GetSize();
   for (unsigned int d = 0; d < ImageDimension; d++)
   {
-    m_CurrentDimension = d;
-    multithreader->SingleMethodExecute();
+    const bool tiled = (d > 0) && ((m_ExecutionMode == TILEDLINES) ||
+                                   (m_ExecutionMode == AUTOLINES && regionSize[0] >= ParabolicTileLines / 2));
+    m_ExecutionStrategy[d] = tiled ? TILEDLINES : STRIDEDLINES;
   }
 
-  // multithread the execution - stage 2
-  m_Stage = 2;
+  // with a border, the passes of the first stage write the border
+  // along their dimension, and those of the second stage read it. A
+  // pass along dimension d needs the lines that are in the border
+  // along dimensions before d only, as the lines in the border along
+  // later dimensions stay at the border value through the first
+  // stage, and are not needed by the second. The work image holds the
+  // region processed and the border. The border is only on the sides
+  // of the region at the edges of the image, which is all of them
+  // unless part of the image is processed.
+  const OutputImageRegionType & largest = outputImage->GetLargestPossibleRegion();
+  m_UseBorder = false;
   for (unsigned int d = 0; d < ImageDimension; d++)
   {
-    m_CurrentDimension = d;
-    multithreader->SingleMethodExecute();
+    const bool atLower = processRegion.GetIndex(d) == largest.GetIndex(d);
+    const bool atUpper = processRegion.GetUpperIndex()[d] == largest.GetUpperIndex()[d];
+    m_BorderLower[d] = atLower ? m_Border[d] : 0;
+    m_BorderUpper[d] = atUpper ? m_Border[d] : 0;
+    if (m_BorderLower[d] > 0 || m_BorderUpper[d] > 0)
+    {
+      m_UseBorder = true;
+    }
   }
+  m_BorderWork = nullptr;
+  if (m_UseBorder && ImageDimension > 1)
+  {
+    OutputImageRegionType padded = processRegion;
+    for (unsigned int d = 0; d < ImageDimension; d++)
+    {
+      padded.SetIndex(d, padded.GetIndex(d) - static_cast<IndexValueType>(m_BorderLower[d]));
+      padded.SetSize(d, padded.GetSize(d) + m_BorderLower[d] + m_BorderUpper[d]);
+    }
+    m_BorderWork = OutputImageType::New();
+    m_BorderWork->CopyInformation(outputImage);
+    m_BorderWork->SetRegions(padded);
+    m_BorderWork->Allocate();
+  }
+  m_Work = nullptr;
+  if (processRegion != requestedRegion && ImageDimension > 1 && !m_BorderWork)
+  {
+    m_Work = OutputImageType::New();
+    m_Work->CopyInformation(outputImage);
+    m_Work->SetRegions(processRegion);
+    m_Work->Allocate();
+  }
+  auto setPassRegion = [&](unsigned int d) {
+    m_PassRegion = processRegion;
+    for (unsigned int k = 0; k < d; k++)
+    {
+      m_PassRegion.SetIndex(k, m_PassRegion.GetIndex(k) - static_cast<IndexValueType>(m_BorderLower[k]));
+      m_PassRegion.SetSize(k, m_PassRegion.GetSize(k) + m_BorderLower[k] + m_BorderUpper[k]);
+    }
+  };
+
+  // multithread the execution. The second stage runs through the
+  // dimensions in reverse, so the last pass of the first stage and
+  // the first pass of the second are along the same dimension. They
+  // are done together as a transition stage, each line being read
+  // and written once.
+  auto runStages = [&]() {
+    // multithread the execution - stage 1
+    m_Stage = 1;
+
+    for (unsigned int d = 0; d + 1 < ImageDimension; d++)
+    {
+      m_CurrentDimension = d;
+      setPassRegion(d);
+      multithreader->SingleMethodExecute();
+    }
 
-  m_Stage = 1;
+    // the transition, along the last dimension
+    m_Stage = 3;
+    m_CurrentDimension = ImageDimension - 1;
+    setPassRegion(ImageDimension - 1);
+    multithreader->SingleMethodExecute();
 
-#if 0
-  // Set up the multithreaded processing
-  typename ImageSource< TOutputImage >::ThreadStruct str;
-  str.Filter = this;
-  this->GetMultiThreader()->SetNumberOfWorkUnits( this->GetNumberOfWorkUnits() );
-  this->GetMultiThreader()->SetSingleMethod(this->ThreaderCallback, &str);
+    // multithread the execution - stage 2
+    m_Stage = 2;
+    for (int d = static_cast<int>(ImageDimension) - 2; d >= 0; d--)
+    {
+      m_CurrentDimension = d;
+      setPassRegion(d);
+      multithreader->SingleMethodExecute();
+    }
+
+    m_Stage = 1;
+  };
+
+  m_MaximumPrecisionError = 0;
+  const bool validate = m_ValidatePrecision && (m_KernelPrecision == FLOATPRECISION);
+  std::vector<OutputPixelType> reference;
+  const size_t                 numberOfPixels = outputImage->GetBufferedRegion().GetNumberOfPixels();
+  if (validate)
+  {
+    m_CurrentPrecision = DOUBLEPRECISION;
+    runStages();
+    reference.assign(outputImage->GetBufferPointer(), outputImage->GetBufferPointer() + numberOfPixels);
+  }
+
+  m_CurrentPrecision = m_KernelPrecision;
+  runStages();
 
-  // multithread the execution - stage 1
-  m_Stage = 1;
-  for ( unsigned int d = 0; d < ImageDimension; d++ )
+  if (validate)
+  {
+    const OutputPixelType * out = outputImage->GetBufferPointer();
+    for (size_t i = 0; i < numberOfPixels; i++)
     {
-    m_CurrentDimension = d;
-    this->GetMultiThreader()->SingleMethodExecute();
+      const double diff = std::abs(static_cast<double>(out[i]) - static_cast<double>(reference[i]));
+      m_MaximumPrecisionError = std::max(m_MaximumPrecisionError, diff);
     }
-  // swap over the parameters controlling erosion/dilation
-  m_Extreme = m_Extreme2;
-  m_MagnitudeSign = m_MagnitudeSign2;
+  }
+  m_BorderWork = nullptr;
+  m_Work = nullptr;
+}
+
+template <typename TInputImage, bool DoOpen, typename TOutputImage>
+template <bool doDilate, typename TInIter, typename TOutIter>
+void
+ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::ProcessDimension(
+  TInIter &                     inputIterator,
+  TOutIter &                    outputIterator,
+  ProgressReporter &            progress,
+  const OutputImageRegionType & region)
+{
+  const unsigned int  d = m_CurrentDimension;
+  const unsigned long LineLength = region.GetSize()[d];
+  const double        image_scale = this->GetInput()->GetSpacing()[d];
+  const bool          tiled = m_ExecutionStrategy[d] == TILEDLINES;
 
-  // multithread the execution - stage 2
-  m_Stage = 2;
-  for ( unsigned int d = 0; d < ImageDimension; d++ )
+  if (m_CurrentPrecision == FLOATPRECISION)
+  {
+    doOneDimension<TInIter, TOutIter, InternalRealType, PixelType, OutputPixelType, doDilate>(
+      inputIterator,
+      outputIterator,
+      progress,
+      LineLength,
+      d,
+      this->m_UseImageSpacing,
+      static_cast<InternalRealType>(image_scale),
+      static_cast<InternalRealType>(this->m_Scale[d]),
+      m_ParabolicAlgorithm,
+      tiled);
+  }
+  else
+  {
+    doOneDimension<TInIter, TOutIter, RealType, PixelType, OutputPixelType, doDilate>(
+      inputIterator,
+      outputIterator,
+      progress,
+      LineLength,
+      d,
+      this->m_UseImageSpacing,
+      static_cast<RealType>(image_scale),
+      static_cast<RealType>(this->m_Scale[d]),
+      m_ParabolicAlgorithm,
+      tiled);
+  }
+}
+
+template <typename TInputImage, bool DoOpen, typename TOutputImage>
+template <typename TInIter, typename TOutIter>
+void
+ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::ProcessTransition(
+  TInIter &                     inputIterator,
+  TOutIter &                    outputIterator,
+  ProgressReporter &            progress,
+  const OutputImageRegionType & region)
+{
+  const unsigned int  d = m_CurrentDimension;
+  const unsigned long LineLength = region.GetSize()[d];
+  const double        image_scale = this->GetInput()->GetSpacing()[d];
+  const bool          tiled = m_ExecutionStrategy[d] == TILEDLINES;
+
+  if (m_CurrentPrecision == FLOATPRECISION)
+  {
+    doOneDimensionOpenClose<TInIter, TOutIter, InternalRealType, PixelType, OutputPixelType, !DoOpen>(
+      inputIterator,
+      outputIterator,
+      progress,
+      LineLength,
+      d,
+      this->m_UseImageSpacing,
+      static_cast<InternalRealType>(image_scale),
+      static_cast<InternalRealType>(this->m_Scale[d]),
+      m_ParabolicAlgorithm,
+      tiled);
+  }
+  else
+  {
+    doOneDimensionOpenClose<TInIter, TOutIter, RealType, PixelType, OutputPixelType, !DoOpen>(
+      inputIterator,
+      outputIterator,
+      progress,
+      LineLength,
+      d,
+      this->m_UseImageSpacing,
+      static_cast<RealType>(image_scale),
+      static_cast<RealType>(this->m_Scale[d]),
+      m_ParabolicAlgorithm,
+      tiled);
+  }
+}
+
+template <typename TInputImage, bool DoOpen, typename TOutputImage>
+template <bool doDilate, bool fused, typename TInIter, typename TOutIter>
+void
+ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::ProcessBorderDimension(
+  TInIter &                     inputIterator,
+  TOutIter &                    outputIterator,
+  ProgressReporter &            progress,
+  const OutputImageRegionType & region,
+  long                          borderLower,
+  long                          borderUpper,
+  long                          outputStart)
+{
+  const unsigned int  d = m_CurrentDimension;
+  const unsigned long LineLength = region.GetSize()[d];
+  const double        image_scale = this->GetInput()->GetSpacing()[d];
+  const bool          tiled = m_ExecutionStrategy[d] == TILEDLINES;
+
+  if (m_CurrentPrecision == FLOATPRECISION)
+  {
+    doOneDimensionBorder<TInIter, TOutIter, InternalRealType, PixelType, OutputPixelType, doDilate, fused>(
+      inputIterator,
+      outputIterator,
+      progress,
+      LineLength,
+      d,
+      this->m_UseImageSpacing,
+      static_cast<InternalRealType>(image_scale),
+      static_cast<InternalRealType>(this->m_Scale[d]),
+      m_ParabolicAlgorithm,
+      borderLower,
+      borderUpper,
+      static_cast<InternalRealType>(m_BorderValue),
+      outputStart,
+      tiled);
+  }
+  else
+  {
+    doOneDimensionBorder<TInIter, TOutIter, RealType, PixelType, OutputPixelType, doDilate, fused>(
+      inputIterator,
+      outputIterator,
+      progress,
+      LineLength,
+      d,
+      this->m_UseImageSpacing,
+      static_cast<RealType>(image_scale),
+      static_cast<RealType>(this->m_Scale[d]),
+      m_ParabolicAlgorithm,
+      borderLower,
+      borderUpper,
+      static_cast<RealType>(m_BorderValue),
+      outputStart,
+      tiled);
+  }
+}
+
+template <typename TInputImage, bool DoOpen, typename TOutputImage>
+void
+ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::ThreadedBorderPass(
+  const OutputImageRegionType & passRegion,
+  ProgressReporter &            progress)
+{
+  using InputConstIteratorType = ParabolicLineAccessor<const TInputImage>;
+  using OutputIteratorType = ParabolicLineAccessor<TOutputImage>;
+  using OutputConstIteratorType = ParabolicLineAccessor<const TOutputImage>;
+  using CroppedIteratorType = ParabolicCroppedLineAccessor<TOutputImage>;
+
+  const unsigned int d = m_CurrentDimension;
+  const long         lower = m_BorderLower[d];
+  const long         upper = m_BorderUpper[d];
+
+  typename TInputImage::ConstPointer inputImage(this->GetInput());
+  typename TOutputImage::Pointer     outputImage(this->GetOutput());
+
+  // the last pass only needs the lines that cross the output, and
+  // writes the part of them inside it
+  OutputImageRegionType region = passRegion;
+  OutputImageRegionType outputRegion = outputImage->GetBufferedRegion();
+  const bool            last = (m_Stage == 2 && d == 0) || (m_Stage == 3 && !m_BorderWork);
+  if (last && !ParabolicCropLines(region, outputRegion, d))
+  {
+    return;
+  }
+
+  // the same lines, across the border along the current dimension
+  OutputImageRegionType outer = region;
+  outer.SetIndex(d, region.GetIndex(d) - lower);
+  outer.SetSize(d, region.GetSize(d) + lower + upper);
+
+  if (m_Stage == 3)
+  {
+    // both operations, the border is only in the line buffers
+    if (m_BorderWork)
     {
-    m_CurrentDimension = d;
-    this->GetMultiThreader()->SingleMethodExecute();
+      OutputConstIteratorType inputIterator(m_BorderWork.GetPointer(), region);
+      OutputIteratorType      outputIterator(m_BorderWork.GetPointer(), region);
+      this->template ProcessBorderDimension<!DoOpen, true>(
+        inputIterator, outputIterator, progress, region, lower, upper, lower);
     }
-  // swap them back
-  m_Extreme = m_Extreme1;
-  m_MagnitudeSign = m_MagnitudeSign1;
-  m_Stage = 1;
-#endif
+    else
+    {
+      InputConstIteratorType inputIterator(inputImage.GetPointer(), region);
+      CroppedIteratorType    outputIterator(outputImage.GetPointer(), outputRegion, region);
+      this->template ProcessBorderDimension<!DoOpen, true>(
+        inputIterator, outputIterator, progress, region, lower, upper, lower);
+    }
+  }
+  else if (m_Stage == 1)
+  {
+    // grow into the border
+    OutputIteratorType outputIterator(m_BorderWork.GetPointer(), outer);
+    if (d == 0)
+    {
+      InputConstIteratorType inputIterator(inputImage.GetPointer(), region);
+      this->template ProcessBorderDimension<!DoOpen, false>(
+        inputIterator, outputIterator, progress, region, lower, upper, 0);
+    }
+    else
+    {
+      OutputConstIteratorType inputIterator(m_BorderWork.GetPointer(), region);
+      this->template ProcessBorderDimension<!DoOpen, false>(
+        inputIterator, outputIterator, progress, region, lower, upper, 0);
+    }
+  }
+  else
+  {
+    // shrink out of the border, the last pass writes the output
+    OutputConstIteratorType inputIterator(m_BorderWork.GetPointer(), outer);
+    if (d == 0)
+    {
+      CroppedIteratorType outputIterator(outputImage.GetPointer(), outputRegion, region);
+      this->template ProcessBorderDimension<DoOpen, false>(
+        inputIterator, outputIterator, progress, outer, 0, 0, lower);
+    }
+    else
+    {
+      OutputIteratorType outputIterator(m_BorderWork.GetPointer(), region);
+      this->template ProcessBorderDimension<DoOpen, false>(
+        inputIterator, outputIterator, progress, outer, 0, 0, lower);
+    }
+  }
 }
 
 ////////////////////////////////////////////////////////////
@@ -265,28 +608,79 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::ThreadedGenera
                             m_CurrentDimension * progressPerDimension,
                             progressPerDimension);
 
-  using InputConstIteratorType = ImageLinearConstIteratorWithIndex<TInputImage>;
-  using OutputIteratorType = ImageLinearIteratorWithIndex<TOutputImage>;
+  if (m_UseBorder)
+  {
+    this->ThreadedBorderPass(outputRegionForThread, progress);
+    return;
+  }
+
+  using InputConstIteratorType = ParabolicLineAccessor<const TInputImage>;
+  using OutputIteratorType = ParabolicCroppedLineAccessor<TOutputImage>;
 
   // for stages after the first
-  using OutputConstIteratorType = ImageLinearConstIteratorWithIndex<TOutputImage>;
+  using OutputConstIteratorType = ParabolicLineAccessor<const TOutputImage>;
 
   using RegionType = ImageRegion<TInputImage::ImageDimension>;
 
   typename TInputImage::ConstPointer inputImage(this->GetInput());
   typename TOutputImage::Pointer     outputImage(this->GetOutput());
 
-  // const unsigned int imageDimension = inputImage->GetImageDimension();
+  // the passes work in place in the output, or in the work image when
+  // the output only holds the requested region. The last pass only
+  // needs the lines that cross the output, and writes the part of them
+  // inside it.
+  TOutputImage * work = m_Work ? m_Work.GetPointer() : outputImage.GetPointer();
+  const bool     last = (m_Stage == 2 && m_CurrentDimension == 0) || (m_Stage == 3 && ImageDimension == 1);
+  RegionType     region = outputRegionForThread;
+  RegionType     outputRegion = region;
+  if (last)
+  {
+    outputRegion = outputImage->GetBufferedRegion();
+    if (!ParabolicCropLines(region, outputRegion, m_CurrentDimension))
+    {
+      return;
+    }
+  }
+
+  InputConstIteratorType inputIterator(inputImage.GetPointer(), region);
+  OutputIteratorType     outputIterator(last ? outputImage.GetPointer() : work, outputRegion, region);
 
-  // outputImage->SetBufferedRegion( outputImage->GetRequestedRegion() );
-  // outputImage->Allocate();
-  RegionType region = outputRegionForThread;
+  // copy the input, for a first pass with zero scale
+  auto copyInput = [&](TOutputImage * target, const RegionType & copyRegion) {
+    using InItType = ImageRegionConstIterator<TInputImage>;
+    using OutItType = ImageRegionIterator<TOutputImage>;
 
-  InputConstIteratorType  inputIterator(inputImage, region);
-  OutputIteratorType      outputIterator(outputImage, region);
-  OutputConstIteratorType inputIteratorStage2(outputImage, region);
+    InItType  InIt(inputImage, copyRegion);
+    OutItType OutIt(target, copyRegion);
+    while (!InIt.IsAtEnd())
+    {
+      OutIt.Set(static_cast<OutputPixelType>(InIt.Get()));
+      ++InIt;
+      ++OutIt;
+    }
+  };
 
-  if (m_Stage == 1)
+  if (m_Stage == 3)
+  {
+    // the transition reads the input when it is also the first pass
+    if (m_Scale[m_CurrentDimension] > 0)
+    {
+      if (m_CurrentDimension == 0)
+      {
+        this->ProcessTransition(inputIterator, outputIterator, progress, region);
+      }
+      else
+      {
+        OutputConstIteratorType inputIteratorStage2(work, region);
+        this->ProcessTransition(inputIteratorStage2, outputIterator, progress, region);
+      }
+    }
+    else if (m_CurrentDimension == 0)
+    {
+      copyInput(last ? outputImage.GetPointer() : work, outputRegion);
+    }
+  }
+  else if (m_Stage == 1)
   {
     // deal with the first dimension - this should be copied to the
     // output if the scale is 0
@@ -296,34 +690,11 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::ThreadedGenera
       {
         // Perform as normal
         //     RealType magnitude = 1.0/(2.0 * m_Scale[0]);
-        unsigned long LineLength = region.GetSize()[0];
-        RealType      image_scale = this->GetInput()->GetSpacing()[0];
-
-        doOneDimension<InputConstIteratorType, OutputIteratorType, RealType, PixelType, OutputPixelType, !DoOpen>(
-          inputIterator,
-          outputIterator,
-          progress,
-          LineLength,
-          0,
-          this->m_UseImageSpacing,
-          image_scale,
-          this->m_Scale[0],
-          m_ParabolicAlgorithm);
+        this->template ProcessDimension<!DoOpen>(inputIterator, outputIterator, progress, region);
       }
       else
       {
-        // copy to output
-        using InItType = ImageRegionConstIterator<TInputImage>;
-        using OutItType = ImageRegionIterator<TOutputImage>;
-
-        InItType  InIt(inputImage, region);
-        OutItType OutIt(outputImage, region);
-        while (!InIt.IsAtEnd())
-        {
-          OutIt.Set(static_cast<OutputPixelType>(InIt.Get()));
-          ++InIt;
-          ++OutIt;
-        }
+        copyInput(work, region);
       }
     }
     else
@@ -331,19 +702,8 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::ThreadedGenera
       if (m_Scale[m_CurrentDimension] > 0)
       {
         // now deal with the other dimensions for first stage
-        unsigned long LineLength = region.GetSize()[m_CurrentDimension];
-        RealType      image_scale = this->GetInput()->GetSpacing()[m_CurrentDimension];
-
-        doOneDimension<OutputConstIteratorType, OutputIteratorType, RealType, PixelType, OutputPixelType, !DoOpen>(
-          inputIteratorStage2,
-          outputIterator,
-          progress,
-          LineLength,
-          m_CurrentDimension,
-          this->m_UseImageSpacing,
-          image_scale,
-          this->m_Scale[m_CurrentDimension],
-          m_ParabolicAlgorithm);
+        OutputConstIteratorType inputIteratorStage2(work, region);
+        this->template ProcessDimension<!DoOpen>(inputIteratorStage2, outputIterator, progress, region);
       }
     }
   }
@@ -353,19 +713,13 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::ThreadedGenera
     if (m_Scale[m_CurrentDimension] > 0)
     {
       // RealType magnitude = 1.0/(2.0 * m_Scale[dd]);
-      unsigned long LineLength = region.GetSize()[m_CurrentDimension];
-      RealType      image_scale = this->GetInput()->GetSpacing()[m_CurrentDimension];
-
-      doOneDimension<OutputConstIteratorType, OutputIteratorType, RealType, PixelType, OutputPixelType, DoOpen>(
-        inputIteratorStage2,
-        outputIterator,
-        progress,
-        LineLength,
-        m_CurrentDimension,
-        this->m_UseImageSpacing,
-        image_scale,
-        this->m_Scale[m_CurrentDimension],
-        m_ParabolicAlgorithm);
+      OutputConstIteratorType inputIteratorStage2(work, region);
+      this->template ProcessDimension<DoOpen>(inputIteratorStage2, outputIterator, progress, region);
+    }
+    else if (last && m_Work)
+    {
+      // the last pass still has to move the result to the output
+      ImageAlgorithm::Copy(m_Work.GetPointer(), outputImage.GetPointer(), outputRegion, outputRegion);
     }
   }
 }
@@ -383,6 +737,16 @@ ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>::PrintSelf(std:
   {
     os << "Scale in voxels: " << m_Scale << std::endl;
   }
+  os << indent << "ExecutionMode: " << m_ExecutionMode << std::endl;
+  os << indent << "ExecutionStrategy: " << m_ExecutionStrategy << std::endl;
+  os << indent << "KernelPrecision: " << m_KernelPrecision << std::endl;
+  os << indent << "ValidatePrecision: " << m_ValidatePrecision << std::endl;
+  os << indent << "MaximumPrecisionError: " << m_MaximumPrecisionError << std::endl;
+  os << indent << "Border: " << m_Border << std::endl;
+  os << indent << "BorderValue: " << static_cast<double>(m_BorderValue) << std::endl;
+  os << indent << "UseInputRange: " << m_UseInputRange << std::endl;
+  os << indent << "InputMinimum: " << static_cast<double>(m_InputMinimum) << std::endl;
+  os << indent << "InputMaximum: " << static_cast<double>(m_InputMaximum) << std::endl;
 }
 } // namespace itk
 #endif
@@ -19,18 +19,20 @@
 #define itkParabolicOpenCloseSafeBorderImageFilter_h
 
 #include "itkParabolicOpenCloseImageFilter.h"
-#include "itkCropImageFilter.h"
-#include "itkConstantPadImageFilter.h"
 #include "itkCastImageFilter.h"
-#include "itkStatisticsImageFilter.h"
+#include "itkMinimumMaximumImageFilter.h"
 
-/* this class implements padding and cropping, so we don't just
- * inherit from the OpenCloseImageFitler */
+/* this class sets up the border from the image statistics, so we
+ * don't just inherit from the OpenCloseImageFitler. The border is
+ * virtual, see ParabolicOpenCloseImageFilter::SetBorder, so the image
+ * is not padded and cropped. */
 
 namespace itk
 {
 template <typename TInputImage, bool DoOpen, typename TOutputImage = TInputImage>
-class ITK_TEMPLATE_EXPORT ParabolicOpenCloseSafeBorderImageFilter : public ImageToImageFilter<TInputImage, TOutputImage>
+class ITK_TEMPLATE_EXPORT ParabolicOpenCloseSafeBorderImageFilter
+  : public ImageToImageFilter<TInputImage, TOutputImage>
+  , public ParabolicMorphologyEnums
 {
 public:
   ITK_DISALLOW_COPY_AND_MOVE(ParabolicOpenCloseSafeBorderImageFilter);
@@ -122,21 +124,75 @@ public:
   itkBooleanMacro(SafeBorder);
   // should add the Get methods
 
-  enum ParabolicAlgorithm
-  {
-    NOCHOICE = 0,     // decices based on scale - experimental
-    CONTACTPOINT = 1, // sometimes faster at low scale
-    INTERSECTION = 2  // default
-  };
+  /**
+   * Set/Get a known range of the input values for the safe border,
+   * for example the range of the pixel type or one given by the image
+   * metadata. The input is then not searched for its range. The border
+   * value is the maximum of the range for openings and the minimum
+   * for closings, so a range wider than that of the input can change
+   * the result near the image edges. Only the part of the input that
+   * the output requested region depends on is then requested, see
+   * ParabolicOpenCloseImageFilter::SetUseInputRange, which allows
+   * streaming. Default is off. Otherwise the range found is kept until
+   * the input is modified.
+   */
+  itkSetMacro(UseInputRange, bool);
+  itkGetConstReferenceMacro(UseInputRange, bool);
+  itkBooleanMacro(UseInputRange);
+  itkSetMacro(InputMinimum, InputPixelType);
+  itkGetConstReferenceMacro(InputMinimum, InputPixelType);
+  itkSetMacro(InputMaximum, InputPixelType);
+  itkGetConstReferenceMacro(InputMaximum, InputPixelType);
+
   /**
    * Set/Get the method used. Choices are contact point or
    * intersection. Intersection is the default. Contact point can be
-   * faster at small scales.
+   * faster at small scales. AUTOTUNE times both on a sample of the
+   * lines and uses the faster, remembering the result (see
+   * ParabolicAutoTuneCache).
    */
 
   itkSetMacro(ParabolicAlgorithm, int);
   itkGetConstReferenceMacro(ParabolicAlgorithm, int);
 
+  /**
+   * Set/Get the way lines are transferred between the image and the
+   * line buffers. See ParabolicErodeDilateImageFilter.
+   */
+  itkSetMacro(ExecutionMode, int);
+  itkGetConstReferenceMacro(ExecutionMode, int);
+
+  using ExecutionStrategyType = FixedArray<int, ImageDimension>;
+  /** The line transfer used for each dimension by the last update */
+  const ExecutionStrategyType &
+  GetExecutionStrategy() const
+  {
+    return this->m_MorphFilt->GetExecutionStrategy();
+  }
+
+  /**
+   * Set/Get the precision of the line buffers. See
+   * ParabolicErodeDilateImageFilter.
+   */
+  itkSetMacro(KernelPrecision, int);
+  itkGetConstReferenceMacro(KernelPrecision, int);
+
+  /**
+   * Set/Get precision validation. See
+   * ParabolicErodeDilateImageFilter.
+   */
+  itkSetMacro(ValidatePrecision, bool);
+  itkGetConstReferenceMacro(ValidatePrecision, bool);
+  itkBooleanMacro(ValidatePrecision);
+
+  /** Largest difference from the double precision output found by
+   * the last update with ValidatePrecision on */
+  const double &
+  GetMaximumPrecisionError() const
+  {
+    return this->m_MorphFilt->GetMaximumPrecisionError();
+  }
+
   /** ParabolicOpenCloseImageFilter must forward the Modified() call to its
     internal filters */
   void
@@ -146,34 +202,60 @@ protected:
   void
   GenerateData() override;
 
+  void
+  GenerateInputRequestedRegion() override;
+
+  // Override since the filter produces the entire dataset, unless
+  // the input range is known
+  void
+  EnlargeOutputRequestedRegion(DataObject * output) override;
+
   void
   PrintSelf(std::ostream & os, Indent indent) const override;
 
   using MorphFilterType = ParabolicOpenCloseImageFilter<TInputImage, DoOpen, TOutputImage>;
-  using PadFilterType = ConstantPadImageFilter<TInputImage, TInputImage>;
-  using CropFilterType = CropImageFilter<TOutputImage, TOutputImage>;
-  using StatsFilterType = StatisticsImageFilter<InputImageType>;
+  using MinMaxFilterType = MinimumMaximumImageFilter<InputImageType>;
 
   ParabolicOpenCloseSafeBorderImageFilter()
   {
     m_MorphFilt = MorphFilterType::New();
-    m_PadFilt = PadFilterType::New();
-    m_CropFilt = CropFilterType::New();
-    m_StatsFilt = StatsFilterType::New();
+    m_MinMaxFilt = MinMaxFilterType::New();
     m_SafeBorder = true;
+    m_UseInputRange = false;
+    m_InputMinimum = NumericTraits<InputPixelType>::NonpositiveMin();
+    m_InputMaximum = NumericTraits<InputPixelType>::max();
+    m_RangeMinimum = NumericTraits<InputPixelType>::ZeroValue();
+    m_RangeMaximum = NumericTraits<InputPixelType>::ZeroValue();
+    m_RangeMTime = 0;
+    m_RangeUpdateMTime = 0;
     m_ParabolicAlgorithm = INTERSECTION;
+    m_ExecutionMode = STRIDEDLINES;
+    m_KernelPrecision = DOUBLEPRECISION;
+    m_ValidatePrecision = false;
   }
 
   ~ParabolicOpenCloseSafeBorderImageFilter() override = default;
-  int m_ParabolicAlgorithm;
+  int  m_ParabolicAlgorithm;
+  int  m_ExecutionMode;
+  int  m_KernelPrecision;
+  bool m_ValidatePrecision;
 
 private:
   typename MorphFilterType::Pointer m_MorphFilt;
-  typename PadFilterType::Pointer   m_PadFilt;
-  typename CropFilterType::Pointer  m_CropFilt;
-  typename StatsFilterType::Pointer m_StatsFilt;
+  typename MinMaxFilterType::Pointer m_MinMaxFilt;
+
+  bool           m_SafeBorder;
+  bool           m_UseInputRange;
+  InputPixelType m_InputMinimum;
+  InputPixelType m_InputMaximum;
+
+  // the range found for the input, with its modification and update
+  // times when it was found
+  InputPixelType   m_RangeMinimum;
+  InputPixelType   m_RangeMaximum;
+  ModifiedTimeType m_RangeMTime;
+  ModifiedTimeType m_RangeUpdateMTime;
 
-  bool m_SafeBorder;
   bool m_UseContactPoint;
   bool m_UseIntersection;
 };
@@ -19,9 +19,57 @@
 #define itkParabolicOpenCloseSafeBorderImageFilter_hxx
 
 #include "itkProgressAccumulator.h"
+#include "itkParabolicMorphUtils.h"
 
 namespace itk
 {
+template <typename TInputImage, bool DoOpen, typename TOutputImage>
+void
+ParabolicOpenCloseSafeBorderImageFilter<TInputImage, DoOpen, TOutputImage>::GenerateInputRequestedRegion()
+{
+  Superclass::GenerateInputRequestedRegion();
+
+  auto * input = const_cast<InputImageType *>(this->GetInput());
+  if (!input)
+  {
+    return;
+  }
+  if (!m_UseInputRange)
+  {
+    // the range is found from all of the input
+    input->SetRequestedRegion(input->GetLargestPossibleRegion());
+    return;
+  }
+
+  // the region requested by the internal filter, the output requested
+  // region grown by the support of the parabolas of both stages. The
+  // border value is within the range.
+  const double range = static_cast<double>(m_InputMaximum) - static_cast<double>(m_InputMinimum);
+  typename TInputImage::SizeType radius = ParabolicSupportRadius<typename TInputImage::SizeType>(
+    this->GetScale(), input->GetSpacing(), this->GetUseImageSpacing(), std::max(range, 0.0));
+  for (unsigned int d = 0; d < ImageDimension; d++)
+  {
+    radius[d] *= 2;
+  }
+  typename TInputImage::RegionType region = this->GetOutput()->GetRequestedRegion();
+  region.PadByRadius(radius);
+  region.Crop(input->GetLargestPossibleRegion());
+  input->SetRequestedRegion(region);
+}
+
+template <typename TInputImage, bool DoOpen, typename TOutputImage>
+void
+ParabolicOpenCloseSafeBorderImageFilter<TInputImage, DoOpen, TOutputImage>::EnlargeOutputRequestedRegion(
+  DataObject * output)
+{
+  auto * out = dynamic_cast<TOutputImage *>(output);
+
+  if (out && !m_UseInputRange)
+  {
+    out->SetRequestedRegion(out->GetLargestPossibleRegion());
+  }
+}
+
 template <typename TInputImage, bool DoOpen, typename TOutputImage>
 void
 ParabolicOpenCloseSafeBorderImageFilter<TInputImage, DoOpen, TOutputImage>::GenerateData()
@@ -32,19 +80,37 @@ ParabolicOpenCloseSafeBorderImageFilter<TInputImage, DoOpen, TOutputImage>::Gene
 
   // Allocate the output
   this->AllocateOutputs();
-  InputImageConstPointer           inputImage;
-  typename PadFilterType::SizeType Bounds;
-  typename PadFilterType::SizeType BoundsSize;
+  typename MorphFilterType::InputSizeType Bounds;
+  Bounds.Fill(0);
+
+  auto localInput = TInputImage::New();
+  localInput->Graft(this->GetInput());
+
   if (this->m_SafeBorder)
   {
-    auto localInput = TInputImage::New();
-    localInput->Graft(this->GetInput());
-
-    // need to compute some image statistics and determine the padding
-    // extent. This will almost certainly be an over estimate
-    m_StatsFilt->SetInput(localInput);
-    m_StatsFilt->Update();
-    InputPixelType                       range = m_StatsFilt->GetMaximum() - m_StatsFilt->GetMinimum();
+    // need the range of the input to determine the border extent.
+    // This will almost certainly be an over estimate. The range is
+    // given, found again when the input has changed, or kept from the
+    // last update.
+    InputPixelType minimum = m_InputMinimum;
+    InputPixelType maximum = m_InputMaximum;
+    if (!m_UseInputRange)
+    {
+      const InputImageType * input = this->GetInput();
+      if (input->GetMTime() != m_RangeMTime || input->GetUpdateMTime() != m_RangeUpdateMTime)
+      {
+        m_MinMaxFilt->SetInput(localInput);
+        progress->RegisterInternalFilter(m_MinMaxFilt, 0.1f);
+        m_MinMaxFilt->Update();
+        m_RangeMinimum = m_MinMaxFilt->GetMinimum();
+        m_RangeMaximum = m_MinMaxFilt->GetMaximum();
+        m_RangeMTime = input->GetMTime();
+        m_RangeUpdateMTime = input->GetUpdateMTime();
+      }
+      minimum = m_RangeMinimum;
+      maximum = m_RangeMaximum;
+    }
+    const double                         range = static_cast<double>(maximum) - static_cast<double>(minimum);
     typename MorphFilterType::RadiusType Sigma = m_MorphFilt->GetScale();
     typename TInputImage::SpacingType    spcing = localInput->GetSpacing();
     for (unsigned s = 0; s < ImageDimension; s++)
@@ -53,63 +119,41 @@ ParabolicOpenCloseSafeBorderImageFilter<TInputImage, DoOpen, TOutputImage>::Gene
       {
         RealType image_scale = spcing[s];
         Bounds[s] = (unsigned long)ceil(sqrt(2 * (Sigma[s] / (image_scale * image_scale)) * range));
-        BoundsSize[s] = Bounds[s];
       }
       else
       {
         Bounds[s] = (unsigned long)ceil(sqrt(2 * Sigma[s] * range));
-        BoundsSize[s] = Bounds[s];
       }
     }
-    m_PadFilt->SetPadLowerBound(Bounds);
-    m_PadFilt->SetPadUpperBound(Bounds);
 
     // need to select between opening and closing here
     if (DoOpen)
     {
-      // m_PadFilt->SetConstant(NumericTraits<InputPixelType>::max());
-      m_PadFilt->SetConstant(m_StatsFilt->GetMaximum());
+      m_MorphFilt->SetBorderValue(maximum);
     }
     else
     {
-      // m_PadFilt->SetConstant(NumericTraits<InputPixelType>::NonpositiveMin());
-      m_PadFilt->SetConstant(m_StatsFilt->GetMinimum());
+      m_MorphFilt->SetBorderValue(minimum);
     }
-    m_PadFilt->SetInput(localInput);
-    progress->RegisterInternalFilter(m_PadFilt, 0.1f);
-    inputImage = m_PadFilt->GetOutput();
-  }
-  else
-  {
-    auto localInput = TInputImage::New();
-    localInput->Graft(this->GetInput());
-
-    inputImage = localInput;
   }
 
-  m_MorphFilt->SetInput(inputImage);
+  // the border is added and removed by the line kernels, without
+  // padding and cropping the images
+  m_MorphFilt->SetBorder(Bounds);
+  m_MorphFilt->SetUseInputRange(m_UseInputRange);
+  m_MorphFilt->SetInputMinimum(m_InputMinimum);
+  m_MorphFilt->SetInputMaximum(m_InputMaximum);
+  m_MorphFilt->SetInput(localInput);
   m_MorphFilt->SetParabolicAlgorithm(m_ParabolicAlgorithm);
+  m_MorphFilt->SetExecutionMode(m_ExecutionMode);
+  m_MorphFilt->SetKernelPrecision(m_KernelPrecision);
+  m_MorphFilt->SetValidatePrecision(m_ValidatePrecision);
 
-  progress->RegisterInternalFilter(m_MorphFilt, 0.8f);
+  progress->RegisterInternalFilter(m_MorphFilt, this->m_SafeBorder ? 0.9f : 1.0f);
 
-  if (this->m_SafeBorder)
-  {
-    // crop
-    m_CropFilt->SetInput(m_MorphFilt->GetOutput());
-    m_CropFilt->SetUpperBoundaryCropSize(BoundsSize);
-    m_CropFilt->SetLowerBoundaryCropSize(BoundsSize);
-    progress->RegisterInternalFilter(m_CropFilt, 0.1f);
-    m_CropFilt->GraftOutput(this->GetOutput());
-    m_CropFilt->Update();
-    this->GraftOutput(m_CropFilt->GetOutput());
-  }
-  else
-  {
-    m_MorphFilt->GraftOutput(this->GetOutput());
-    m_MorphFilt->Update();
-    this->GraftOutput(m_MorphFilt->GetOutput());
-    // std::cout << "Finished grafting" << std::endl;
-  }
+  m_MorphFilt->GraftOutput(this->GetOutput());
+  m_MorphFilt->Update();
+  this->GraftOutput(m_MorphFilt->GetOutput());
 }
 
 template <typename TInputImage, bool DoOpen, typename TOutputImage>
@@ -118,9 +162,7 @@ ParabolicOpenCloseSafeBorderImageFilter<TInputImage, DoOpen, TOutputImage>::Modi
 {
   Superclass::Modified();
   m_MorphFilt->Modified();
-  m_PadFilt->Modified();
-  m_CropFilt->Modified();
-  m_StatsFilt->Modified();
+  m_MinMaxFilt->Modified();
 }
 
 ///////////////////////////////////
@@ -130,6 +172,9 @@ ParabolicOpenCloseSafeBorderImageFilter<TInputImage, DoOpen, TOutputImage>::Prin
                                                                                       Indent         indent) const
 {
   os << indent << "SafeBorder: " << m_SafeBorder << std::endl;
+  os << indent << "UseInputRange: " << m_UseInputRange << std::endl;
+  os << indent << "InputMinimum: " << static_cast<double>(m_InputMinimum) << std::endl;
+  os << indent << "InputMaximum: " << static_cast<double>(m_InputMaximum) << std::endl;
   if (this->GetUseImageSpacing())
   {
     os << "Scale in world units: " << this->GetScale() << std::endl;
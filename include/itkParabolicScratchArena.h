@@ -0,0 +1,199 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#ifndef itkParabolicScratchArena_h
+#define itkParabolicScratchArena_h
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace itk
+{
+/**
+ * \class ParabolicScratchArena
+ * \brief Reusable, 64 byte aligned scratch memory for the line buffers.
+ *
+ * Each thread processing a dimension takes an arena for the duration
+ * of the pass, carves its line buffers out of it, and hands it back
+ * at the end. Arenas are kept between passes, stages and Update()
+ * calls, so after the first pass the buffers are not allocated
+ * again. An arena is only grown when a longer line comes along.
+ *
+ * Idle arenas are pooled rather than held in thread local storage,
+ * so they survive the worker threads being recreated between
+ * updates. Reserve() creates arenas ahead of time and Release()
+ * frees the idle ones. Neither should be called while a filter is
+ * running.
+ *
+ * \ingroup ParabolicMorphology
+ *
+ * \author Richard Beare, Department of Medicine, Monash University,
+ * Australia.  <Richard.Beare@monash.edu>
+ *
+ **/
+class ParabolicScratchArena
+{
+  struct Arena;
+
+public:
+  static constexpr size_t Alignment = 64;
+
+  /** Space taken by n elements of T, rounded up to the alignment */
+  template <typename T>
+  static constexpr size_t
+  Bytes(size_t n)
+  {
+    return (n * sizeof(T) + Alignment - 1) / Alignment * Alignment;
+  }
+
+  /**
+   * \class Scratch
+   * Exclusive use of an arena of at least the requested size for the
+   * lifetime of the object. Take() hands out consecutive aligned
+   * blocks, which together must fit in the requested size.
+   */
+  class Scratch
+  {
+  public:
+    explicit Scratch(size_t bytes)
+      : m_Arena(Acquire(bytes))
+    {}
+
+    ~Scratch() { Return(m_Arena); }
+
+    Scratch(const Scratch &) = delete;
+    Scratch &
+    operator=(const Scratch &) = delete;
+
+    template <typename T>
+    T *
+    Take(size_t n)
+    {
+      T * block = reinterpret_cast<T *>(m_Arena->m_Data + m_Used);
+      m_Used += Bytes<T>(n);
+      return block;
+    }
+
+  private:
+    Arena * m_Arena;
+    size_t  m_Used{ 0 };
+  };
+
+  /** Make sure at least count idle arenas of at least bytes each
+   * exist, typically one per thread. */
+  static void
+  Reserve(size_t bytes, unsigned int count = 1)
+  {
+    Pool &                      pool = GetPool();
+    std::lock_guard<std::mutex> lock(pool.m_Mutex);
+    while (pool.m_Idle.size() < count)
+    {
+      pool.m_Idle.emplace_back(new Arena);
+    }
+    for (auto & arena : pool.m_Idle)
+    {
+      arena->Grow(bytes);
+    }
+  }
+
+  /** Free all idle arenas */
+  static void
+  Release()
+  {
+    Pool &                      pool = GetPool();
+    std::lock_guard<std::mutex> lock(pool.m_Mutex);
+    pool.m_Idle.clear();
+  }
+
+  /** Number of idle arenas */
+  static size_t
+  GetNumberOfArenas()
+  {
+    Pool &                      pool = GetPool();
+    std::lock_guard<std::mutex> lock(pool.m_Mutex);
+    return pool.m_Idle.size();
+  }
+
+private:
+  struct Arena
+  {
+    void
+    Grow(size_t bytes)
+    {
+      if (bytes <= m_Capacity)
+      {
+        return;
+      }
+      m_Storage.reset(new char[bytes + Alignment]);
+      const auto address = reinterpret_cast<std::uintptr_t>(m_Storage.get());
+      m_Data = m_Storage.get() + (Alignment - address % Alignment) % Alignment;
+      m_Capacity = bytes;
+    }
+
+    std::unique_ptr<char[]> m_Storage;
+    char *                  m_Data{ nullptr };
+    size_t                  m_Capacity{ 0 };
+  };
+
+  struct Pool
+  {
+    std::mutex                          m_Mutex;
+    std::vector<std::unique_ptr<Arena>> m_Idle;
+  };
+
+  static Pool &
+  GetPool()
+  {
+    static Pool pool;
+    return pool;
+  }
+
+  static Arena *
+  Acquire(size_t bytes)
+  {
+    Arena * arena = nullptr;
+    {
+      Pool &                      pool = GetPool();
+      std::lock_guard<std::mutex> lock(pool.m_Mutex);
+      if (!pool.m_Idle.empty())
+      {
+        arena = pool.m_Idle.back().release();
+        pool.m_Idle.pop_back();
+      }
+    }
+    if (arena == nullptr)
+    {
+      arena = new Arena;
+    }
+    arena->Grow(bytes);
+    return arena;
+  }
+
+  static void
+  Return(Arena * arena)
+  {
+    Pool &                      pool = GetPool();
+    std::lock_guard<std::mutex> lock(pool.m_Mutex);
+    pool.m_Idle.emplace_back(arena);
+  }
+};
+} // namespace itk
+
+#endif
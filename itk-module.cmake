@@ -13,6 +13,7 @@ itk_module( ParabolicMorphology
   DEPENDS
     ITKIOImageBase
     ITKThresholding
+    ITKLabelMap
   TEST_DEPENDS
     ITKImageGrid
     ITKTestKernel
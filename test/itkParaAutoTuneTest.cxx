@@ -0,0 +1,87 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkCommand.h"
+#include "itkSimpleFilterWatcher.h"
+
+#include "itkParabolicErodeImageFilter.h"
+#include "itkParabolicAutoTuneCache.h"
+#include "itkTimeProbe.h"
+#include "itkMultiThreaderBase.h"
+
+// the autotuned algorithm choice should give the same result as the
+// fixed ones, both when timing and when reusing the cached choice
+
+int
+itkParaAutoTuneTest(int argc, char * argv[])
+{
+  if (argc < 4)
+  {
+    std::cerr << "Usage: " << argv[0] << " input tunedOut cachedOut" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  try
+  {
+    reader->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  itk::ParabolicAutoTuneCache::Clear();
+
+  using FilterType = itk::ParabolicErodeImageFilter<IType, IType>;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(reader->GetOutput());
+  filter->SetScale(5);
+  filter->SetUseImageSpacing(true);
+  filter->SetParabolicAlgorithm(FilterType::AUTOTUNE);
+
+  using WriterType = itk::ImageFileWriter<IType>;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(filter->GetOutput());
+  try
+  {
+    writer->SetFileName(argv[2]);
+    writer->Update();
+
+    // second run uses the cached choice
+    filter->Modified();
+    writer->SetFileName(argv[3]);
+    writer->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
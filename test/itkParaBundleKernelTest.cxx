@@ -0,0 +1,132 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "itkArray.h"
+#include "itkParabolicMorphUtils.h"
+
+// the bundle kernels should give exactly the results of DoLineIntAlg
+// on each of their lines, for every instruction set the machine has
+
+// runs lanes random lines of length N through bundle and through
+// DoLineIntAlg, and returns the number of values that differ
+template <bool doDilate, typename TBundle>
+long
+compareBundle(TBundle bundle, unsigned int lanes, size_t N, float magnitude, bool binary, std::mt19937 & generator)
+{
+  std::vector<float> lines(N * lanes);
+  for (auto & value : lines)
+  {
+    value = binary ? ((generator() % 5 == 0) ? 0.0f : 1000.0f) : static_cast<float>(generator() % 256);
+  }
+
+  std::vector<float> bundled = lines;
+  std::vector<float> F(N * lanes);
+  std::vector<float> v(N * lanes);
+  std::vector<float> z((N + 1) * lanes);
+  bundle(bundled.data(), F.data(), v.data(), z.data(), N, magnitude);
+
+  long mismatches = 0;
+  for (unsigned int l = 0; l < lanes; l++)
+  {
+    itk::Array<float> line(N);
+    itk::Array<float> lineF(N);
+    itk::Array<float> lineZ(N + 1);
+    itk::Array<int>   lineV(N);
+    for (size_t q = 0; q < N; q++)
+    {
+      line[q] = lines[q * lanes + l];
+    }
+    itk::DoLineIntAlg<itk::Array<float>, itk::Array<int>, itk::Array<float>, float, doDilate>(
+      line, lineF, lineV, lineZ, magnitude);
+    for (size_t q = 0; q < N; q++)
+    {
+      if (line[q] != bundled[q * lanes + l])
+      {
+        ++mismatches;
+      }
+    }
+  }
+  return mismatches;
+}
+
+template <typename TBundleErode, typename TBundleDilate>
+long
+compareKernels(TBundleErode erode, TBundleDilate dilate, unsigned int lanes)
+{
+  std::mt19937 generator(1);
+  long         mismatches = 0;
+  for (int i = 0; i < 20; i++)
+  {
+    mismatches += compareBundle<false>(erode, lanes, 300, 0.3f, false, generator);
+    mismatches += compareBundle<true>(dilate, lanes, 300, 1.7f, false, generator);
+    mismatches += compareBundle<false>(erode, lanes, 257, 1.0f, true, generator);
+    mismatches += compareBundle<true>(dilate, lanes, 3, 0.5f, true, generator);
+    mismatches += compareBundle<false>(erode, lanes, 1, 1.0f, false, generator);
+  }
+  return mismatches;
+}
+
+int
+itkParaBundleKernelTest(int, char *[])
+{
+  const unsigned int lanes = itk::GetParabolicBundleLanes<float>();
+  if (lanes == 0)
+  {
+    std::cout << "No bundle kernel on this machine" << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  // the kernel chosen for this machine
+  long mismatches = compareKernels(
+    [](float * LineBuf, float * F, float * v, float * z, size_t N, float magnitude) {
+      itk::DoLineIntAlgBundle<float, false>(LineBuf, F, v, z, N, magnitude);
+    },
+    [](float * LineBuf, float * F, float * v, float * z, size_t N, float magnitude) {
+      itk::DoLineIntAlgBundle<float, true>(LineBuf, F, v, z, N, magnitude);
+    },
+    lanes);
+  std::cout << "Bundle of " << lanes << " lanes: " << mismatches << " mismatches" << std::endl;
+
+#ifdef ITK_PARABOLIC_X86_DISPATCH
+  // the AVX2 kernel as well, when the AVX512 one was chosen
+  if (itk::GetParabolicSIMDLevel() == itk::SIMDAVX512)
+  {
+    using TraitsType = itk::ParabolicAVX2Traits<float>;
+    const long avx2Mismatches = compareKernels(
+      [](float * LineBuf, float * F, float * v, float * z, size_t N, float magnitude) {
+        itk::DoLineIntAlgBundleAVX2<TraitsType, false>(LineBuf, F, v, z, N, magnitude);
+      },
+      [](float * LineBuf, float * F, float * v, float * z, size_t N, float magnitude) {
+        itk::DoLineIntAlgBundleAVX2<TraitsType, true>(LineBuf, F, v, z, N, magnitude);
+      },
+      TraitsType::Lanes);
+    std::cout << "AVX2 bundle of " << TraitsType::Lanes << " lanes: " << avx2Mismatches << " mismatches" << std::endl;
+    mismatches += avx2Mismatches;
+  }
+#endif
+
+  if (mismatches != 0)
+  {
+    std::cerr << "Bundle kernels don't match DoLineIntAlg" << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,126 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkMinimumMaximumImageCalculator.h"
+#include "itkCommand.h"
+#include "itkSimpleFilterWatcher.h"
+
+#include "itkParabolicErodeImageFilter.h"
+#include "itkTimeProbe.h"
+#include "itkMultiThreaderBase.h"
+
+// compact intermediate storage should stay within its error bound
+
+int
+itkParaCompactStorageTest(int argc, char * argv[])
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: " << argv[0] << " input compactOut" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  using PType = float;
+  using IType = itk::Image<PType, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  try
+  {
+    reader->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using FilterType = itk::ParabolicErodeImageFilter<IType, IType>;
+  FilterType::Pointer full = FilterType::New();
+  full->SetInput(reader->GetOutput());
+  full->SetScale(5);
+  full->SetUseImageSpacing(true);
+
+  FilterType::Pointer compact = FilterType::New();
+  compact->SetInput(reader->GetOutput());
+  compact->SetScale(5);
+  compact->SetUseImageSpacing(true);
+
+  // the float input needs a known range for the fixed point and half
+  // float storage
+  using CalculatorType = itk::MinimumMaximumImageCalculator<IType>;
+  CalculatorType::Pointer calculator = CalculatorType::New();
+  calculator->SetImage(reader->GetOutput());
+  calculator->Compute();
+  compact->SetUseInputRange(true);
+  compact->SetInputMinimum(calculator->GetMinimum());
+  compact->SetInputMaximum(calculator->GetMaximum());
+
+  const int storage[] = { FilterType::HALFFLOATSTORAGE, FilterType::BFLOAT16STORAGE, FilterType::FIXED16STORAGE };
+  try
+  {
+    full->Update();
+    for (int s : storage)
+    {
+      compact->SetIntermediateStorage(s);
+      compact->Update();
+
+      double                               maxError = 0;
+      itk::ImageRegionConstIterator<IType> fit(full->GetOutput(), full->GetOutput()->GetBufferedRegion());
+      itk::ImageRegionConstIterator<IType> cit(compact->GetOutput(), compact->GetOutput()->GetBufferedRegion());
+      for (; !fit.IsAtEnd(); ++fit, ++cit)
+      {
+        maxError = std::max(maxError, std::abs(static_cast<double>(fit.Get()) - static_cast<double>(cit.Get())));
+      }
+      std::cout << "Storage " << s << " error " << maxError << " bound " << compact->GetIntermediateErrorBound()
+                << std::endl;
+      // allow for float rounding of the output
+      if (maxError > compact->GetIntermediateErrorBound() + 1e-3)
+      {
+        std::cerr << "Error exceeds the bound for storage " << s << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using WriterType = itk::ImageFileWriter<IType>;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(compact->GetOutput());
+  writer->SetFileName(argv[2]);
+  try
+  {
+    writer->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
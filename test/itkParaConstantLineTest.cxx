@@ -0,0 +1,107 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkImageRegionIterator.h"
+#include "itkCommand.h"
+#include "itkSimpleFilterWatcher.h"
+
+#include "itkParabolicErodeImageFilter.h"
+#include "itkTimeProbe.h"
+#include "itkMultiThreaderBase.h"
+
+// erosion of a small square on a large background. Most lines of
+// both passes are constant and should be skipped, without changing
+// the result.
+
+int
+itkParaConstantLineTest(int, char *[])
+{
+  constexpr int dim = 2;
+
+  using IType = itk::Image<float, dim>;
+
+  IType::Pointer  input = IType::New();
+  IType::SizeType size;
+  size.Fill(64);
+  input->SetRegions(size);
+  input->Allocate();
+  for (itk::ImageRegionIterator<IType> it(input, input->GetLargestPossibleRegion()); !it.IsAtEnd(); ++it)
+  {
+    const IType::IndexType index = it.GetIndex();
+    const bool             inside = index[0] >= 20 && index[0] < 30 && index[1] >= 20 && index[1] < 30;
+    it.Set(inside ? 255 : 0);
+  }
+
+  constexpr double scale = 4;
+  using FilterType = itk::ParabolicErodeImageFilter<IType, IType>;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(input);
+  filter->SetScale(scale);
+
+  const int algorithms[] = { FilterType::CONTACTPOINT, FilterType::INTERSECTION, FilterType::INTEGERINTERSECTION };
+  try
+  {
+    for (int algorithm : algorithms)
+    {
+      filter->SetParabolicAlgorithm(algorithm);
+      filter->Update();
+
+      // brute force erosion
+      double maxError = 0;
+      for (itk::ImageRegionConstIteratorWithIndex<IType> it(filter->GetOutput(),
+                                                            filter->GetOutput()->GetBufferedRegion());
+           !it.IsAtEnd();
+           ++it)
+      {
+        const IType::IndexType index = it.GetIndex();
+        double                 expected = itk::NumericTraits<double>::max();
+        for (itk::ImageRegionConstIteratorWithIndex<IType> in(input, input->GetBufferedRegion()); !in.IsAtEnd(); ++in)
+        {
+          double sqrDist = 0;
+          for (unsigned int d = 0; d < dim; d++)
+          {
+            const double delta = index[d] - in.GetIndex()[d];
+            sqrDist += delta * delta;
+          }
+          expected = std::min(expected, in.Get() + sqrDist / (2 * scale));
+        }
+        maxError = std::max(maxError, std::abs(expected - it.Get()));
+      }
+      std::cout << "Algorithm " << algorithm << " skipped " << filter->GetSkippedLineFraction() << " error "
+                << maxError << std::endl;
+      if (maxError > 1e-3)
+      {
+        std::cerr << "Erosion is wrong" << std::endl;
+        return EXIT_FAILURE;
+      }
+      if (filter->GetSkippedLineFraction() < 0.5)
+      {
+        std::cerr << "Too few constant lines skipped" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,110 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iostream>
+#include <random>
+
+#include "itkArray.h"
+#include "itkParabolicMorphUtils.h"
+
+// the vector contact point kernel should give exactly the results of
+// DoLineCP, in float and double
+
+// runs a random line of length N, with values below valueRange,
+// through both kernels and returns the number of values that differ
+template <typename RealType, bool doDilate>
+long
+compareContactPoint(long N, RealType scale, unsigned int valueRange, std::mt19937 & generator)
+{
+  using LineBufferType = itk::Array<RealType>;
+  using PixelType = unsigned char;
+  static constexpr RealType extreme =
+    doDilate ? itk::NumericTraits<PixelType>::NonpositiveMin() : itk::NumericTraits<PixelType>::max();
+
+  const unsigned int lanes = itk::GetParabolicCPLanes<RealType>();
+  const RealType     magnitude = (doDilate ? 1 : -1) / (2 * scale);
+
+  // the vector kernel needs a vector of padding
+  LineBufferType vectorLine(N + lanes);
+  LineBufferType vectorTmp(N + lanes);
+  LineBufferType line(N);
+  LineBufferType tmp(N);
+  vectorLine.Fill(0);
+  vectorTmp.Fill(0);
+  for (long i = 0; i < N; i++)
+  {
+    line[i] = static_cast<RealType>(generator() % valueRange);
+    vectorLine[i] = line[i];
+  }
+
+  const long kmax = itk::ParabolicContactWindow(line, N, magnitude);
+  itk::DoLineCPVector<RealType, doDilate>(
+    vectorLine.data_block(), vectorTmp.data_block(), N, magnitude, extreme, kmax);
+  itk::DoLineCP<LineBufferType, RealType, PixelType, doDilate>(line, tmp, magnitude, kmax);
+
+  long mismatches = 0;
+  for (long i = 0; i < N; i++)
+  {
+    if (line[i] != vectorLine[i])
+    {
+      ++mismatches;
+    }
+  }
+  return mismatches;
+}
+
+template <typename RealType>
+long
+compareKernels()
+{
+  std::mt19937 generator(1);
+  long         mismatches = 0;
+  for (RealType scale : { 0.02, 0.1, 0.5, 3.0, 40.0 })
+  {
+    for (unsigned int valueRange : { 2, 7, 256 })
+    {
+      for (long N : { 1, 5, 67, 300 })
+      {
+        mismatches += compareContactPoint<RealType, false>(N, scale, valueRange, generator);
+        mismatches += compareContactPoint<RealType, true>(N, scale, valueRange, generator);
+      }
+    }
+  }
+  return mismatches;
+}
+
+int
+itkParaContactPointKernelTest(int, char *[])
+{
+  if (itk::GetParabolicCPLanes<float>() == 0)
+  {
+    std::cout << "No vector contact point kernel on this machine" << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  const long floatMismatches = compareKernels<float>();
+  const long doubleMismatches = compareKernels<double>();
+  std::cout << "float " << floatMismatches << " mismatches, double " << doubleMismatches << " mismatches"
+            << std::endl;
+
+  if (floatMismatches != 0 || doubleMismatches != 0)
+  {
+    std::cerr << "Vector contact point kernel doesn't match DoLineCP" << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
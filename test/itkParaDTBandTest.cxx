@@ -0,0 +1,123 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkCommand.h"
+#include "itkSimpleFilterWatcher.h"
+
+#include "itkBinaryThresholdImageFilter.h"
+#include "itkMorphologicalDistanceTransformImageFilter.h"
+#include "itkTimeProbe.h"
+#include "itkMultiThreaderBase.h"
+
+// a band limited transform, stored in unsigned char, should match the
+// clamped full transform
+
+int
+itkParaDTBandTest(int argc, char * argv[])
+{
+  if (argc != 4)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputimage threshold maxdist" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+  using FType = itk::Image<float, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  // threshold the input to create a mask
+  using ThreshType = itk::BinaryThresholdImageFilter<IType, IType>;
+  ThreshType::Pointer thresh = ThreshType::New();
+  thresh->SetInput(reader->GetOutput());
+  thresh->SetUpperThreshold(std::stoi(argv[2]));
+  thresh->SetInsideValue(0);
+  thresh->SetOutsideValue(255);
+
+  const double maxDist = std::stod(argv[3]);
+
+  using FilterType = itk::MorphologicalDistanceTransformImageFilter<IType, IType>;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(thresh->GetOutput());
+  filter->SetOutsideValue(0);
+  filter->SetMaximumDistance(maxDist);
+
+  using ReferenceType = itk::MorphologicalDistanceTransformImageFilter<IType, FType>;
+  ReferenceType::Pointer reference = ReferenceType::New();
+  reference->SetInput(thresh->GetOutput());
+  reference->SetOutsideValue(0);
+  reference->SetSqrDist(true);
+
+  // both squared and plain distances
+  const bool sqrDist[] = { true, false };
+  try
+  {
+    reference->Update();
+    for (bool sqr : sqrDist)
+    {
+      filter->SetSqrDist(sqr);
+      filter->Update();
+
+      long mismatches = 0;
+      for (itk::ImageRegionConstIteratorWithIndex<FType> it(reference->GetOutput(),
+                                                            reference->GetOutput()->GetBufferedRegion());
+           !it.IsAtEnd();
+           ++it)
+      {
+        const double clamped = std::min(static_cast<double>(it.Get()), maxDist * maxDist);
+        const auto   expected = static_cast<PType>(sqr ? clamped : std::sqrt(clamped));
+        if (filter->GetOutput()->GetPixel(it.GetIndex()) != expected)
+        {
+          ++mismatches;
+        }
+      }
+      std::cout << "SqrDist " << sqr << " mismatches " << mismatches << std::endl;
+      if (mismatches > 0)
+      {
+        std::cerr << "Band limited transform doesn't match the clamped transform" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // without the limit the squared distances don't fit
+  filter->SetMaximumDistance(itk::NumericTraits<double>::max());
+  try
+  {
+    filter->Update();
+    std::cerr << "Expected an exception for the unlimited transform" << std::endl;
+    return EXIT_FAILURE;
+  }
+  catch (itk::ExceptionObject &)
+  {
+    std::cout << "Unlimited transform rejected" << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,120 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkCommand.h"
+#include "itkSimpleFilterWatcher.h"
+
+#include "itkBinaryThresholdImageFilter.h"
+#include "itkMorphologicalDistanceTransformImageFilter.h"
+#include "itkTimeProbe.h"
+#include "itkMultiThreaderBase.h"
+
+// every voxel of the feature transform should refer to a voxel with
+// the outside value, at the distance given by the distance transform
+
+int
+itkParaFeatureTransformTest(int argc, char * argv[])
+{
+  if (argc != 3)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputimage threshold" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+  using FType = itk::Image<float, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  // threshold the input to create a mask
+  using ThreshType = itk::BinaryThresholdImageFilter<IType, IType>;
+  ThreshType::Pointer thresh = ThreshType::New();
+  thresh->SetInput(reader->GetOutput());
+  thresh->SetUpperThreshold(std::stoi(argv[2]));
+  thresh->SetInsideValue(0);
+  thresh->SetOutsideValue(255);
+
+  using FilterType = itk::MorphologicalDistanceTransformImageFilter<IType, FType>;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(thresh->GetOutput());
+  filter->SetOutsideValue(0);
+  filter->SetSqrDist(true);
+
+  FilterType::Pointer reference = FilterType::New();
+  reference->SetInput(thresh->GetOutput());
+  reference->SetOutsideValue(0);
+  reference->SetSqrDist(true);
+
+  // both line transfers
+  const int modes[] = { FilterType::STRIDEDLINES, FilterType::TILEDLINES };
+  try
+  {
+    reference->Update();
+    for (int mode : modes)
+    {
+      filter->SetComputeFeatureTransform(true);
+      filter->SetExecutionMode(mode);
+      filter->Update();
+
+      const IType *                        mask = thresh->GetOutput();
+      const FType *                        dist = filter->GetOutput();
+      const FilterType::FeatureImageType * features = filter->GetFeatureImage();
+      const FType::SpacingType             spacing = dist->GetSpacing();
+
+      double maxError = 0;
+      long   wrongFeatures = 0;
+      for (itk::ImageRegionConstIteratorWithIndex<FType> it(dist, dist->GetBufferedRegion()); !it.IsAtEnd(); ++it)
+      {
+        const FType::IndexType index = it.GetIndex();
+        const FType::IndexType nearest = dist->ComputeIndex(features->GetPixel(index));
+        if (mask->GetPixel(nearest) != 0)
+        {
+          ++wrongFeatures;
+        }
+        double sqrDist = 0;
+        for (unsigned int d = 0; d < dim; d++)
+        {
+          const double delta = (index[d] - nearest[d]) * spacing[d];
+          sqrDist += delta * delta;
+        }
+        maxError = std::max(maxError, std::abs(sqrDist - it.Get()));
+        const double expected = reference->GetOutput()->GetPixel(index);
+        maxError = std::max(maxError, std::abs(expected - it.Get()));
+      }
+      std::cout << "Mode " << mode << " wrong features " << wrongFeatures << " error " << maxError << std::endl;
+      if (wrongFeatures > 0 || maxError > 1e-3)
+      {
+        std::cerr << "Feature transform doesn't match the distance transform" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,132 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkChangeInformationImageFilter.h"
+#include "itkCommand.h"
+#include "itkSimpleFilterWatcher.h"
+
+#include "itkBinaryThresholdImageFilter.h"
+#include "itkMorphologicalDistanceTransformImageFilter.h"
+#include "itkParabolicErodeImageFilter.h"
+#include "itkSqrtImageFilter.h"
+
+// the distance transform, which thresholds and takes the square root
+// within the erosion passes, should match the separate threshold,
+// erosion and square root filters
+
+namespace
+{
+using IType = itk::Image<unsigned char, 2>;
+using FType = itk::Image<float, 2>;
+
+void
+WriteFusedDT(IType * mask, bool sqrDist, bool integral, const char * fusedName, const char * separateName)
+{
+  using DTType = itk::MorphologicalDistanceTransformImageFilter<IType, FType>;
+  DTType::Pointer dt = DTType::New();
+  dt->SetInput(mask);
+  dt->SetOutsideValue(0);
+  dt->SetSqrDist(sqrDist);
+
+  double     maxDist = 0;
+  const auto size = mask->GetLargestPossibleRegion().GetSize();
+  const auto spacing = mask->GetSpacing();
+  for (unsigned d = 0; d < 2; d++)
+  {
+    maxDist += (size[d] * spacing[d]) * (size[d] * spacing[d]);
+  }
+
+  using ThreshType = itk::BinaryThresholdImageFilter<IType, FType>;
+  ThreshType::Pointer thresh = ThreshType::New();
+  thresh->SetInput(mask);
+  thresh->SetLowerThreshold(0);
+  thresh->SetUpperThreshold(0);
+  thresh->SetInsideValue(0);
+  thresh->SetOutsideValue(maxDist);
+
+  using ErodeType = itk::ParabolicErodeImageFilter<FType, FType>;
+  ErodeType::Pointer erode = ErodeType::New();
+  erode->SetInput(thresh->GetOutput());
+  erode->SetScale(0.5);
+  erode->SetUseImageSpacing(true);
+  erode->SetParabolicAlgorithm(integral ? ErodeType::INTEGERINTERSECTION : ErodeType::INTERSECTION);
+
+  using SqrtType = itk::SqrtImageFilter<FType, FType>;
+  SqrtType::Pointer root = SqrtType::New();
+  root->SetInput(erode->GetOutput());
+
+  using WriterType = itk::ImageFileWriter<FType>;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(dt->GetOutput());
+  writer->SetFileName(fusedName);
+  writer->Update();
+  writer->SetInput(sqrDist ? erode->GetOutput() : root->GetOutput());
+  writer->SetFileName(separateName);
+  writer->Update();
+}
+} // namespace
+
+int
+itkParaFusedDTTest(int argc, char * argv[])
+{
+  if (argc < 8)
+  {
+    std::cerr << "Usage: " << argv[0]
+              << " inputimage threshold anisotropic fusedOut separateOut fusedSqrOut separateSqrOut" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  using ThreshType = itk::BinaryThresholdImageFilter<IType, IType>;
+  ThreshType::Pointer thresh = ThreshType::New();
+  thresh->SetInput(reader->GetOutput());
+  thresh->SetUpperThreshold(std::stoi(argv[2]));
+  thresh->SetInsideValue(0);
+  thresh->SetOutsideValue(1);
+
+  // a spacing that isn't integral uses the floating point kernels
+  using ChangeType = itk::ChangeInformationImageFilter<IType>;
+  ChangeType::Pointer change = ChangeType::New();
+  change->SetInput(thresh->GetOutput());
+  IType::SpacingType spacing;
+  spacing[0] = 0.7;
+  spacing[1] = 1.3;
+  change->SetOutputSpacing(spacing);
+  change->ChangeSpacingOn();
+
+  try
+  {
+    const bool     anisotropic = std::stoi(argv[3]) != 0;
+    IType::Pointer mask = anisotropic ? change->GetOutput() : thresh->GetOutput();
+    mask->Update();
+    WriteFusedDT(mask, false, !anisotropic, argv[4], argv[5]);
+    WriteFusedDT(mask, true, !anisotropic, argv[6], argv[7]);
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
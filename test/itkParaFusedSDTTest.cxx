@@ -0,0 +1,146 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkChangeInformationImageFilter.h"
+#include "itkCommand.h"
+#include "itkSimpleFilterWatcher.h"
+
+#include "itkBinaryThresholdImageFilter.h"
+#include "itkMorphologicalSignedDistanceTransformImageFilter.h"
+#include "itkParabolicErodeImageFilter.h"
+#include "itkParabolicDilateImageFilter.h"
+#include "itkMorphSDTHelperImageFilter.h"
+
+// the signed distance transform, which computes both sides in one
+// erosion, should match the separate threshold, erosion, dilation
+// and combination filters. With integral spacing both are exact, the
+// separate filters lose some precision otherwise, as they store
+// squared distances offset by the maximum distance.
+
+namespace
+{
+using IType = itk::Image<unsigned char, 2>;
+using FType = itk::Image<float, 2>;
+
+void
+WriteFusedSDT(IType * mask, bool insideIsPositive, bool integral, const char * fusedName, const char * separateName)
+{
+  using SDTType = itk::MorphologicalSignedDistanceTransformImageFilter<IType, FType>;
+  SDTType::Pointer sdt = SDTType::New();
+  sdt->SetInput(mask);
+  sdt->SetOutsideValue(0);
+  sdt->SetInsideIsPositive(insideIsPositive);
+
+  double     maxDist = 0;
+  const auto size = mask->GetLargestPossibleRegion().GetSize();
+  const auto spacing = mask->GetSpacing();
+  for (unsigned d = 0; d < 2; d++)
+  {
+    maxDist += (size[d] * spacing[d]) * (size[d] * spacing[d]);
+  }
+
+  using ThreshType = itk::BinaryThresholdImageFilter<IType, FType>;
+  ThreshType::Pointer thresh = ThreshType::New();
+  thresh->SetInput(mask);
+  thresh->SetLowerThreshold(0);
+  thresh->SetUpperThreshold(0);
+  thresh->SetInsideValue(insideIsPositive ? -maxDist : maxDist);
+  thresh->SetOutsideValue(insideIsPositive ? maxDist : -maxDist);
+
+  using ErodeType = itk::ParabolicErodeImageFilter<FType, FType>;
+  ErodeType::Pointer erode = ErodeType::New();
+  erode->SetInput(thresh->GetOutput());
+  erode->SetScale(0.5);
+  erode->SetUseImageSpacing(true);
+  erode->SetParabolicAlgorithm(integral ? ErodeType::INTEGERINTERSECTION : ErodeType::INTERSECTION);
+
+  using DilateType = itk::ParabolicDilateImageFilter<FType, FType>;
+  DilateType::Pointer dilate = DilateType::New();
+  dilate->SetInput(thresh->GetOutput());
+  dilate->SetScale(0.5);
+  dilate->SetUseImageSpacing(true);
+  dilate->SetParabolicAlgorithm(integral ? DilateType::INTEGERINTERSECTION : DilateType::INTERSECTION);
+
+  using HelperType = itk::MorphSDTHelperImageFilter<FType, FType>;
+  HelperType::Pointer helper = HelperType::New();
+  helper->SetInput(erode->GetOutput());
+  helper->SetInput2(dilate->GetOutput());
+  helper->SetInput3(thresh->GetOutput());
+  helper->SetVal(maxDist);
+
+  using WriterType = itk::ImageFileWriter<FType>;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(sdt->GetOutput());
+  writer->SetFileName(fusedName);
+  writer->Update();
+  writer->SetInput(helper->GetOutput());
+  writer->SetFileName(separateName);
+  writer->Update();
+}
+} // namespace
+
+int
+itkParaFusedSDTTest(int argc, char * argv[])
+{
+  if (argc < 8)
+  {
+    std::cerr << "Usage: " << argv[0]
+              << " inputimage threshold anisotropic fusedOut separateOut fusedInsideOut separateInsideOut"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  using ThreshType = itk::BinaryThresholdImageFilter<IType, IType>;
+  ThreshType::Pointer thresh = ThreshType::New();
+  thresh->SetInput(reader->GetOutput());
+  thresh->SetUpperThreshold(std::stoi(argv[2]));
+  thresh->SetInsideValue(0);
+  thresh->SetOutsideValue(1);
+
+  // a spacing that isn't integral uses the floating point kernels
+  using ChangeType = itk::ChangeInformationImageFilter<IType>;
+  ChangeType::Pointer change = ChangeType::New();
+  change->SetInput(thresh->GetOutput());
+  IType::SpacingType spacing;
+  spacing[0] = 0.7;
+  spacing[1] = 1.3;
+  change->SetOutputSpacing(spacing);
+  change->ChangeSpacingOn();
+
+  try
+  {
+    const bool     anisotropic = std::stoi(argv[3]) != 0;
+    IType::Pointer mask = anisotropic ? change->GetOutput() : thresh->GetOutput();
+    mask->Update();
+    WriteFusedSDT(mask, false, !anisotropic, argv[4], argv[5]);
+    WriteFusedSDT(mask, true, !anisotropic, argv[6], argv[7]);
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
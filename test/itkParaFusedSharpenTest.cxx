@@ -0,0 +1,118 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkCommand.h"
+#include "itkSimpleFilterWatcher.h"
+
+#include "itkCastImageFilter.h"
+#include "itkMorphologicalSharpeningImageFilter.h"
+#include "itkParabolicErodeImageFilter.h"
+#include "itkParabolicDilateImageFilter.h"
+#include "itkSharpenOpImageFilter.h"
+
+// the sharpening filter, which computes the erosion, dilation and
+// selection in the same passes, should match separate erosion,
+// dilation and selection filters applied iteratively
+
+int
+itkParaFusedSharpenTest(int argc, char * argv[])
+{
+  if (argc < 5)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputimage iterations fusedOut separateOut" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  constexpr int dim = 2;
+  using IType = itk::Image<unsigned char, dim>;
+  using FType = itk::Image<float, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  const int iterations = std::stoi(argv[2]);
+
+  using FilterType = itk::MorphologicalSharpeningImageFilter<IType, FType>;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(reader->GetOutput());
+  FilterType::RadiusType scale;
+  scale[0] = 2;
+  scale[1] = 0.5;
+  filter->SetScale(scale);
+  filter->SetIterations(iterations);
+
+  using CastType = itk::CastImageFilter<IType, FType>;
+  CastType::Pointer cast = CastType::New();
+  cast->SetInput(reader->GetOutput());
+
+  FType::Pointer reference;
+  try
+  {
+    filter->Update();
+    cast->Update();
+    reference = cast->GetOutput();
+    for (int i = 0; i < iterations; i++)
+    {
+      using ErodeType = itk::ParabolicErodeImageFilter<FType, FType>;
+      ErodeType::Pointer erode = ErodeType::New();
+      erode->SetInput(reference);
+      erode->SetScale(scale);
+
+      using DilateType = itk::ParabolicDilateImageFilter<FType, FType>;
+      DilateType::Pointer dilate = DilateType::New();
+      dilate->SetInput(reference);
+      dilate->SetScale(scale);
+
+      using SharpenOpType = itk::SharpenOpImageFilter<FType, FType, FType, FType>;
+      SharpenOpType::Pointer sharpen = SharpenOpType::New();
+      sharpen->SetInput(dilate->GetOutput());
+      sharpen->SetInput2(reference);
+      sharpen->SetInput3(erode->GetOutput());
+      sharpen->Update();
+      reference = sharpen->GetOutput();
+      reference->DisconnectPipeline();
+    }
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using WriterType = itk::ImageFileWriter<FType>;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(filter->GetOutput());
+  writer->SetFileName(argv[3]);
+  try
+  {
+    writer->Update();
+    writer->SetInput(reference);
+    writer->SetFileName(argv[4]);
+    writer->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
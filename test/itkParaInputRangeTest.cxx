@@ -0,0 +1,95 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkCommand.h"
+#include "itkSimpleFilterWatcher.h"
+
+#include "itkMinimumMaximumImageCalculator.h"
+#include "itkParabolicOpenImageFilter.h"
+
+// a safe border opening should give the same result with the range
+// of the input found, kept from an earlier update or given
+
+int
+itkParaInputRangeTest(int argc, char * argv[])
+{
+  if (argc < 5)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputimage foundOut givenOut keptOut" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  constexpr int dim = 2;
+  using IType = itk::Image<unsigned char, dim>;
+  using FType = itk::Image<float, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  using FilterType = itk::ParabolicOpenImageFilter<IType, FType>;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(reader->GetOutput());
+  filter->SetScale(5.0);
+  filter->SetSafeBorder(true);
+
+  FilterType::Pointer given = FilterType::New();
+  given->SetInput(reader->GetOutput());
+  given->SetScale(5.0);
+  given->SetSafeBorder(true);
+
+  using WriterType = itk::ImageFileWriter<FType>;
+  WriterType::Pointer writer = WriterType::New();
+  try
+  {
+    reader->Update();
+    using CalculatorType = itk::MinimumMaximumImageCalculator<IType>;
+    CalculatorType::Pointer calculator = CalculatorType::New();
+    calculator->SetImage(reader->GetOutput());
+    calculator->Compute();
+
+    given->SetUseInputRange(true);
+    given->SetInputMinimum(calculator->GetMinimum());
+    given->SetInputMaximum(calculator->GetMaximum());
+
+    writer->SetInput(filter->GetOutput());
+    writer->SetFileName(argv[2]);
+    writer->Update();
+
+    writer->SetInput(given->GetOutput());
+    writer->SetFileName(argv[3]);
+    writer->Update();
+
+    // the range is kept when only the scale changes
+    filter->SetScale(2.0);
+    filter->Update();
+    filter->SetScale(5.0);
+    writer->SetInput(filter->GetOutput());
+    writer->SetFileName(argv[4]);
+    writer->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
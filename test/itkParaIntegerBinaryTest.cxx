@@ -0,0 +1,131 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkCommand.h"
+#include "itkSimpleFilterWatcher.h"
+
+#include "itkBinaryThresholdImageFilter.h"
+#include "itkBinaryDilateParaImageFilter.h"
+#include "itkBinaryErodeParaImageFilter.h"
+#include "itkBinaryOpenParaImageFilter.h"
+#include "itkBinaryCloseParaImageFilter.h"
+
+// the binary filters with integer squared distances should match the
+// float versions, and store the narrowest type that holds the radius.
+// The radii used have no squared distances that are the sum of two
+// nonzero squares at the threshold, where float rounding decides.
+
+namespace
+{
+using PType = unsigned char;
+using IType = itk::Image<PType, 2>;
+
+template <typename TFilter>
+bool
+WriteIntegerDistances(IType *      mask,
+                      double       radius,
+                      bool         useSpacing,
+                      unsigned int expectedSize,
+                      const char * integerName,
+                      const char * realName)
+{
+  typename TFilter::Pointer integer = TFilter::New();
+  integer->SetInput(mask);
+  integer->SetRadius(radius);
+  integer->SetUseImageSpacing(useSpacing);
+
+  typename TFilter::Pointer real = TFilter::New();
+  real->SetInput(mask);
+  real->SetRadius(radius);
+  real->SetUseImageSpacing(useSpacing);
+  real->SetUseIntegerDistances(false);
+
+  using WriterType = itk::ImageFileWriter<IType>;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(integer->GetOutput());
+  writer->SetFileName(integerName);
+  writer->Update();
+  writer->SetInput(real->GetOutput());
+  writer->SetFileName(realName);
+  writer->Update();
+
+  std::cout << integer->GetNameOfClass() << " radius " << radius << " work pixel size "
+            << integer->GetWorkPixelSize() << std::endl;
+  if (integer->GetWorkPixelSize() != expectedSize)
+  {
+    std::cerr << "Expected " << expectedSize << " byte work pixels" << std::endl;
+    return false;
+  }
+  return true;
+}
+} // namespace
+
+int
+itkParaIntegerBinaryTest(int argc, char * argv[])
+{
+  if (argc < 14)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputimage threshold radius useSpacing workPixelSize"
+              << " dilateOut realDilateOut erodeOut realErodeOut openOut realOpenOut closeOut realCloseOut"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  // a 0/1 mask
+  using ThreshType = itk::BinaryThresholdImageFilter<IType, IType>;
+  ThreshType::Pointer thresh = ThreshType::New();
+  thresh->SetInput(reader->GetOutput());
+  thresh->SetUpperThreshold(std::stoi(argv[2]));
+  thresh->SetInsideValue(0);
+  thresh->SetOutsideValue(1);
+
+  const double       radius = std::stod(argv[3]);
+  const bool         useSpacing = std::stoi(argv[4]) != 0;
+  const unsigned int expectedSize = std::stoi(argv[5]);
+  bool               ok = true;
+  try
+  {
+    thresh->Update();
+    IType * mask = thresh->GetOutput();
+    ok = WriteIntegerDistances<itk::BinaryDilateParaImageFilter<IType>>(
+           mask, radius, useSpacing, expectedSize, argv[6], argv[7]) &&
+         WriteIntegerDistances<itk::BinaryErodeParaImageFilter<IType>>(
+           mask, radius, useSpacing, expectedSize, argv[8], argv[9]) &&
+         WriteIntegerDistances<itk::BinaryOpenParaImageFilter<IType>>(
+           mask, radius, useSpacing, expectedSize, argv[10], argv[11]) &&
+         WriteIntegerDistances<itk::BinaryCloseParaImageFilter<IType>>(
+           mask, radius, useSpacing, expectedSize, argv[12], argv[13]);
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!ok)
+  {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iostream>
+#include <random>
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+
+#include "itkParabolicErodeImageFilter.h"
+#include "itkParabolicDilateImageFilter.h"
+
+// the exact integer kernel should match the floating point
+// intersection kernel on integer images. The top half of the image
+// has values small enough for 32 bit arithmetic, the bottom half has
+// values that need the 64 bit fallback.
+
+template <typename TFilter, typename TInput>
+double
+compareIntegerKernel(TInput * input, double scale)
+{
+  using FType = typename TFilter::OutputImageType;
+
+  typename TFilter::Pointer integer = TFilter::New();
+  integer->SetInput(input);
+  integer->SetScale(scale);
+  integer->SetParabolicAlgorithm(TFilter::INTEGERINTERSECTION);
+
+  typename TFilter::Pointer real = TFilter::New();
+  real->SetInput(input);
+  real->SetScale(scale);
+  real->SetParabolicAlgorithm(TFilter::INTERSECTION);
+
+  integer->Update();
+  real->Update();
+
+  double                               maxDiff = 0;
+  itk::ImageRegionConstIterator<FType> iit(integer->GetOutput(), integer->GetOutput()->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<FType> rit(real->GetOutput(), real->GetOutput()->GetLargestPossibleRegion());
+  for (; !iit.IsAtEnd(); ++iit, ++rit)
+  {
+    maxDiff = std::max(maxDiff, std::abs(static_cast<double>(iit.Get()) - static_cast<double>(rit.Get())));
+  }
+  return maxDiff;
+}
+
+int
+itkParaIntegerKernelTest(int, char *[])
+{
+  constexpr int dim = 2;
+  using IType = itk::Image<int, dim>;
+  using FType = itk::Image<double, dim>;
+
+  constexpr int   small = 255;
+  constexpr int   large = 1 << 28;
+  IType::Pointer  input = IType::New();
+  IType::SizeType size;
+  size[0] = 100;
+  size[1] = 80;
+  input->SetRegions(size);
+  input->Allocate();
+  std::mt19937 generator(1);
+  for (itk::ImageRegionIterator<IType> it(input, input->GetLargestPossibleRegion()); !it.IsAtEnd(); ++it)
+  {
+    const int range = (it.GetIndex()[1] < 40) ? small : large;
+    it.Set(static_cast<int>(generator() % (2 * range + 1)) - range);
+  }
+
+  // both arithmetic widths must be used
+  if (!itk::ParabolicIntegerKernelFits<int>(small, 2, 100) || itk::ParabolicIntegerKernelFits<int>(large, 1, 80))
+  {
+    std::cerr << "Test image doesn't cover both integer kernel widths" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using ErodeType = itk::ParabolicErodeImageFilter<IType, FType>;
+  using DilateType = itk::ParabolicDilateImageFilter<IType, FType>;
+
+  double maxDiff = 0;
+  try
+  {
+    // parabola weights of 1 and 2
+    for (double scale : { 0.5, 0.25 })
+    {
+      const double erodeDiff = compareIntegerKernel<ErodeType>(input.GetPointer(), scale);
+      const double dilateDiff = compareIntegerKernel<DilateType>(input.GetPointer(), scale);
+      std::cout << "scale " << scale << " erosion " << erodeDiff << " dilation " << dilateDiff << std::endl;
+      maxDiff = std::max(maxDiff, std::max(erodeDiff, dilateDiff));
+    }
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (maxDiff != 0)
+  {
+    std::cerr << "Integer kernel doesn't match the intersection kernel" << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,133 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <cmath>
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkCommand.h"
+#include "itkSimpleFilterWatcher.h"
+
+#include "itkBinaryThresholdImageFilter.h"
+#include "itkParabolicErodeImageFilter.h"
+#include "itkParabolicDilateImageFilter.h"
+
+// thresholding as the last pass writes should match a separate
+// threshold of the work image type
+
+namespace
+{
+using PType = unsigned char;
+using IType = itk::Image<PType, 2>;
+
+template <typename TFilter, typename TReference>
+void
+WriteOutputThreshold(IType *                         mask,
+                     double                          scale,
+                     typename TFilter::WorkPixelType lower,
+                     typename TFilter::WorkPixelType upper,
+                     const char *                    fusedName,
+                     const char *                    separateName)
+{
+  using WorkImageType = typename TFilter::WorkImageType;
+
+  typename TFilter::Pointer filter = TFilter::New();
+  filter->SetInput(mask);
+  filter->SetScale(scale);
+  filter->SetUseOutputThreshold(true);
+  filter->SetLowerOutputThreshold(lower);
+  filter->SetUpperOutputThreshold(upper);
+  filter->SetOutputInsideValue(1);
+  filter->SetOutputOutsideValue(0);
+
+  typename TReference::Pointer reference = TReference::New();
+  reference->SetInput(mask);
+  reference->SetScale(scale);
+
+  using ThreshType = itk::BinaryThresholdImageFilter<WorkImageType, IType>;
+  typename ThreshType::Pointer thresh = ThreshType::New();
+  thresh->SetInput(reference->GetOutput());
+  thresh->SetLowerThreshold(lower);
+  thresh->SetUpperThreshold(upper);
+  thresh->SetInsideValue(1);
+  thresh->SetOutsideValue(0);
+
+  using WriterType = itk::ImageFileWriter<IType>;
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(filter->GetOutput());
+  writer->SetFileName(fusedName);
+  writer->Update();
+  writer->SetInput(thresh->GetOutput());
+  writer->SetFileName(separateName);
+  writer->Update();
+}
+} // namespace
+
+int
+itkParaOutputThresholdTest(int argc, char * argv[])
+{
+  if (argc < 12)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputimage threshold scale"
+              << " erodeOut separateErodeOut shortErodeOut separateShortErodeOut"
+              << " dilateOut separateDilateOut shortDilateOut separateShortDilateOut" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using FType = itk::Image<float, 2>;
+  using SType = itk::Image<short, 2>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  // a 0/1 mask
+  using ThreshType = itk::BinaryThresholdImageFilter<IType, IType>;
+  ThreshType::Pointer thresh = ThreshType::New();
+  thresh->SetInput(reader->GetOutput());
+  thresh->SetUpperThreshold(std::stoi(argv[2]));
+  thresh->SetInsideValue(0);
+  thresh->SetOutsideValue(1);
+
+  const double scale = std::stod(argv[3]);
+
+  try
+  {
+    thresh->Update();
+    IType * mask = thresh->GetOutput();
+    // erosions keep voxels that stay at 1, dilations those above 0
+    WriteOutputThreshold<itk::ParabolicErodeImageFilter<IType, IType, FType>,
+                         itk::ParabolicErodeImageFilter<IType, FType>>(
+      mask, scale, 1.0f, itk::NumericTraits<float>::max(), argv[4], argv[5]);
+    WriteOutputThreshold<itk::ParabolicErodeImageFilter<IType, IType, SType>,
+                         itk::ParabolicErodeImageFilter<IType, SType>>(
+      mask, scale, 1, itk::NumericTraits<short>::max(), argv[6], argv[7]);
+    WriteOutputThreshold<itk::ParabolicDilateImageFilter<IType, IType, FType>,
+                         itk::ParabolicDilateImageFilter<IType, FType>>(
+      mask, scale, std::nextafter(0.0f, 1.0f), itk::NumericTraits<float>::max(), argv[8], argv[9]);
+    WriteOutputThreshold<itk::ParabolicDilateImageFilter<IType, IType, SType>,
+                         itk::ParabolicDilateImageFilter<IType, SType>>(
+      mask, scale, 1, itk::NumericTraits<short>::max(), argv[10], argv[11]);
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,110 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkCommand.h"
+#include "itkSimpleFilterWatcher.h"
+
+#include "itkParabolicErodeImageFilter.h"
+#include "itkParabolicOpenImageFilter.h"
+#include "itkTimeProbe.h"
+#include "itkMultiThreaderBase.h"
+
+// float line buffers should stay within a grey level of double ones
+// for 8 bit images
+
+int
+itkParaPrecisionTest(int argc, char * argv[])
+{
+  if (argc < 4)
+  {
+    std::cerr << "Usage: " << argv[0] << " input floatErodeOut floatOpenOut" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  try
+  {
+    reader->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using ErodeType = itk::ParabolicErodeImageFilter<IType, IType>;
+  ErodeType::Pointer erode = ErodeType::New();
+  erode->SetInput(reader->GetOutput());
+  erode->SetScale(5);
+  erode->SetUseImageSpacing(true);
+  erode->SetKernelPrecision(ErodeType::FLOATPRECISION);
+  erode->ValidatePrecisionOn();
+
+  using OpenType = itk::ParabolicOpenImageFilter<IType, IType>;
+  OpenType::Pointer open = OpenType::New();
+  open->SetInput(reader->GetOutput());
+  open->SetScale(5);
+  open->SetKernelPrecision(OpenType::FLOATPRECISION);
+  open->ValidatePrecisionOn();
+
+  try
+  {
+    erode->Update();
+    open->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Erosion maximum precision error: " << erode->GetMaximumPrecisionError() << std::endl;
+  std::cout << "Opening maximum precision error: " << open->GetMaximumPrecisionError() << std::endl;
+  if (erode->GetMaximumPrecisionError() > 1 || open->GetMaximumPrecisionError() > 1)
+  {
+    std::cerr << "Float kernels differ from double by more than a grey level" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using WriterType = itk::ImageFileWriter<IType>;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(erode->GetOutput());
+  writer->SetFileName(argv[2]);
+  try
+  {
+    writer->Update();
+    writer->SetInput(open->GetOutput());
+    writer->SetFileName(argv[3]);
+    writer->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkCommand.h"
+#include "itkSimpleFilterWatcher.h"
+
+#include "itkBinaryThresholdImageFilter.h"
+#include "itkBinaryImageToLabelMapFilter.h"
+#include "itkMorphologicalDistanceTransformImageFilter.h"
+#include "itkMorphologicalRunLengthDistanceTransformImageFilter.h"
+
+// the transform of a label map should match the dense transform of
+// the same mask, in both directions
+
+int
+itkParaRunLengthDTTest(int argc, char * argv[])
+{
+  if (argc < 7)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputimage threshold runsOut denseOut runsToRunsOut denseToRunsOut"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+  using FType = itk::Image<float, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  // threshold the input to create a mask
+  using ThreshType = itk::BinaryThresholdImageFilter<IType, IType>;
+  ThreshType::Pointer thresh = ThreshType::New();
+  thresh->SetInput(reader->GetOutput());
+  thresh->SetUpperThreshold(std::stoi(argv[2]));
+  thresh->SetInsideValue(0);
+  thresh->SetOutsideValue(255);
+
+  // the runs of the mask
+  using LabelerType = itk::BinaryImageToLabelMapFilter<IType>;
+  LabelerType::Pointer labeler = LabelerType::New();
+  labeler->SetInput(thresh->GetOutput());
+  labeler->SetInputForegroundValue(255);
+
+  using LabelMapType = LabelerType::OutputImageType;
+  using FilterType = itk::MorphologicalRunLengthDistanceTransformImageFilter<LabelMapType, FType>;
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(labeler->GetOutput());
+  filter->SetSqrDist(true);
+  itk::SimpleFilterWatcher watcher(filter, "filter");
+
+  using ReferenceType = itk::MorphologicalDistanceTransformImageFilter<IType, FType>;
+  ReferenceType::Pointer reference = ReferenceType::New();
+  reference->SetInput(thresh->GetOutput());
+  reference->SetSqrDist(true);
+
+  using WriterType = itk::ImageFileWriter<FType>;
+  WriterType::Pointer writer = WriterType::New();
+
+  // distances inside the mask, then outside it
+  const bool toRuns[] = { false, true };
+  try
+  {
+    for (int i = 0; i < 2; i++)
+    {
+      filter->SetDistanceToRuns(toRuns[i]);
+      writer->SetInput(filter->GetOutput());
+      writer->SetFileName(argv[3 + 2 * i]);
+      writer->Update();
+
+      reference->SetOutsideValue(toRuns[i] ? 255 : 0);
+      writer->SetInput(reference->GetOutput());
+      writer->SetFileName(argv[4 + 2 * i]);
+      writer->Update();
+    }
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
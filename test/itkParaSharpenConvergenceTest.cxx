@@ -0,0 +1,136 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkCommand.h"
+#include "itkSimpleFilterWatcher.h"
+
+#include "itkMorphologicalSharpeningImageFilter.h"
+
+// sharpening with early stopping should report the changes of each
+// iteration, and stopping once nothing changes shouldn't alter the
+// output, which the driver compares
+
+namespace
+{
+using IType = itk::Image<unsigned char, 2>;
+using FType = itk::Image<float, 2>;
+
+template <typename TImage1, typename TImage2>
+long
+CountDifferences(const TImage1 * a, const TImage2 * b)
+{
+  long                                   differences = 0;
+  itk::ImageRegionConstIterator<TImage1> ait(a, a->GetBufferedRegion());
+  itk::ImageRegionConstIterator<TImage2> bit(b, b->GetBufferedRegion());
+  for (; !ait.IsAtEnd(); ++ait, ++bit)
+  {
+    if (static_cast<float>(ait.Get()) != static_cast<float>(bit.Get()))
+    {
+      ++differences;
+    }
+  }
+  return differences;
+}
+} // namespace
+
+int
+itkParaSharpenConvergenceTest(int argc, char * argv[])
+{
+  if (argc < 5)
+  {
+    std::cerr << "Usage: " << argv[0] << " inputimage iterations stoppedOut fullOut" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  const int iterations = std::stoi(argv[2]);
+
+  using FilterType = itk::MorphologicalSharpeningImageFilter<IType, FType>;
+  FilterType::Pointer single = FilterType::New();
+  single->SetInput(reader->GetOutput());
+  single->SetScale(2);
+  single->SetIterations(1);
+
+  FilterType::Pointer stopped = FilterType::New();
+  stopped->SetInput(reader->GetOutput());
+  stopped->SetScale(2);
+  stopped->SetIterations(iterations);
+  stopped->StopOnConvergenceOn();
+  stopped->SetConvergenceThreshold(0);
+
+  FilterType::Pointer full = FilterType::New();
+  full->SetInput(reader->GetOutput());
+  full->SetScale(2);
+  full->SetIterations(iterations);
+
+  try
+  {
+    reader->Update();
+    single->Update();
+
+    using WriterType = itk::ImageFileWriter<FType>;
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetInput(stopped->GetOutput());
+    writer->SetFileName(argv[3]);
+    writer->Update();
+    writer->SetInput(full->GetOutput());
+    writer->SetFileName(argv[4]);
+    writer->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const auto & changed = stopped->GetChangedPixels();
+  std::cout << "iterations used " << stopped->GetIterationsUsed() << std::endl;
+  for (auto c : changed)
+  {
+    std::cout << "changed " << c << std::endl;
+  }
+
+  bool passed = true;
+  if (full->GetIterationsUsed() != iterations || single->GetChangedPixels().size() != 1)
+  {
+    std::cerr << "Iterations stopped without StopOnConvergence" << std::endl;
+    passed = false;
+  }
+  if (static_cast<long>(single->GetChangedPixels()[0]) != CountDifferences(reader->GetOutput(), single->GetOutput()))
+  {
+    std::cerr << "Changed pixels of the first iteration are wrong" << std::endl;
+    passed = false;
+  }
+  if (stopped->GetIterationsUsed() < iterations && changed.back() != 0)
+  {
+    std::cerr << "Stopped before converging" << std::endl;
+    passed = false;
+  }
+  if (stopped->GetIterationsUsed() > 1 && changed[0] != single->GetChangedPixels()[0])
+  {
+    std::cerr << "Changed pixels differ between updates" << std::endl;
+    passed = false;
+  }
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,97 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkVectorIndexSelectionCastImageFilter.h"
+#include "itkCommand.h"
+#include "itkSimpleFilterWatcher.h"
+
+#include "itkParabolicDilateImageFilter.h"
+#include "itkParabolicDilateStackImageFilter.h"
+#include "itkTimeProbe.h"
+#include "itkMultiThreaderBase.h"
+
+// each component of the stack should match a dilation at that scale
+
+int
+itkParaStackTest(int argc, char * argv[])
+{
+  if (argc < 11)
+  {
+    std::cerr << "Usage: " << argv[0] << " input incremental"
+              << " stack5Out dilate5Out stack1Out dilate1Out stack2Out dilate2Out stack0Out dilate0Out" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  using PType = float;
+  using IType = itk::Image<PType, dim>;
+  using VType = itk::VectorImage<PType, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  using StackType = itk::ParabolicDilateStackImageFilter<IType, VType>;
+  StackType::Pointer stack = StackType::New();
+  stack->SetInput(reader->GetOutput());
+  const StackType::ScalesType scales{ 5, 1, 2, 0 };
+  stack->SetScales(scales);
+
+  using DilateType = itk::ParabolicDilateImageFilter<IType, IType>;
+  DilateType::Pointer dilate = DilateType::New();
+  dilate->SetInput(reader->GetOutput());
+
+  using SelectType = itk::VectorIndexSelectionCastImageFilter<VType, IType>;
+  SelectType::Pointer select = SelectType::New();
+  select->SetInput(stack->GetOutput());
+
+  using WriterType = itk::ImageFileWriter<IType>;
+  WriterType::Pointer writer = WriterType::New();
+
+  stack->SetIncremental(std::stoi(argv[2]) != 0);
+  try
+  {
+    stack->Update();
+    if (stack->GetOutput()->GetNumberOfComponentsPerPixel() != scales.size())
+    {
+      std::cerr << "Wrong number of components " << stack->GetOutput()->GetNumberOfComponentsPerPixel() << std::endl;
+      return EXIT_FAILURE;
+    }
+    for (unsigned int k = 0; k < scales.size(); k++)
+    {
+      select->SetIndex(k);
+      writer->SetInput(select->GetOutput());
+      writer->SetFileName(argv[3 + 2 * k]);
+      writer->Update();
+
+      dilate->SetScale(scales[k]);
+      writer->SetInput(dilate->GetOutput());
+      writer->SetFileName(argv[4 + 2 * k]);
+      writer->Update();
+    }
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
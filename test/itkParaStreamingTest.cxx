@@ -0,0 +1,109 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkStreamingImageFilter.h"
+#include "itkCommand.h"
+#include "itkSimpleFilterWatcher.h"
+
+#include "itkMinimumMaximumImageCalculator.h"
+#include "itkParabolicErodeImageFilter.h"
+#include "itkParabolicOpenImageFilter.h"
+
+// with a known input range, erosions and openings produced in pieces
+// should match those produced in one go
+
+template <typename TFilter, typename TImage>
+void
+writeStreamed(TFilter * filter, unsigned int divisions, const char * wholeName, const char * streamedName)
+{
+  using WriterType = itk::ImageFileWriter<TImage>;
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(filter->GetOutput());
+  writer->SetFileName(wholeName);
+  writer->Update();
+
+  using StreamerType = itk::StreamingImageFilter<TImage, TImage>;
+  typename StreamerType::Pointer streamer = StreamerType::New();
+  streamer->SetInput(filter->GetOutput());
+  streamer->SetNumberOfStreamDivisions(divisions);
+  writer->SetInput(streamer->GetOutput());
+  writer->SetFileName(streamedName);
+  writer->Update();
+}
+
+int
+itkParaStreamingTest(int argc, char * argv[])
+{
+  if (argc < 8)
+  {
+    std::cerr << "Usage: " << argv[0]
+              << " inputimage erodeOut streamedErodeOut openOut streamedOpenOut borderOut streamedBorderOut"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  constexpr int dim = 2;
+  using IType = itk::Image<unsigned char, dim>;
+  using FType = itk::Image<float, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  using ErodeType = itk::ParabolicErodeImageFilter<IType, FType>;
+  using OpenType = itk::ParabolicOpenImageFilter<IType, FType>;
+
+  try
+  {
+    reader->Update();
+    using CalculatorType = itk::MinimumMaximumImageCalculator<IType>;
+    CalculatorType::Pointer calculator = CalculatorType::New();
+    calculator->SetImage(reader->GetOutput());
+    calculator->Compute();
+
+    ErodeType::Pointer erode = ErodeType::New();
+    erode->SetInput(reader->GetOutput());
+    erode->SetScale(0.5);
+    erode->SetUseInputRange(true);
+    erode->SetInputMinimum(calculator->GetMinimum());
+    erode->SetInputMaximum(calculator->GetMaximum());
+    writeStreamed<ErodeType, FType>(erode, 7, argv[2], argv[3]);
+
+    OpenType::Pointer open = OpenType::New();
+    open->SetInput(reader->GetOutput());
+    open->SetScale(0.5);
+    open->SetSafeBorder(false);
+    open->SetUseInputRange(true);
+    open->SetInputMinimum(calculator->GetMinimum());
+    open->SetInputMaximum(calculator->GetMaximum());
+    writeStreamed<OpenType, FType>(open, 7, argv[4], argv[5]);
+
+    // the virtual border is only added at the image edges
+    open->SetSafeBorder(true);
+    writeStreamed<OpenType, FType>(open, 7, argv[6], argv[7]);
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,115 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkCommand.h"
+#include "itkSimpleFilterWatcher.h"
+
+#include "itkParabolicErodeImageFilter.h"
+#include "itkParabolicOpenImageFilter.h"
+#include "itkTimeProbe.h"
+#include "itkMultiThreaderBase.h"
+
+// tiled line transfer should give the same result as strided
+
+int
+itkParaTiledTest(int argc, char * argv[])
+{
+  if (argc < 5)
+  {
+    std::cerr << "Usage: " << argv[0] << " input tiledErodeOut tiledOpenOut stridedOpenOut" << std::endl;
+    return EXIT_FAILURE;
+  }
+  constexpr int dim = 2;
+
+  using PType = unsigned char;
+  using IType = itk::Image<PType, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+  try
+  {
+    reader->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using ErodeType = itk::ParabolicErodeImageFilter<IType, IType>;
+  ErodeType::Pointer erode = ErodeType::New();
+  erode->SetInput(reader->GetOutput());
+  erode->SetScale(5);
+  erode->SetUseImageSpacing(true);
+  erode->SetExecutionMode(ErodeType::TILEDLINES);
+
+  using OpenType = itk::ParabolicOpenImageFilter<IType, IType>;
+  OpenType::Pointer open = OpenType::New();
+  open->SetInput(reader->GetOutput());
+  open->SetScale(5);
+  open->SetExecutionMode(OpenType::AUTOLINES);
+
+  try
+  {
+    erode->Update();
+    open->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (erode->GetExecutionStrategy()[0] != ErodeType::STRIDEDLINES ||
+      erode->GetExecutionStrategy()[1] != ErodeType::TILEDLINES)
+  {
+    std::cerr << "Unexpected erosion strategy " << erode->GetExecutionStrategy() << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (open->GetExecutionStrategy()[1] != OpenType::TILEDLINES)
+  {
+    std::cerr << "Unexpected opening strategy " << open->GetExecutionStrategy() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using WriterType = itk::ImageFileWriter<IType>;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(erode->GetOutput());
+  writer->SetFileName(argv[2]);
+  try
+  {
+    writer->Update();
+    writer->SetInput(open->GetOutput());
+    writer->SetFileName(argv[3]);
+    writer->Update();
+
+    open->SetExecutionMode(OpenType::STRIDEDLINES);
+    writer->SetFileName(argv[4]);
+    writer->Update();
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+/*=========================================================================
+ *
+ *  Copyright NumFOCUS
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *         https://www.apache.org/licenses/LICENSE-2.0.txt
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *=========================================================================*/
+#include <iomanip>
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+#include "itkCommand.h"
+#include "itkSimpleFilterWatcher.h"
+
+#include "itkConstantPadImageFilter.h"
+#include "itkCropImageFilter.h"
+#include "itkParabolicOpenImageFilter.h"
+#include "itkParabolicCloseImageFilter.h"
+#include "itkStatisticsImageFilter.h"
+
+// openings and closings with a safe border, which is virtual, should
+// match padding the image, filtering it without a border and
+// cropping it
+
+template <typename TFilter, typename TInput>
+void
+writeBorder(TInput *                             input,
+            const typename TFilter::RadiusType & scale,
+            int                                  algorithm,
+            bool                                 open,
+            const char *                         virtualName,
+            const char *                         paddedName)
+{
+  using FType = typename TFilter::OutputImageType;
+
+  typename TFilter::Pointer filter = TFilter::New();
+  filter->SetInput(input);
+  filter->SetScale(scale);
+  filter->SetParabolicAlgorithm(algorithm);
+  filter->SetSafeBorder(true);
+
+  using StatsType = itk::StatisticsImageFilter<TInput>;
+  typename StatsType::Pointer stats = StatsType::New();
+  stats->SetInput(input);
+  stats->Update();
+
+  // the border of ParabolicOpenCloseSafeBorderImageFilter
+  typename TInput::SizeType pad;
+  for (unsigned d = 0; d < TInput::ImageDimension; d++)
+  {
+    pad[d] = (unsigned long)ceil(sqrt(2 * scale[d] * (stats->GetMaximum() - stats->GetMinimum())));
+  }
+
+  using PadType = itk::ConstantPadImageFilter<TInput, TInput>;
+  typename PadType::Pointer padder = PadType::New();
+  padder->SetInput(input);
+  padder->SetPadLowerBound(pad);
+  padder->SetPadUpperBound(pad);
+  padder->SetConstant(open ? stats->GetMaximum() : stats->GetMinimum());
+
+  typename TFilter::Pointer reference = TFilter::New();
+  reference->SetInput(padder->GetOutput());
+  reference->SetScale(scale);
+  reference->SetParabolicAlgorithm(algorithm);
+  reference->SetSafeBorder(false);
+
+  using CropType = itk::CropImageFilter<FType, FType>;
+  typename CropType::Pointer crop = CropType::New();
+  crop->SetInput(reference->GetOutput());
+  crop->SetLowerBoundaryCropSize(pad);
+  crop->SetUpperBoundaryCropSize(pad);
+
+  using WriterType = itk::ImageFileWriter<FType>;
+  typename WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(filter->GetOutput());
+  writer->SetFileName(virtualName);
+  writer->Update();
+  writer->SetInput(crop->GetOutput());
+  writer->SetFileName(paddedName);
+  writer->Update();
+}
+
+int
+itkParaVirtualBorderTest(int argc, char * argv[])
+{
+  if (argc < 7)
+  {
+    std::cerr << "Usage: " << argv[0]
+              << " inputimage algorithm virtualOpenOut paddedOpenOut virtualCloseOut paddedCloseOut" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  constexpr int dim = 2;
+  using IType = itk::Image<unsigned char, dim>;
+  using FType = itk::Image<float, dim>;
+
+  using ReaderType = itk::ImageFileReader<IType>;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  using OpenType = itk::ParabolicOpenImageFilter<IType, FType>;
+  using CloseType = itk::ParabolicCloseImageFilter<IType, FType>;
+
+  OpenType::RadiusType scale;
+  scale[0] = 5;
+  scale[1] = 2;
+
+  const int algorithm = std::stoi(argv[2]);
+  try
+  {
+    reader->Update();
+    writeBorder<OpenType>(reader->GetOutput(), scale, algorithm, true, argv[3], argv[4]);
+    writeBorder<CloseType>(reader->GetOutput(), scale, algorithm, false, argv[5], argv[6]);
+  }
+  catch (itk::ExceptionObject & excp)
+  {
+    std::cerr << excp << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}